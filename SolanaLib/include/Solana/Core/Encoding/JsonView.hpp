@@ -0,0 +1,494 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace Solana::Encoding
+{
+    // Read-only, on-demand view into JSON text. Nothing is parsed up front and no
+    // DOM is built: member lookups and iteration scan the text in place, skipping
+    // over values they do not need, and every view is a pointer into the original
+    // buffer, which must outlive it. Strings can be read as raw (still escaped)
+    // string_views without allocating.
+    //
+    // Lookups scan from the start of their object, so reading many members of one
+    // object is cheapest with members(). Malformed input throws std::runtime_error
+    // when the scan reaches it.
+    class JsonView
+    {
+    public:
+        enum class Type
+        {
+            Missing,
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        template <bool Members>
+        class Iterator;
+
+        template <bool Members>
+        class Range
+        {
+        public:
+            Iterator<Members> begin() const { return begin_; }
+            Iterator<Members> end() const { return {}; }
+
+        private:
+            friend class JsonView;
+            explicit Range(Iterator<Members> begin) : begin_(begin) {}
+            Iterator<Members> begin_;
+        };
+
+        JsonView() = default;
+
+        explicit JsonView(std::string_view text)
+            : JsonView(skipWs(text.data(), text.data() + text.size()), text.data() + text.size())
+        {
+            if (p_ == end_)
+            {
+                malformed("empty document");
+            }
+        }
+
+        Type type() const
+        {
+            if (!p_)
+            {
+                return Type::Missing;
+            }
+            switch (*p_)
+            {
+            case 'n':
+                return Type::Null;
+            case 't':
+            case 'f':
+                return Type::Bool;
+            case '"':
+                return Type::String;
+            case '[':
+                return Type::Array;
+            case '{':
+                return Type::Object;
+            default:
+                return Type::Number;
+            }
+        }
+
+        bool exists() const { return p_ != nullptr; }
+
+        // Like a lookup on a const nlohmann::json, a missing member also reads as null
+        bool isNull() const { return type() == Type::Null || type() == Type::Missing; }
+        bool isString() const { return type() == Type::String; }
+        bool isArray() const { return type() == Type::Array; }
+        bool isObject() const { return type() == Type::Object; }
+
+        // Missing view when this is not an object or has no such member. Keys are
+        // compared in their escaped form.
+        JsonView operator[](std::string_view key) const
+        {
+            if (!isObject())
+            {
+                return {};
+            }
+            for (const auto &[name, value] : members())
+            {
+                if (name == key)
+                {
+                    return value;
+                }
+            }
+            return {};
+        }
+
+        // Missing view when this is not an array or is too short
+        JsonView operator[](std::size_t index) const
+        {
+            if (!isArray())
+            {
+                return {};
+            }
+            for (const auto &element : elements())
+            {
+                if (index-- == 0)
+                {
+                    return element;
+                }
+            }
+            return {};
+        }
+
+        // (key, value) pairs of an object; empty for null or missing values
+        Range<true> members() const
+        {
+            return Range<true>(Iterator<true>(containerBody('{'), end_));
+        }
+
+        // Elements of an array; empty for null or missing values
+        Range<false> elements() const
+        {
+            return Range<false>(Iterator<false>(containerBody('['), end_));
+        }
+
+        // The complete text of this value, e.g. to hand a subtree to json::parse
+        std::string_view raw() const
+        {
+            if (!p_)
+            {
+                return {};
+            }
+            return {p_, static_cast<std::size_t>(skipValue(p_, end_) - p_)};
+        }
+
+        // String contents without the quotes and with escapes left in place
+        std::string_view stringView() const
+        {
+            expect(Type::String, "string");
+            const auto *close = skipString(p_, end_);
+            return {p_ + 1, static_cast<std::size_t>(close - p_ - 2)};
+        }
+
+        // std::string (unescaped), std::string_view (raw, see stringView), bool,
+        // or any arithmetic type
+        template <typename T>
+        T get() const
+        {
+            if constexpr (std::is_same_v<T, std::string>)
+            {
+                return unescape(stringView());
+            }
+            else if constexpr (std::is_same_v<T, std::string_view>)
+            {
+                return stringView();
+            }
+            else if constexpr (std::is_same_v<T, bool>)
+            {
+                expect(Type::Bool, "bool");
+                return *p_ == 't';
+            }
+            else
+            {
+                static_assert(std::is_arithmetic_v<T>, "JsonView::get supports strings, bool and numbers");
+                expect(Type::Number, "number");
+                const auto text = raw();
+                T result{};
+                const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+                if (ec != std::errc() || end != text.data() + text.size())
+                {
+                    malformed("number out of range for the requested type");
+                }
+                return result;
+            }
+        }
+
+        // Member value, or fallback when the member is missing or null
+        template <typename T>
+        T value(std::string_view key, T fallback) const
+        {
+            const auto member = (*this)[key];
+            return member.isNull() ? fallback : member.template get<T>();
+        }
+
+        template <bool Members>
+        class Iterator
+        {
+        public:
+            using value_type = std::conditional_t<Members, std::pair<std::string_view, JsonView>, JsonView>;
+
+            Iterator() = default;
+
+            value_type operator*() const
+            {
+                if constexpr (Members)
+                {
+                    return value_type(key_, JsonView(value_, end_));
+                }
+                else
+                {
+                    return JsonView(value_, end_);
+                }
+            }
+
+            Iterator &operator++()
+            {
+                const auto *p = skipWs(skipValue(value_, end_), end_);
+                if (p != end_ && *p == ',')
+                {
+                    settle(skipWs(p + 1, end_));
+                }
+                else if (p != end_ && (*p == '}' || *p == ']'))
+                {
+                    value_ = nullptr;
+                }
+                else
+                {
+                    malformed("expected ',' or end of container");
+                }
+                return *this;
+            }
+
+            bool operator==(const Iterator &other) const { return value_ == other.value_; }
+            bool operator!=(const Iterator &other) const { return value_ != other.value_; }
+
+        private:
+            friend class JsonView;
+
+            // p points just past the opening bracket, or is null for an empty range
+            Iterator(const char *p, const char *end) : end_(end)
+            {
+                if (p)
+                {
+                    p = skipWs(p, end);
+                    if (p != end && (*p == '}' || *p == ']'))
+                    {
+                        return;
+                    }
+                    settle(p);
+                }
+            }
+
+            void settle(const char *p)
+            {
+                if constexpr (Members)
+                {
+                    if (p == end_ || *p != '"')
+                    {
+                        malformed("expected member name");
+                    }
+                    const auto *close = skipString(p, end_);
+                    key_ = {p + 1, static_cast<std::size_t>(close - p - 2)};
+                    p = skipWs(close, end_);
+                    if (p == end_ || *p != ':')
+                    {
+                        malformed("expected ':' after member name");
+                    }
+                    p = skipWs(p + 1, end_);
+                }
+                if (p == end_)
+                {
+                    malformed("unexpected end of input");
+                }
+                value_ = p;
+            }
+
+            const char *value_ = nullptr;
+            const char *end_ = nullptr;
+            std::string_view key_;
+        };
+
+    private:
+        JsonView(const char *p, const char *end) : p_(p), end_(end) {}
+
+        // Pointer just past the opening bracket, or null when there is nothing to iterate
+        const char *containerBody(char open) const
+        {
+            if (isNull())
+            {
+                return nullptr;
+            }
+            if (*p_ != open)
+            {
+                malformed(open == '{' ? "expected an object" : "expected an array");
+            }
+            return p_ + 1;
+        }
+
+        void expect(Type type, const char *name) const
+        {
+            if (this->type() != type)
+            {
+                throw std::runtime_error(std::string("JSON value is not a ") + name + ": " + std::string(raw().substr(0, 64)));
+            }
+        }
+
+        static const char *skipWs(const char *p, const char *end)
+        {
+            while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            {
+                ++p;
+            }
+            return p;
+        }
+
+        // p points at the opening quote; returns the position just past the closing one
+        static const char *skipString(const char *p, const char *end)
+        {
+            const auto *contents = ++p;
+            for (;;)
+            {
+                const auto *quote = static_cast<const char *>(std::memchr(p, '"', end - p));
+                if (!quote)
+                {
+                    malformed("unterminated string");
+                }
+                // The quote is escaped only if preceded by an odd number of backslashes
+                std::size_t backslashes = 0;
+                while (quote - backslashes > contents && quote[-1 - static_cast<std::ptrdiff_t>(backslashes)] == '\\')
+                {
+                    ++backslashes;
+                }
+                if (backslashes % 2 == 0)
+                {
+                    return quote + 1;
+                }
+                p = quote + 1;
+            }
+        }
+
+        // Returns the position just past the value starting at p
+        static const char *skipValue(const char *p, const char *end)
+        {
+            switch (*p)
+            {
+            case '"':
+                return skipString(p, end);
+            case '{':
+            case '[':
+            {
+                std::size_t depth = 0;
+                while (p != end)
+                {
+                    switch (*p)
+                    {
+                    case '"':
+                        p = skipString(p, end);
+                        continue;
+                    case '{':
+                    case '[':
+                        ++depth;
+                        break;
+                    case '}':
+                    case ']':
+                        if (--depth == 0)
+                        {
+                            return p + 1;
+                        }
+                        break;
+                    }
+                    ++p;
+                }
+                malformed("unterminated container");
+            }
+            default:
+                while (p != end && *p != ',' && *p != '}' && *p != ']' &&
+                       *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+                {
+                    ++p;
+                }
+                return p;
+            }
+        }
+
+        static std::string unescape(std::string_view s)
+        {
+            if (s.find('\\') == std::string_view::npos)
+            {
+                return std::string(s);
+            }
+
+            std::string out;
+            out.reserve(s.size());
+            for (std::size_t i = 0; i < s.size(); ++i)
+            {
+                if (s[i] != '\\')
+                {
+                    out += s[i];
+                    continue;
+                }
+                if (++i == s.size())
+                {
+                    malformed("dangling escape");
+                }
+                switch (s[i])
+                {
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                {
+                    auto codepoint = hex4(s, i + 1);
+                    i += 4;
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00 && s.substr(i + 1, 2) == "\\u")
+                    {
+                        const auto low = hex4(s, i + 3);
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                    appendUtf8(out, codepoint);
+                    break;
+                }
+                default:
+                    // \" \\ and \/ stand for themselves
+                    out += s[i];
+                }
+            }
+            return out;
+        }
+
+        static std::uint32_t hex4(std::string_view s, std::size_t at)
+        {
+            std::uint32_t value = 0;
+            if (at + 4 > s.size() || std::from_chars(s.data() + at, s.data() + at + 4, value, 16).ptr != s.data() + at + 4)
+            {
+                malformed("invalid \\u escape");
+            }
+            return value;
+        }
+
+        static void appendUtf8(std::string &out, std::uint32_t cp)
+        {
+            if (cp < 0x80)
+            {
+                out += static_cast<char>(cp);
+            }
+            else if (cp < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        [[noreturn]] static void malformed(const char *what)
+        {
+            throw std::runtime_error(std::string("malformed JSON: ") + what);
+        }
+
+        const char *p_ = nullptr;
+        const char *end_ = nullptr;
+    };
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "nlohmann/json.hpp"
+#include "Solana/Core/Encoding/JsonView.hpp"
+
+namespace Solana::Encoding
+{
+    // A JSON value kept as text, sharing ownership of the buffer it was read from
+    // (typically a whole HTTP response body). Copies share the buffer, so a reply
+    // can hand out subtrees of a large payload without duplicating them; parse()
+    // builds a DOM only when a caller actually asks for one.
+    class RawJson
+    {
+    public:
+        RawJson() = default;
+
+        explicit RawJson(std::string text)
+            : buffer_(std::make_shared<const std::string>(std::move(text))),
+              text_(*buffer_)
+        {
+        }
+
+        // text must point into *buffer
+        RawJson(std::shared_ptr<const std::string> buffer, std::string_view text)
+            : buffer_(std::move(buffer)),
+              text_(text)
+        {
+        }
+
+        std::string_view str() const { return text_; }
+
+        JsonView view() const { return JsonView(text_); }
+
+        nlohmann::json parse() const { return nlohmann::json::parse(text_); }
+
+    private:
+        std::shared_ptr<const std::string> buffer_;
+        std::string_view text_;
+    };
+}
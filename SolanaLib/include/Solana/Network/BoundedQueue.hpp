@@ -0,0 +1,118 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Solana::Network
+{
+    // Fixed-capacity lock-free queue for any number of producers and consumers
+    // (Vyukov's bounded MPMC queue). Each slot carries a sequence number telling
+    // producers and consumers whose turn it is, so a push or pop is one CAS on the
+    // tail or head plus a release store, and neither side ever blocks the other.
+    // Capacity is rounded up to a power of two.
+    template <typename T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(std::size_t capacity)
+            : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+              cells_(std::make_unique<Cell[]>(mask_ + 1))
+        {
+            for (std::size_t i = 0; i <= mask_; ++i)
+            {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        // Moves value in and returns true, or returns false with value untouched
+        // when the queue is full
+        bool tryPush(T &&value)
+        {
+            auto pos = tail_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                auto &cell = cells_[pos & mask_];
+                const auto sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::move(value);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // The slot still holds the value from one lap ago
+                    return false;
+                }
+                else
+                {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool tryPop(T &value)
+        {
+            auto pos = head_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                auto &cell = cells_[pos & mask_];
+                const auto sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(cell.value);
+                        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Approximate while other threads push or pop
+        std::size_t size() const
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        std::size_t capacity() const { return mask_ + 1; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        // Producers and consumers each hammer their own index; keep them on
+        // separate cache lines
+        static constexpr std::size_t cacheLine = 64;
+
+        const std::size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+        alignas(cacheLine) std::atomic<std::size_t> tail_ = 0;
+        alignas(cacheLine) std::atomic<std::size_t> head_ = 0;
+    };
+}
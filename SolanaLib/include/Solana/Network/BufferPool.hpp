@@ -0,0 +1,144 @@
+#pragma once
+#include <boost/beast/core/flat_buffer.hpp>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace beast = boost::beast;
+
+namespace Solana::Network
+{
+    struct BufferPoolStats
+    {
+        std::size_t acquired = 0;
+        // Acquisitions that found no free buffer and started an empty one
+        std::size_t allocated = 0;
+        std::size_t recycled = 0;
+        // Returned with the pool full, or grown past maxRetainedBytes, and freed
+        std::size_t discarded = 0;
+    };
+
+    class BufferPool;
+
+    // A buffer on loan from a BufferPool, handed back when destroyed. Readers see
+    // the data in place through view(); move the lease somewhere else to keep the
+    // data past the call that received it.
+    class PooledBuffer
+    {
+    public:
+        PooledBuffer() = default;
+        PooledBuffer(PooledBuffer &&other) noexcept = default;
+
+        PooledBuffer &operator=(PooledBuffer &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                pool_ = std::move(other.pool_);
+                buffer_ = std::move(other.buffer_);
+            }
+            return *this;
+        }
+
+        ~PooledBuffer() { release(); }
+
+        beast::flat_buffer &buffer() { return buffer_; }
+
+        // The readable bytes, valid until the lease is destroyed or the buffer written to
+        std::string_view view() const
+        {
+            const auto data = buffer_.cdata();
+            return {static_cast<const char *>(data.data()), data.size()};
+        }
+
+        std::size_t size() const { return buffer_.size(); }
+
+    private:
+        friend class BufferPool;
+
+        PooledBuffer(std::shared_ptr<BufferPool> pool, beast::flat_buffer buffer)
+            : pool_(std::move(pool)), buffer_(std::move(buffer))
+        {
+        }
+
+        inline void release();
+
+        std::shared_ptr<BufferPool> pool_;
+        beast::flat_buffer buffer_;
+    };
+
+    // Free list of read buffers that keep their capacity between messages, so a
+    // steady stream of similar-sized frames is read without touching the heap.
+    // The most recently returned buffer is handed out first, while it is still in
+    // cache. Thread-safe: leases may be returned from any thread.
+    class BufferPool : public std::enable_shared_from_this<BufferPool>
+    {
+    public:
+        // Up to `capacity` free buffers are kept; one that grew past
+        // maxRetainedBytes for an unusually large message is freed instead
+        explicit BufferPool(std::size_t capacity, std::size_t maxRetainedBytes = 4 * 1024 * 1024)
+            : capacity_(capacity), maxRetainedBytes_(maxRetainedBytes)
+        {
+            free_.reserve(capacity_);
+        }
+
+        PooledBuffer acquire()
+        {
+            beast::flat_buffer buffer;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ++stats_.acquired;
+                if (free_.empty())
+                {
+                    ++stats_.allocated;
+                }
+                else
+                {
+                    buffer = std::move(free_.back());
+                    free_.pop_back();
+                }
+            }
+            return PooledBuffer(shared_from_this(), std::move(buffer));
+        }
+
+        BufferPoolStats stats() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+    private:
+        friend class PooledBuffer;
+
+        void recycle(beast::flat_buffer buffer)
+        {
+            buffer.consume(buffer.size());
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (free_.size() < capacity_ && buffer.capacity() <= maxRetainedBytes_)
+            {
+                free_.push_back(std::move(buffer));
+                ++stats_.recycled;
+                return;
+            }
+            ++stats_.discarded;
+            // Freed outside the lock
+            lock.unlock();
+        }
+
+        std::size_t capacity_;
+        std::size_t maxRetainedBytes_;
+        std::vector<beast::flat_buffer> free_;
+        BufferPoolStats stats_;
+        mutable std::mutex mutex_;
+    };
+
+    void PooledBuffer::release()
+    {
+        if (auto pool = std::move(pool_))
+        {
+            pool->recycle(std::move(buffer_));
+        }
+    }
+}
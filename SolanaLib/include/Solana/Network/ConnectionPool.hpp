@@ -9,8 +9,18 @@
 #include <iostream>
 #include <memory>
 #include <future>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
+#include <cerrno>
 #include <boost/url.hpp>
 #include "Solana/Logger.hpp"
+#include "Solana/Network/Connector.hpp"
+#include "Solana/Network/RequestOptions.hpp"
 
 using namespace boost::urls;
 using json = nlohmann::json;
@@ -22,45 +32,414 @@ using net::ip::tcp;
 
 namespace Solana::Network
 {
+    struct ConnectionPoolConfig
+    {
+        // Idle streams kept per (host, port, TLS context)
+        std::size_t maxIdlePerHost = 16;
+        // In-use streams per (host, port, TLS context). Past this, asyncGetConnection
+        // queues the caller until a stream is released.
+        std::size_t maxTotalPerHost = 256;
+        // Idle streams older than this are closed instead of reused. Keep it below the
+        // provider's (or its load balancer's) idle timeout so we close first.
+        std::chrono::milliseconds idleTimeout = std::chrono::seconds(30);
+        // How often a background task probes idle streams and closes dead or expired
+        // ones; zero leaves that to asyncGetConnection
+        std::chrono::milliseconds maintenanceInterval = std::chrono::seconds(5);
+        // Idle streams the background task keeps open per host (for hosts already
+        // used), reconnecting in place of any it closed
+        std::size_t minIdlePerHost = 0;
+    };
+
+    struct ConnectionPoolStats
+    {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+        std::size_t inUse = 0;
+        std::size_t idle = 0;
+        // Idle streams found closed by the server when a request picked them; the
+        // background task exists to keep this at zero
+        std::size_t deadOnPickup = 0;
+        // Callers queued at maxTotalPerHost, and those of them whose deadline passed
+        // or that were cancelled before a stream came back
+        std::size_t waited = 0;
+        std::size_t abandoned = 0;
+        // Background maintenance: idle streams checked, found closed by the server,
+        // closed for reaching idleTimeout, and opened to stay at minIdlePerHost
+        std::size_t probes = 0;
+        std::size_t deadOnProbe = 0;
+        std::size_t expired = 0;
+        std::size_t replenished = 0;
+        std::size_t replenishFailures = 0;
+    };
+
     class ConnectionPool // Add the ConnectionPool class definition *before* HttpClient
     {
     public:
-        ConnectionPool(std::shared_ptr<net::io_context> ioc) : ioc_(ioc) {}
+        using Stream = beast::ssl_stream<beast::tcp_stream>;
+
+        ConnectionPool(std::shared_ptr<net::io_context> ioc, const ConnectionPoolConfig &config = {})
+            : ioc_(ioc), config_(config), maintenanceTimer_(*ioc_)
+        {
+            if (config_.maintenanceInterval.count() > 0)
+            {
+                scheduleMaintenance();
+            }
+        }
+
+        using Ready = std::function<void(beast::error_code, std::unique_ptr<Stream>)>;
 
-        std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> getConnection(
+        // Hands `ready` a pooled stream, or a new unconnected one, right away while the
+        // host is under maxTotalPerHost. At the limit the caller is queued until a
+        // stream is released and `ready` runs on the io_context; nothing blocks. A
+        // queued caller gets Error::QueueTimeout once options' deadline passes, or
+        // Error::Cancelled if its token is, and no stream.
+        void asyncGetConnection(
             const std::string &host,
             const std::string &port,
-            std::shared_ptr<ssl::context> ctx)
+            std::shared_ptr<ssl::context> ctx,
+            const RequestOptions &options,
+            Ready ready)
         {
-            std::unique_lock<std::mutex> lock(mutex_);
-            // Check for an available connection in the pool.
-            if (!connections_.empty())
+            std::unique_ptr<Stream> connection;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                Key key{host, port, ctx.get()};
+                auto &pool = pools_[key];
+                if (!pool.ctx)
+                {
+                    pool.ctx = ctx;
+                }
+                evictExpired(pool);
+
+                // Most recently released first: it is the least likely to have been closed by the server
+                while (!pool.idle.empty() && !connection)
+                {
+                    connection = std::move(pool.idle.back().stream);
+                    pool.idle.pop_back();
+                    if (!isAlive(*connection))
+                    {
+                        ++stats_.evictions;
+                        ++stats_.deadOnPickup;
+                        LOG_INFO("Discarding dead pooled connection for {}:{}", host, port);
+                        connection.reset();
+                    }
+                }
+
+                if (connection)
+                {
+                    ++stats_.hits;
+                    ++pool.inUse;
+                    LOG_INFO("Reusing connection from pool for {}:{}", host, port);
+                }
+                else if (pool.inUse < config_.maxTotalPerHost)
+                {
+                    connection = open(pool, *ctx);
+                    LOG_INFO("Creating new connection for {}:{}", host, port);
+                }
+                else
+                {
+                    LOG_WARN("Connection limit ({}) reached for {}:{}, queueing for a release", config_.maxTotalPerHost, host, port);
+                    enqueue(key, pool, options, std::move(ready));
+                    return;
+                }
+            }
+            ready({}, std::move(connection));
+        }
+
+        // Every stream handed out by asyncGetConnection must come back here exactly once.
+        // Streams that failed, were shut down or are not keep-alive must be released
+        // with reusable = false so they are closed rather than handed out again.
+        void releaseConnection(
+            const std::string &host,
+            const std::string &port,
+            std::shared_ptr<ssl::context> ctx,
+            std::unique_ptr<Stream> connection,
+            bool reusable)
+        {
+            Ready ready;
             {
-                auto connection = std::move(connections_.front());
-                connections_.pop_front();
-                LOG_INFO("Reusing connection from pool for {}:{}", host, port);
-                return connection;
+                std::unique_lock<std::mutex> lock(mutex_);
+                auto &pool = pools_[Key{host, port, ctx.get()}];
+                if (pool.inUse > 0)
+                {
+                    --pool.inUse;
+                }
+                evictExpired(pool);
+
+                const bool keep = reusable && connection && beast::get_lowest_layer(*connection).socket().is_open();
+                if (!pool.waiters.empty())
+                {
+                    // The oldest queued caller takes the slot: the stream itself if it
+                    // can be reused, else a new one in its place
+                    auto waiter = std::move(pool.waiters.front());
+                    pool.waiters.pop_front();
+                    ready = std::move(waiter.ready);
+                    if (keep && isAlive(*connection))
+                    {
+                        ++stats_.hits;
+                        ++pool.inUse;
+                        LOG_INFO("Handing released connection to a queued request for {}:{}", host, port);
+                    }
+                    else
+                    {
+                        connection = open(pool, *ctx);
+                        LOG_INFO("Creating new connection for a queued request to {}:{}", host, port);
+                    }
+                }
+                else if (!keep)
+                {
+                    LOG_INFO("Dropping non-reusable connection for {}:{}", host, port);
+                }
+                else if (pool.idle.size() >= config_.maxIdlePerHost)
+                {
+                    ++stats_.evictions;
+                    LOG_INFO("Idle limit ({}) reached for {}:{}, closing connection", config_.maxIdlePerHost, host, port);
+                }
+                else
+                {
+                    pool.idle.push_back({std::move(connection), std::chrono::steady_clock::now()});
+                    LOG_INFO("Released connection to pool. Idle: {}, in use: {}", pool.idle.size(), pool.inUse);
+                }
             }
-            else
+            // Destroying a dropped stream closes its socket. The queued caller runs on
+            // the io_context, not inside whichever completion released the stream.
+            if (ready)
             {
-                LOG_INFO("Creating new connection for {}:{}", host, port);
-                // Create a new connection if none are available.  The caller is responsible for
-                // ensuring the connection gets returned to the pool.
-                return std::make_unique<beast::ssl_stream<beast::tcp_stream>>(*ioc_, *ctx);
+                net::post(*ioc_, [ready = std::move(ready), connection = std::move(connection)]() mutable
+                          { ready({}, std::move(connection)); });
             }
         }
 
-        void releaseConnection(std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> connection)
+        const ConnectionPoolConfig &config() const { return config_; }
+
+        ConnectionPoolStats stats() const
         {
             std::unique_lock<std::mutex> lock(mutex_);
-            // Add the connection back to the pool.
-            connections_.push_back(std::move(connection));
-            LOG_INFO("Released connection to pool. Pool size: {}", connections_.size());
+            auto result = stats_;
+            for (const auto &[key, pool] : pools_)
+            {
+                result.inUse += pool.inUse;
+                result.idle += pool.idle.size();
+            }
+            return result;
         }
 
     private:
-        std::deque<std::unique_ptr<beast::ssl_stream<beast::tcp_stream>>> connections_;
-        std::mutex mutex_;
+        struct Key
+        {
+            std::string host;
+            std::string port;
+            const ssl::context *ctx;
+
+            bool operator==(const Key &other) const = default;
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key &key) const
+            {
+                auto h = std::hash<std::string>{}(key.host);
+                h ^= std::hash<std::string>{}(key.port) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+                h ^= std::hash<const void *>{}(key.ctx) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+                return h;
+            }
+        };
+
+        struct IdleConnection
+        {
+            std::unique_ptr<Stream> stream;
+            std::chrono::steady_clock::time_point since;
+        };
+
+        struct Waiter
+        {
+            std::size_t id;
+            Ready ready;
+            std::unique_ptr<net::steady_timer> timer;
+            CancellationToken::Registration registration;
+        };
+
+        struct HostPool
+        {
+            std::deque<IdleConnection> idle; // oldest at the front
+            std::deque<Waiter> waiters;      // oldest at the front
+            // Includes streams the background task is opening
+            std::size_t inUse = 0;
+            std::size_t replenishing = 0;
+            // Needed to open streams for the host without a caller asking
+            std::shared_ptr<ssl::context> ctx;
+        };
+
+        void evictExpired(HostPool &pool)
+        {
+            const auto cutoff = std::chrono::steady_clock::now() - config_.idleTimeout;
+            while (!pool.idle.empty() && pool.idle.front().since < cutoff)
+            {
+                pool.idle.pop_front();
+                ++stats_.evictions;
+                ++stats_.expired;
+            }
+        }
+
+        // Counts a new stream for the pool's host as in use; called with mutex_ held
+        std::unique_ptr<Stream> open(HostPool &pool, ssl::context &ctx)
+        {
+            ++stats_.misses;
+            ++pool.inUse;
+            // The caller is responsible for ensuring the connection gets returned to
+            // the pool. Each stream gets its own strand so its handlers never run
+            // concurrently on a multi-threaded ioc.
+            return std::make_unique<Stream>(net::make_strand(*ioc_), ctx);
+        }
+
+        // Called with mutex_ held
+        void enqueue(const Key &key, HostPool &pool, const RequestOptions &options, Ready ready)
+        {
+            const auto id = nextWaiter_++;
+            ++stats_.waited;
+            auto &waiter = pool.waiters.emplace_back(Waiter{id, std::move(ready), std::make_unique<net::steady_timer>(*ioc_, options.expiry())});
+            waiter.timer->async_wait([this, key, id](beast::error_code ec)
+                                     {
+                if (!ec)
+                    abandon(key, id, Error::QueueTimeout); });
+            if (options.cancellation)
+            {
+                // The token may be cancelled on any thread, or already be
+                waiter.registration = options.cancellation->onCancel([this, key, id]()
+                                                                     { net::post(*ioc_, [this, key, id]()
+                                                                                 { abandon(key, id, Error::Cancelled); }); });
+            }
+        }
+
+        // Fails a queued caller that is still waiting
+        void abandon(const Key &key, std::size_t id, Error error)
+        {
+            Ready ready;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                auto &waiters = pools_[key].waiters;
+                const auto it = std::find_if(waiters.begin(), waiters.end(), [id](const Waiter &waiter)
+                                             { return waiter.id == id; });
+                if (it == waiters.end())
+                {
+                    return;
+                }
+                ready = std::move(it->ready);
+                waiters.erase(it);
+                ++stats_.abandoned;
+            }
+            LOG_WARN("Gave up waiting for a connection to {}:{}: {}", key.host, key.port, make_error_code(error).message());
+            ready(error, nullptr);
+        }
+
+        void scheduleMaintenance()
+        {
+            maintenanceTimer_.expires_after(config_.maintenanceInterval);
+            maintenanceTimer_.async_wait([this](beast::error_code ec)
+                                         {
+                if (ec)
+                    return;
+                maintain();
+                scheduleMaintenance(); });
+        }
+
+        // Closes idle streams that expired or that the server closed, then opens
+        // replacements up to minIdlePerHost
+        void maintain()
+        {
+            struct Refill
+            {
+                std::string host;
+                std::string port;
+                std::shared_ptr<ssl::context> ctx;
+                std::size_t count;
+            };
+            std::vector<Refill> refills;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                for (auto &[key, pool] : pools_)
+                {
+                    evictExpired(pool);
+                    for (auto it = pool.idle.begin(); it != pool.idle.end();)
+                    {
+                        ++stats_.probes;
+                        if (isAlive(*it->stream))
+                        {
+                            ++it;
+                            continue;
+                        }
+                        ++stats_.evictions;
+                        ++stats_.deadOnProbe;
+                        LOG_INFO("Closing idle connection to {}:{} dropped by the server", key.host, key.port);
+                        it = pool.idle.erase(it);
+                    }
+
+                    const auto target = std::min(config_.minIdlePerHost, config_.maxIdlePerHost);
+                    const auto open = pool.idle.size() + pool.replenishing;
+                    const auto total = pool.idle.size() + pool.inUse;
+                    if (!pool.ctx || open >= target || total >= config_.maxTotalPerHost)
+                    {
+                        continue;
+                    }
+                    const auto count = std::min(target - open, config_.maxTotalPerHost - total);
+                    // Counted as in use until they are released, like any stream handed out
+                    pool.inUse += count;
+                    pool.replenishing += count;
+                    refills.push_back({key.host, key.port, pool.ctx, count});
+                }
+            }
+
+            for (const auto &refill : refills)
+            {
+                LOG_INFO("Opening {} idle connection(s) to {}:{}", refill.count, refill.host, refill.port);
+                for (std::size_t i = 0; i < refill.count; ++i)
+                {
+                    replenish(refill.host, refill.port, refill.ctx);
+                }
+            }
+        }
+
+        void replenish(const std::string &host, const std::string &port, std::shared_ptr<ssl::context> ctx)
+        {
+            auto stream = std::make_shared<std::unique_ptr<Stream>>(std::make_unique<Stream>(net::make_strand(*ioc_), *ctx));
+            const auto opened = [this, stream, host, port, ctx](beast::error_code ec, const char *what)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    --pools_[Key{host, port, ctx.get()}].replenishing;
+                    ++(ec ? stats_.replenishFailures : stats_.replenished);
+                }
+                if (ec)
+                {
+                    LOG_WARN("Replacement connection to {}:{} failed in {}: {}", host, port, what, ec.message());
+                }
+                releaseConnection(host, port, ctx, std::move(*stream), !ec);
+            };
+            net::dispatch((*stream)->get_executor(), [stream, host, port, opened]()
+                          { Connector::establish(**stream, host, port, opened); });
+        }
+
+        // An idle keep-alive stream must have nothing to read. A zero-byte peek means the
+        // peer closed it; any pending bytes (close_notify, a stray response) make it unusable.
+        static bool isAlive(Stream &stream)
+        {
+            auto &socket = beast::get_lowest_layer(stream).socket();
+            if (!socket.is_open())
+            {
+                return false;
+            }
+            char byte;
+            const auto n = ::recv(socket.native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+
+        std::unordered_map<Key, HostPool, KeyHash> pools_;
+        ConnectionPoolStats stats_;
+        std::size_t nextWaiter_ = 0;
+        mutable std::mutex mutex_;
         std::shared_ptr<net::io_context> ioc_;
+        ConnectionPoolConfig config_;
+        net::steady_timer maintenanceTimer_;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,181 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include "Solana/Logger.hpp"
+#include "Solana/Network/DnsCache.hpp"
+#include "Solana/Network/HappyEyeballs.hpp"
+#include "Solana/Network/TlsSessionCache.hpp"
+#include "Solana/Network/RequestOptions.hpp"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace ssl = net::ssl;
+using net::ip::tcp;
+
+namespace Solana::Network
+{
+    // Resolves, connects and TLS-handshakes a stream. The stream must outlive the
+    // operation; the handler runs on the stream's executor with the failed stage
+    // name ("resolve", "connect", "handshake") or nullptr on success. All three
+    // stages share one deadline; running out of it fails with the stage's
+    // Network::Error timeout code. Addresses come from the shared DnsCache and are
+    // raced with HappyEyeballs, so a reconnect to a known host skips the resolver;
+    // the handshake resumes a cached session when the context has a TlsSessionCache.
+    class Connector : public std::enable_shared_from_this<Connector>
+    {
+    public:
+        using Stream = beast::ssl_stream<beast::tcp_stream>;
+        using Handler = std::function<void(beast::error_code, const char *)>;
+
+        static std::shared_ptr<Connector> establish(
+            Stream &stream, const std::string &host, const std::string &port, Handler handler,
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + RequestOptions::defaultTimeout)
+        {
+            auto connector = std::shared_ptr<Connector>(new Connector(stream, host, port, std::move(handler), deadline));
+            connector->start();
+            return connector;
+        }
+
+        // Aborts whichever stage is in flight; the handler then sees operation_aborted.
+        // Must be called on the stream's executor.
+        void cancel()
+        {
+            if (resolving_)
+            {
+                // A lookup may be shared with other connections, so stop waiting for it
+                // rather than cancelling it
+                resolving_ = false;
+                resolveTimer_.cancel();
+                net::post(stream_.get_executor(), [self = shared_from_this()]()
+                          { self->handler_(net::error::operation_aborted, "resolve"); });
+                return;
+            }
+            if (eyeballs_)
+            {
+                eyeballs_->cancel();
+            }
+            beast::get_lowest_layer(stream_).cancel();
+        }
+
+    private:
+        Connector(Stream &stream, const std::string &host, const std::string &port, Handler handler,
+                  std::chrono::steady_clock::time_point deadline)
+            : stream_(stream), host_(host), port_(port), handler_(std::move(handler)), deadline_(deadline),
+              resolveTimer_(stream.get_executor())
+        {
+        }
+
+        void start()
+        {
+            // Set the SNI Hostname (many hosts need this to handshake successfully)
+            if (!SSL_set_tlsext_host_name(stream_.native_handle(), host_.c_str()))
+            {
+                LOG_ERROR("Failed to set SNI hostname: {}", host_);
+                beast::error_code ec{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
+                net::post(stream_.get_executor(), [self = shared_from_this(), ec]()
+                          { self->handler_(ec, "sni"); });
+                return;
+            }
+
+            // Resume an earlier session with this host when the context keeps them
+            TlsSessionCache::offer(stream_.native_handle());
+
+            LOG_INFO("Opening new connection to {}:{}", host_, port_);
+            resolving_ = true;
+            // The cache does not bound how long a lookup takes, so bound it separately
+            resolveTimer_.expires_at(deadline_);
+            resolveTimer_.async_wait([self = shared_from_this()](beast::error_code ec)
+                                     {
+                if (!ec && self->resolving_)
+                {
+                    self->resolving_ = false;
+                    self->handler_(timeoutAt("resolve"), "resolve");
+                } });
+            // Lookups complete on the stream's strand so every completion in this chain is serialized
+            DnsCache::shared()->resolve(
+                stream_.get_executor(),
+                host_,
+                port_,
+                [self = shared_from_this()](beast::error_code ec, DnsCache::Endpoints endpoints)
+                {
+                    if (!self->resolving_)
+                    {
+                        return;
+                    }
+                    self->resolving_ = false;
+                    self->resolveTimer_.cancel();
+                    self->on_resolve(ec, std::move(endpoints));
+                });
+        }
+
+        void on_resolve(beast::error_code ec, DnsCache::Endpoints endpoints)
+        {
+            LOG_INFO("DNS resolution complete for {}:{}", host_, port_);
+            if (ec)
+            {
+                handler_(ec, "resolve");
+                return;
+            }
+
+            eyeballs_ = HappyEyeballs::connect(
+                stream_.get_executor(),
+                std::move(endpoints),
+                deadline_,
+                [self = shared_from_this()](beast::error_code ec, HappyEyeballs::Socket socket)
+                {
+                    self->eyeballs_.reset();
+                    if (!ec)
+                    {
+                        beast::get_lowest_layer(self->stream_).socket() = std::move(socket);
+                    }
+                    self->on_connect(ec);
+                });
+        }
+
+        void on_connect(beast::error_code ec)
+        {
+            LOG_INFO("TCP connection established with {}:{}", host_, port_);
+            if (ec)
+            {
+                handler_(ec == beast::error::timeout ? timeoutAt("connect") : ec, "connect");
+                return;
+            }
+
+            beast::get_lowest_layer(stream_).expires_at(deadline_);
+
+            stream_.async_handshake(
+                ssl::stream_base::client,
+                [self = shared_from_this()](beast::error_code ec)
+                {
+                    self->on_handshake(ec);
+                });
+        }
+
+        void on_handshake(beast::error_code ec)
+        {
+            LOG_INFO("TLS handshake completed for {}:{}", host_, port_);
+            if (ec == beast::error::timeout)
+            {
+                ec = timeoutAt("handshake");
+            }
+            else if (!ec)
+            {
+                TlsSessionCache::completed(stream_.native_handle());
+            }
+            handler_(ec, ec ? "handshake" : nullptr);
+        }
+
+        Stream &stream_;
+        std::string host_;
+        std::string port_;
+        Handler handler_;
+        std::chrono::steady_clock::time_point deadline_;
+        net::steady_timer resolveTimer_;
+        std::shared_ptr<HappyEyeballs> eyeballs_;
+        bool resolving_ = false;
+    };
+}
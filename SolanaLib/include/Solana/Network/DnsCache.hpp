@@ -0,0 +1,224 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Solana/Logger.hpp"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+using net::ip::tcp;
+
+namespace Solana::Network
+{
+    struct DnsCacheConfig
+    {
+        // How long resolved addresses are reused. getaddrinfo does not report the
+        // records' TTLs, so this stands in for them.
+        std::chrono::seconds ttl{60};
+        // A hit on an entry this close to expiring refreshes it in the background,
+        // so busy hosts never wait on the resolver again
+        std::chrono::seconds refreshBefore{15};
+        // Expired addresses are still handed out for this long when a fresh lookup fails
+        std::chrono::seconds serveStaleFor{300};
+    };
+
+    struct DnsCacheStats
+    {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t refreshes = 0;
+        std::size_t failures = 0;
+        // Lookups that failed and were answered from an expired entry instead
+        std::size_t staleHits = 0;
+    };
+
+    // Resolved addresses by host and port, shared by every connection so that only
+    // the first one to a host (and one background refresh per TTL) pays for a
+    // lookup. Addresses come back interleaved by family, IPv6 first when the
+    // resolver prefers it, ready for HappyEyeballs. Thread-safe.
+    class DnsCache : public std::enable_shared_from_this<DnsCache>
+    {
+    public:
+        using Endpoints = std::vector<tcp::endpoint>;
+        using Handler = std::function<void(beast::error_code, Endpoints)>;
+
+        explicit DnsCache(const DnsCacheConfig &config = {}) : config_(config) {}
+
+        // The process-wide cache HttpClient and WebSocket connect through
+        static std::shared_ptr<DnsCache> shared()
+        {
+            static const auto cache = std::make_shared<DnsCache>();
+            return cache;
+        }
+
+        // Calls handler on executor with the addresses for host:port. Lookups that
+        // miss, and background refreshes, run a resolver on executor.
+        void resolve(const net::any_io_executor &executor, const std::string &host, const std::string &port, Handler handler)
+        {
+            const auto key = host + ':' + port;
+            const auto now = std::chrono::steady_clock::now();
+            bool refresh = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto it = entries_.find(key);
+                if (it != entries_.end() && now < it->second.expires)
+                {
+                    ++stats_.hits;
+                    auto &entry = it->second;
+                    // refreshAfter moves on as soon as one caller claims the refresh, and a
+                    // refresh that never completes is simply retried a while later
+                    if (now >= entry.refreshAfter)
+                    {
+                        refresh = true;
+                        entry.refreshAfter = now + config_.refreshBefore;
+                        ++stats_.refreshes;
+                    }
+                    net::post(executor, [handler = std::move(handler), endpoints = entry.endpoints]() mutable
+                              { handler({}, std::move(endpoints)); });
+                    if (!refresh)
+                    {
+                        return;
+                    }
+                }
+                else
+                {
+                    ++stats_.misses;
+                }
+            }
+
+            if (refresh)
+            {
+                LOG_INFO("Refreshing DNS entry for {}", key);
+                lookup(executor, host, port, nullptr);
+                return;
+            }
+            lookup(executor, host, port, std::move(handler));
+        }
+
+        // Resolves host:port ahead of the first connection to it
+        void prefetch(const net::any_io_executor &executor, const std::string &host, const std::string &port)
+        {
+            resolve(executor, host, port, [](beast::error_code, Endpoints) {});
+        }
+
+        // Asio-style resolve(); completes with (error_code, Endpoints)
+        template <typename CompletionToken>
+        auto asyncResolve(const net::any_io_executor &executor, const std::string &host, const std::string &port,
+                          CompletionToken &&token)
+        {
+            return net::async_initiate<CompletionToken, void(beast::error_code, Endpoints)>(
+                [self = shared_from_this(), executor, host, port](auto handler)
+                {
+                    // Handler is stored in a std::function, which needs it copyable
+                    auto shared = std::make_shared<decltype(handler)>(std::move(handler));
+                    self->resolve(executor, host, port, [shared](beast::error_code ec, Endpoints endpoints)
+                                  { (*shared)(ec, std::move(endpoints)); });
+                },
+                token);
+        }
+
+        void invalidate(const std::string &host, const std::string &port)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            entries_.erase(host + ':' + port);
+        }
+
+        DnsCacheStats stats() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+        // Alternates address families starting with the resolver's first choice (RFC 8305)
+        static Endpoints interleave(const tcp::resolver::results_type &results)
+        {
+            Endpoints preferred;
+            Endpoints other;
+            for (const auto &result : results)
+            {
+                const auto &endpoint = result.endpoint();
+                (preferred.empty() || endpoint.protocol() == preferred.front().protocol() ? preferred : other).push_back(endpoint);
+            }
+            Endpoints endpoints;
+            endpoints.reserve(preferred.size() + other.size());
+            for (std::size_t i = 0; i < std::max(preferred.size(), other.size()); ++i)
+            {
+                if (i < preferred.size())
+                    endpoints.push_back(preferred[i]);
+                if (i < other.size())
+                    endpoints.push_back(other[i]);
+            }
+            return endpoints;
+        }
+
+    private:
+        struct Entry
+        {
+            Endpoints endpoints;
+            std::chrono::steady_clock::time_point expires;
+            std::chrono::steady_clock::time_point refreshAfter;
+        };
+
+        // Runs a resolver on executor and stores what it finds; handler may be empty
+        // for a background refresh
+        void lookup(const net::any_io_executor &executor, const std::string &host, const std::string &port, Handler handler)
+        {
+            auto resolver = std::make_shared<tcp::resolver>(executor);
+            resolver->async_resolve(
+                host,
+                port,
+                [self = shared_from_this(), resolver, key = host + ':' + port, handler = std::move(handler)](
+                    beast::error_code ec, tcp::resolver::results_type results)
+                {
+                    auto endpoints = ec ? Endpoints{} : interleave(results);
+                    if (!ec && endpoints.empty())
+                    {
+                        ec = net::error::host_not_found;
+                    }
+                    self->store(key, ec, endpoints);
+                    if (handler)
+                    {
+                        handler(ec, std::move(endpoints));
+                    }
+                });
+        }
+
+        // On failure, fills endpoints from a recently expired entry when there is one
+        void store(const std::string &key, beast::error_code &ec, Endpoints &endpoints)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (!ec)
+            {
+                entries_[key] = Entry{endpoints, now + config_.ttl, now + config_.ttl - config_.refreshBefore};
+                return;
+            }
+
+            ++stats_.failures;
+            const auto it = entries_.find(key);
+            if (it == entries_.end() || now >= it->second.expires + config_.serveStaleFor)
+            {
+                LOG_ERROR("DNS resolution failed for {}: {}", key, ec.message());
+                return;
+            }
+            if (now >= it->second.expires)
+            {
+                LOG_WARN("DNS resolution failed for {} ({}), using the last known addresses", key, ec.message());
+                ++stats_.staleHits;
+            }
+            endpoints = it->second.endpoints;
+            ec = {};
+        }
+
+        DnsCacheConfig config_;
+        std::unordered_map<std::string, Entry> entries_;
+        DnsCacheStats stats_;
+        mutable std::mutex mutex_;
+    };
+}
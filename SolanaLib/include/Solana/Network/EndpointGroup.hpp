@@ -0,0 +1,612 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "Solana/Logger.hpp"
+#include "Solana/Network/HttpClient.hpp"
+#include "Solana/Network/LatencyWindow.hpp"
+#include "Solana/Network/RpcError.hpp"
+
+namespace Solana::Network
+{
+    struct HedgeConfig
+    {
+        // Send idempotent requests to a second endpoint when the first has not
+        // answered within its recent `quantile` latency; the first reply wins
+        bool enabled = true;
+        double quantile = 0.95;
+        // Hedge delay until an endpoint has latency samples, and bounds on the adaptive delay
+        std::chrono::milliseconds initialDelay{100};
+        std::chrono::milliseconds minDelay{1};
+        std::chrono::milliseconds maxDelay{2000};
+        // Latency samples kept per endpoint
+        std::size_t window = 256;
+    };
+
+    struct BalancerConfig
+    {
+        // Weight of the newest sample in the latency and error-rate moving averages
+        double ewmaAlpha = 0.2;
+        // Latency an endpoint is charged per unit of error rate when routing. Failed
+        // replies are often fast, so errors must cost more than any healthy latency.
+        std::chrono::milliseconds errorPenalty{1000};
+        // Consecutive transport failures (timeouts, connection errors, 5xx) that open
+        // an endpoint's circuit. While open it gets no traffic; once openFor has passed
+        // a single probe request decides whether it closes or stays open twice as long.
+        std::size_t failureThreshold = 5;
+        std::chrono::milliseconds openFor{1000};
+        std::chrono::milliseconds maxOpenFor{30000};
+        // Pause after a 429 that carried no Retry-After
+        std::chrono::milliseconds rateLimitPause{1000};
+    };
+
+    struct EndpointStats
+    {
+        std::string endpoint;
+        // Attempts sent here, hedges included
+        std::size_t requests = 0;
+        std::size_t failures = 0;
+        // 429 replies, each of which paused the endpoint
+        std::size_t rateLimited = 0;
+        // Hedge attempts sent here, and how many of them answered first
+        std::size_t hedges = 0;
+        std::size_t hedgeWins = 0;
+        std::chrono::microseconds ewmaLatency{0};
+        double errorRate = 0.0;
+        bool circuitOpen = false;
+        std::chrono::microseconds p50{0};
+        std::chrono::microseconds p95{0};
+    };
+
+    // Several HttpClients for the same RPC service at different providers.
+    //
+    // Routing is power-of-two-choices: each request samples two endpoints whose
+    // circuit is closed and takes the one with the lower EWMA latency, inflated by
+    // its recent error rate. Endpoints that keep failing are circuit-broken, and a
+    // 429 pauses an endpoint for its Retry-After; if every endpoint is unavailable
+    // the one that recovers soonest is used rather than failing the request.
+    //
+    // Idempotent requests are hedged to the other sampled endpoint if no reply
+    // arrives within the primary's recent p95, and whichever attempt loses the race
+    // is cancelled. Transport failures and 429s fail over the same way; a 429 is
+    // also retried elsewhere for non-idempotent requests, since the provider
+    // rejected it unprocessed. With a single endpoint this behaves like an HttpClient.
+    class EndpointGroup
+    {
+    public:
+        explicit EndpointGroup(const std::vector<std::string> &endpoints,
+                               const HttpClientConfig &config = {},
+                               const HedgeConfig &hedge = {},
+                               const BalancerConfig &balancer = {})
+            : hedge_(hedge), balancer_(balancer)
+        {
+            if (endpoints.empty())
+            {
+                throw std::invalid_argument("EndpointGroup needs at least one endpoint");
+            }
+            for (const auto &endpoint : endpoints)
+            {
+                endpoints_.push_back(std::make_unique<Endpoint>(endpoint, config, hedge_.window));
+            }
+            LOG_INFO("EndpointGroup over {} endpoint(s), hedging {}", endpoints_.size(), hedge_.enabled ? "on" : "off");
+        }
+
+        std::size_t size() const { return endpoints_.size(); }
+
+        // The first endpoint's io_context; lets callers schedule timers alongside requests
+        std::shared_ptr<net::io_context> context() const { return endpoints_.front()->client.context(); }
+
+        // Called with the pause each time an endpoint answers 429. Set before sending.
+        void onRateLimited(std::function<void(std::chrono::milliseconds)> listener)
+        {
+            rateLimited_ = std::move(listener);
+        }
+
+        std::vector<EndpointStats> stats() const
+        {
+            std::vector<EndpointStats> result;
+            for (const auto &endpoint : endpoints_)
+            {
+                result.push_back(endpoint->stats());
+            }
+            return result;
+        }
+
+        template <typename T>
+        std::future<T> post(const json &body, const RequestOptions &options = {})
+        {
+            auto promise = std::make_shared<std::promise<T>>();
+            auto future = promise->get_future();
+            send<T>(body, options, [promise](std::exception_ptr ex, T result)
+                    {
+                if (ex)
+                    promise->set_exception(ex);
+                else
+                    promise->set_value(std::move(result)); });
+            return future;
+        }
+
+        template <typename T, typename CompletionToken>
+        auto asyncPost(const json &body, CompletionToken &&token)
+        {
+            return asyncPost<T>(body, RequestOptions{}, std::forward<CompletionToken>(token));
+        }
+
+        template <typename T, typename CompletionToken>
+        auto asyncPost(const json &body, const RequestOptions &options, CompletionToken &&token)
+        {
+            return net::async_initiate<CompletionToken, void(std::exception_ptr, T)>(
+                [this](auto handler, const json &body, RequestOptions options)
+                {
+                    auto slot = net::get_associated_cancellation_slot(handler);
+                    if (slot.is_connected())
+                    {
+                        if (!options.cancellation)
+                        {
+                            options.cancellation = std::make_shared<CancellationToken>();
+                        }
+                        slot.assign([cancellation = options.cancellation](net::cancellation_type)
+                                    { cancellation->cancel(); });
+                    }
+                    send<T>(body, options, bindCompletion<T>(std::move(handler), context()->get_executor()));
+                },
+                token, body, options);
+        }
+
+    private:
+        // How an attempt ended, as far as the endpoint's health is concerned
+        enum class Outcome
+        {
+            // A reply, possibly a JSON-RPC (RpcError) or 4xx error: the endpoint is healthy
+            Answered,
+            Failed,
+            RateLimited,
+            Cancelled
+        };
+
+        struct Endpoint
+        {
+            Endpoint(const std::string &url, const HttpClientConfig &config, std::size_t window)
+                : url(url), client(Url(url), config), latencies(window)
+            {
+            }
+
+            EndpointStats stats() const
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                return EndpointStats{
+                    .endpoint = url,
+                    .requests = requests,
+                    .failures = failures,
+                    .rateLimited = rateLimited,
+                    .hedges = hedges,
+                    .hedgeWins = hedgeWins,
+                    .ewmaLatency = std::chrono::microseconds(static_cast<long>(ewmaMicros)),
+                    .errorRate = errorRate,
+                    .circuitOpen = std::chrono::steady_clock::now() < openUntil,
+                    .p50 = latencies.quantile(0.5),
+                    .p95 = latencies.quantile(0.95)};
+            }
+
+            // Routing cost: latency plus the recent error rate charged at `penaltyMicros`.
+            // An unmeasured healthy endpoint costs nothing, so it gets tried.
+            double score(double penaltyMicros) const { return ewmaMicros + errorRate * penaltyMicros; }
+
+            // Closed, or open but due for its single probe
+            bool available(std::chrono::steady_clock::time_point now) const
+            {
+                return now >= openUntil && !probing;
+            }
+
+            std::string url;
+            HttpClient client;
+            mutable std::mutex mutex;
+            // Latencies of recent successful attempts
+            LatencyWindow latencies;
+            double ewmaMicros = 0.0;
+            bool measured = false;
+            double errorRate = 0.0;
+            std::size_t consecutiveFailures = 0;
+            // Circuit state: open until openUntil, then half-open while a probe is out
+            std::chrono::steady_clock::time_point openUntil{};
+            std::chrono::milliseconds openFor{0};
+            bool tripped = false;
+            bool probing = false;
+            std::size_t requests = 0;
+            std::size_t failures = 0;
+            std::size_t rateLimited = 0;
+            std::size_t hedges = 0;
+            std::size_t hedgeWins = 0;
+        };
+
+        // One hedged request: a primary and at most one hedge attempt racing for a
+        // single completion
+        template <typename T>
+        struct Race
+        {
+            std::mutex mutex;
+            Completion<T> done;
+            bool settled = false;
+            bool hedged = false;
+            std::size_t outstanding = 0;
+            std::exception_ptr lastError;
+            // Per attempt: the endpoint it goes to and the token that cancels it
+            std::size_t endpoints[2];
+            std::shared_ptr<CancellationToken> attempts[2];
+            // Passes the caller's cancel on to both attempts until the race settles
+            CancellationToken::Registration forward;
+            json body;
+            RequestOptions options;
+            // Keeps the timer's io_context alive for as long as the timer
+            std::shared_ptr<net::io_context> ioc;
+            std::optional<net::steady_timer> timer;
+        };
+
+        // Power of two choices among available endpoints, best first. The second
+        // entry is the hedge and failover target; it is absent with one endpoint.
+        // `exclude` keeps a failed endpoint out of a retry.
+        std::vector<std::size_t> choose(std::optional<std::size_t> exclude = std::nullopt) const
+        {
+            const auto now = std::chrono::steady_clock::now();
+            std::vector<std::size_t> candidates;
+            std::size_t soonest = endpoints_.size();
+            auto soonestAt = std::chrono::steady_clock::time_point::max();
+            for (std::size_t i = 0; i < endpoints_.size(); ++i)
+            {
+                if (i == exclude)
+                {
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(endpoints_[i]->mutex);
+                if (endpoints_[i]->available(now))
+                {
+                    candidates.push_back(i);
+                }
+                else if (endpoints_[i]->openUntil < soonestAt)
+                {
+                    soonest = i;
+                    soonestAt = endpoints_[i]->openUntil;
+                }
+            }
+            if (candidates.empty())
+            {
+                if (soonest == endpoints_.size())
+                {
+                    return {};
+                }
+                return {soonest};
+            }
+
+            thread_local std::minstd_rand rng(std::random_device{}());
+            if (candidates.size() > 2)
+            {
+                // Two distinct random picks, moved to the front
+                std::swap(candidates[0], candidates[rng() % candidates.size()]);
+                std::swap(candidates[1], candidates[1 + rng() % (candidates.size() - 1)]);
+                candidates.resize(2);
+            }
+            if (candidates.size() == 2 && score(candidates[1]) < score(candidates[0]))
+            {
+                std::swap(candidates[0], candidates[1]);
+            }
+            return candidates;
+        }
+
+        double score(std::size_t index) const
+        {
+            std::unique_lock<std::mutex> lock(endpoints_[index]->mutex);
+            return endpoints_[index]->score(std::chrono::duration<double, std::micro>(balancer_.errorPenalty).count());
+        }
+
+        static Outcome classify(std::exception_ptr ex, std::optional<std::chrono::seconds> &retryAfter)
+        {
+            if (!ex)
+            {
+                return Outcome::Answered;
+            }
+            try
+            {
+                std::rethrow_exception(ex);
+            }
+            catch (const HttpStatusError &e)
+            {
+                retryAfter = e.retryAfter();
+                if (e.rateLimited())
+                {
+                    return Outcome::RateLimited;
+                }
+                return e.status() >= 500 ? Outcome::Failed : Outcome::Answered;
+            }
+            catch (const boost::system::system_error &e)
+            {
+                return e.code() == Error::Cancelled ? Outcome::Cancelled : Outcome::Failed;
+            }
+            catch (const RpcError &)
+            {
+                return Outcome::Answered;
+            }
+            catch (...)
+            {
+                // A 200 whose body is not a JSON-RPC reply: a proxy's error page, a
+                // truncated body
+                return Outcome::Failed;
+            }
+        }
+
+        // Folds one attempt into the endpoint's averages and circuit state. `probe`
+        // marks the attempt holding the half-open slot, which only it releases.
+        void record(Endpoint &endpoint, Outcome outcome, std::chrono::microseconds elapsed, std::optional<std::chrono::seconds> retryAfter, bool probe)
+        {
+            const auto pause = retryAfter ? std::chrono::duration_cast<std::chrono::milliseconds>(*retryAfter) : balancer_.rateLimitPause;
+            if (outcome == Outcome::RateLimited && rateLimited_)
+            {
+                rateLimited_(pause);
+            }
+
+            const auto alpha = balancer_.ewmaAlpha;
+            const auto now = std::chrono::steady_clock::now();
+            std::unique_lock<std::mutex> lock(endpoint.mutex);
+            if (probe)
+            {
+                endpoint.probing = false;
+            }
+
+            if (outcome == Outcome::Answered)
+            {
+                endpoint.latencies.record(elapsed);
+                endpoint.ewmaMicros = endpoint.measured ? alpha * elapsed.count() + (1 - alpha) * endpoint.ewmaMicros : elapsed.count();
+                endpoint.measured = true;
+            }
+            if (outcome == Outcome::Cancelled)
+            {
+                // A hedge loser would have taken at least `elapsed`. That bound may raise
+                // the estimates, so a slow endpoint that always loses stops being picked
+                // first, but never lowers them: a hedge cancelled just after it was sent
+                // says nothing about how fast its endpoint is.
+                const auto threshold = endpoint.latencies.empty() ? hedge_.initialDelay : endpoint.latencies.quantile(hedge_.quantile);
+                if (elapsed > threshold)
+                {
+                    endpoint.latencies.record(elapsed);
+                }
+                const auto bound = std::max<double>(elapsed.count(), endpoint.ewmaMicros);
+                endpoint.ewmaMicros = endpoint.measured ? alpha * bound + (1 - alpha) * endpoint.ewmaMicros : bound;
+                return;
+            }
+            endpoint.errorRate = alpha * (outcome == Outcome::Answered ? 0.0 : 1.0) + (1 - alpha) * endpoint.errorRate;
+
+            switch (outcome)
+            {
+            case Outcome::Answered:
+                endpoint.consecutiveFailures = 0;
+                if (endpoint.tripped)
+                {
+                    LOG_INFO("Circuit for {} closed", endpoint.url);
+                    endpoint.tripped = false;
+                    endpoint.openFor = std::chrono::milliseconds(0);
+                }
+                break;
+            case Outcome::RateLimited:
+            {
+                ++endpoint.rateLimited;
+                endpoint.openUntil = std::max(endpoint.openUntil, now + pause);
+                LOG_WARN("{} is rate limiting, pausing it for {}ms", endpoint.url, pause.count());
+                break;
+            }
+            case Outcome::Failed:
+                ++endpoint.failures;
+                if (probe || ++endpoint.consecutiveFailures >= balancer_.failureThreshold)
+                {
+                    endpoint.openFor = endpoint.tripped ? std::min(endpoint.openFor * 2, balancer_.maxOpenFor) : balancer_.openFor;
+                    endpoint.openUntil = now + endpoint.openFor;
+                    endpoint.tripped = true;
+                    endpoint.consecutiveFailures = 0;
+                    LOG_WARN("Circuit for {} open for {}ms", endpoint.url, endpoint.openFor.count());
+                }
+                break;
+            case Outcome::Cancelled:
+                break;
+            }
+        }
+
+        std::chrono::steady_clock::duration hedgeDelay(const Endpoint &endpoint) const
+        {
+            std::unique_lock<std::mutex> lock(endpoint.mutex);
+            if (endpoint.latencies.empty())
+            {
+                return hedge_.initialDelay;
+            }
+            return std::clamp<std::chrono::steady_clock::duration>(endpoint.latencies.quantile(hedge_.quantile), hedge_.minDelay, hedge_.maxDelay);
+        }
+
+        template <typename T>
+        void send(const json &body, const RequestOptions &options, Completion<T> done)
+        {
+            const auto order = choose();
+            if (!hedge_.enabled || !options.idempotent || order.size() < 2)
+            {
+                sendOnce<T>(order.front(), body, options, std::move(done));
+                return;
+            }
+
+            auto race = std::make_shared<Race<T>>();
+            race->done = std::move(done);
+            race->endpoints[0] = order[0];
+            race->endpoints[1] = order[1];
+            race->body = body;
+            // Both attempts share the caller's deadline rather than each starting a fresh timeout
+            race->options = options.anchored();
+            for (auto &attempt : race->attempts)
+            {
+                attempt = std::make_shared<CancellationToken>();
+            }
+            if (options.cancellation)
+            {
+                race->forward = options.cancellation->onCancel([first = race->attempts[0], second = race->attempts[1]]()
+                                                               {
+                    first->cancel();
+                    second->cancel(); });
+            }
+            race->ioc = endpoints_[order[0]]->client.context();
+            {
+                std::unique_lock<std::mutex> lock(race->mutex);
+                race->outstanding = 1;
+                race->timer.emplace(*race->ioc, hedgeDelay(*endpoints_[order[0]]));
+                // Only a weak reference, so a settled race frees its timer (and cancels the wait)
+                race->timer->async_wait([this, weak = std::weak_ptr<Race<T>>(race)](beast::error_code ec)
+                                        {
+                    auto race = weak.lock();
+                    if (ec || !race || !claimHedge(*race))
+                        return;
+                    LOG_INFO("No reply from {} yet, hedging to {}", endpoints_[race->endpoints[0]]->url, endpoints_[race->endpoints[1]]->url);
+                    launch<T>(race, 1); });
+            }
+            launch<T>(race, 0);
+        }
+
+        // A single attempt, retried once on another endpoint if this one answered 429
+        template <typename T>
+        void sendOnce(std::size_t index, const json &body, const RequestOptions &options, Completion<T> done)
+        {
+            auto retry = endpoints_.size() > 1 ? std::make_shared<const json>(body) : nullptr;
+            attempt<T>(index, body, options, options.cancellation, [this, index, retry, options, done = std::move(done)](Outcome outcome, std::exception_ptr ex, T result)
+                       {
+                if (outcome == Outcome::RateLimited && retry)
+                {
+                    if (const auto next = choose(index); !next.empty())
+                    {
+                        LOG_WARN("Retrying rate-limited request on {}", endpoints_[next.front()]->url);
+                        attempt<T>(next.front(), *retry, options, options.cancellation, [done](Outcome, std::exception_ptr ex, T result)
+                                   { done(ex, std::move(result)); });
+                        return;
+                    }
+                }
+                done(ex, std::move(result)); });
+        }
+
+        // Claims the hedge attempt; false once the race is settled or already hedged
+        template <typename T>
+        static bool claimHedge(Race<T> &race)
+        {
+            std::unique_lock<std::mutex> lock(race.mutex);
+            if (race.settled || race.hedged)
+            {
+                return false;
+            }
+            race.hedged = true;
+            ++race.outstanding;
+            return true;
+        }
+
+        template <typename T>
+        void launch(const std::shared_ptr<Race<T>> &race, std::size_t slot)
+        {
+            auto options = race->options;
+            options.cancellation = race->attempts[slot];
+            attempt<T>(race->endpoints[slot], race->body, options, race->options.cancellation,
+                       [this, race, slot](Outcome outcome, std::exception_ptr ex, T result)
+                       { settle<T>(race, slot, outcome, ex, std::move(result)); },
+                       slot == 1);
+        }
+
+        // The first reply wins and cancels the other attempt; an error reply counts,
+        // since the other endpoint would give the same answer. A transport failure or
+        // 429 only fails the caller once no attempt is left, and on the primary before
+        // the hedge delay is up it hedges straight away.
+        template <typename T>
+        void settle(const std::shared_ptr<Race<T>> &race, std::size_t slot, Outcome outcome, std::exception_ptr ex, T result)
+        {
+            std::unique_lock<std::mutex> lock(race->mutex);
+            --race->outstanding;
+            if (race->settled)
+            {
+                return;
+            }
+            if (outcome == Outcome::Answered)
+            {
+                race->settled = true;
+                race->timer->cancel();
+                lock.unlock();
+                race->attempts[1 - slot]->cancel();
+                race->forward.reset();
+                if (slot == 1)
+                {
+                    auto &endpoint = *endpoints_[race->endpoints[1]];
+                    std::unique_lock<std::mutex> statsLock(endpoint.mutex);
+                    ++endpoint.hedgeWins;
+                }
+                race->done(ex, std::move(result));
+                return;
+            }
+
+            race->lastError = ex;
+            if (!race->hedged && !race->attempts[0]->cancelled())
+            {
+                race->hedged = true;
+                ++race->outstanding;
+                race->timer->cancel();
+                lock.unlock();
+                LOG_WARN("Request to {} failed, hedging to {}", endpoints_[race->endpoints[0]]->url, endpoints_[race->endpoints[1]]->url);
+                launch<T>(race, 1);
+                return;
+            }
+            if (race->outstanding == 0)
+            {
+                race->settled = true;
+                lock.unlock();
+                race->forward.reset();
+                race->done(race->lastError, T{});
+            }
+        }
+
+        // One request to one endpoint; its outcome feeds the endpoint's health before
+        // the callback sees it. `caller` is the caller's own token, which a race
+        // replaces in options with a per-attempt one; an attempt it cancelled is not
+        // the endpoint's doing.
+        template <typename T>
+        void attempt(std::size_t index, const json &body, const RequestOptions &options,
+                     std::shared_ptr<CancellationToken> caller,
+                     std::function<void(Outcome, std::exception_ptr, T)> done, bool hedge = false)
+        {
+            auto &endpoint = *endpoints_[index];
+            bool probe = false;
+            {
+                std::unique_lock<std::mutex> lock(endpoint.mutex);
+                ++endpoint.requests;
+                endpoint.hedges += hedge ? 1 : 0;
+                // The first attempt after an open circuit's time is up takes the half-open
+                // probe slot, keeping other requests off until it resolves. Attempts sent
+                // anyway, with nowhere else to go, leave the slot alone.
+                probe = endpoint.tripped && !endpoint.probing && std::chrono::steady_clock::now() >= endpoint.openUntil;
+                endpoint.probing = endpoint.probing || probe;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            endpoint.client.asyncPost<T>(body, options, [this, &endpoint, start, probe, caller, done = std::move(done)](std::exception_ptr ex, T result)
+                                         {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                std::optional<std::chrono::seconds> retryAfter;
+                const auto outcome = classify(ex, retryAfter);
+                if (outcome == Outcome::Cancelled && caller && caller->cancelled())
+                {
+                    // The caller gave up, which says nothing about the endpoint
+                    std::unique_lock<std::mutex> lock(endpoint.mutex);
+                    endpoint.probing = endpoint.probing && !probe;
+                }
+                else
+                {
+                    record(endpoint, outcome, elapsed, retryAfter, probe);
+                }
+                done(outcome, ex, std::move(result)); });
+        }
+
+        HedgeConfig hedge_;
+        BalancerConfig balancer_;
+        std::function<void(std::chrono::milliseconds)> rateLimited_;
+        std::vector<std::unique_ptr<Endpoint>> endpoints_;
+    };
+}
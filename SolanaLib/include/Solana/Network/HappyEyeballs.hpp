@@ -0,0 +1,189 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Solana/Logger.hpp"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+using net::ip::tcp;
+
+namespace Solana::Network
+{
+    // Connects to the first of several addresses to answer (RFC 8305). Attempts
+    // start in order, a new one every attemptDelay or as soon as the previous one
+    // fails, and race each other; the winner's socket is handed over and the rest
+    // are closed. A host whose first address is unreachable then costs one delay
+    // rather than a full connect timeout.
+    //
+    // Completions run on the executor, which must be a strand when its context
+    // runs on more than one thread.
+    class HappyEyeballs : public std::enable_shared_from_this<HappyEyeballs>
+    {
+    public:
+        using Socket = beast::tcp_stream::socket_type;
+        using Handler = std::function<void(beast::error_code, Socket)>;
+
+        static constexpr std::chrono::milliseconds attemptDelay{250};
+
+        // Fails with beast::error::timeout if nothing connects by the deadline
+        static std::shared_ptr<HappyEyeballs> connect(
+            const net::any_io_executor &executor, std::vector<tcp::endpoint> endpoints,
+            std::chrono::steady_clock::time_point deadline, Handler handler,
+            std::chrono::milliseconds delay = attemptDelay)
+        {
+            auto race = std::shared_ptr<HappyEyeballs>(new HappyEyeballs(executor, std::move(endpoints), std::move(handler), delay));
+            race->start(deadline);
+            return race;
+        }
+
+        // Asio-style connect() that moves the winner into socket, which must outlive
+        // the operation; completes with (error_code, endpoint connected to)
+        template <typename CompletionToken>
+        static auto asyncConnect(const net::any_io_executor &executor, std::vector<tcp::endpoint> endpoints,
+                                 std::chrono::steady_clock::time_point deadline, Socket &socket, CompletionToken &&token)
+        {
+            return net::async_initiate<CompletionToken, void(beast::error_code, tcp::endpoint)>(
+                [executor, deadline, &socket](auto handler, std::vector<tcp::endpoint> endpoints)
+                {
+                    auto shared = std::make_shared<decltype(handler)>(std::move(handler));
+                    connect(executor, std::move(endpoints), deadline, [shared, &socket](beast::error_code ec, Socket winner)
+                            {
+                        tcp::endpoint endpoint;
+                        if (!ec)
+                        {
+                            endpoint = winner.remote_endpoint(ec);
+                            socket = std::move(winner);
+                        }
+                        (*shared)(ec, endpoint); });
+                },
+                token, std::move(endpoints));
+        }
+
+        // Abandons the race; the handler then sees operation_aborted. Must be called
+        // on the executor.
+        void cancel()
+        {
+            if (done_ || stopped_)
+            {
+                return;
+            }
+            stopped_ = true;
+            staggerTimer_.cancel();
+            deadlineTimer_.cancel();
+            for (auto &attempt : attempts_)
+            {
+                beast::error_code ignored;
+                attempt->close(ignored);
+            }
+        }
+
+    private:
+        HappyEyeballs(const net::any_io_executor &executor, std::vector<tcp::endpoint> endpoints, Handler handler,
+                      std::chrono::milliseconds delay)
+            : executor_(executor), endpoints_(std::move(endpoints)), handler_(std::move(handler)), delay_(delay),
+              staggerTimer_(executor), deadlineTimer_(executor)
+        {
+        }
+
+        void start(std::chrono::steady_clock::time_point deadline)
+        {
+            if (endpoints_.empty())
+            {
+                net::post(executor_, [self = shared_from_this()]()
+                          { self->finish(net::error::host_not_found, Socket(self->executor_)); });
+                return;
+            }
+            deadlineTimer_.expires_at(deadline);
+            deadlineTimer_.async_wait([self = shared_from_this()](beast::error_code ec)
+                                      {
+                if (!ec && !self->done_)
+                {
+                    self->timedOut_ = true;
+                    self->cancel();
+                } });
+            next();
+        }
+
+        void next()
+        {
+            const auto index = attempts_.size();
+            attempts_.push_back(std::make_unique<Socket>(executor_));
+            if (index > 0)
+            {
+                LOG_INFO("Racing connection attempt {} to {}", index + 1, endpoints_[index].address().to_string());
+            }
+            attempts_.back()->async_connect(endpoints_[index], [self = shared_from_this(), index](beast::error_code ec)
+                                            { self->onAttempt(index, ec); });
+
+            if (attempts_.size() < endpoints_.size())
+            {
+                staggerTimer_.expires_after(delay_);
+                staggerTimer_.async_wait([self = shared_from_this()](beast::error_code ec)
+                                         {
+                    if (!ec && !self->done_ && !self->stopped_ && self->attempts_.size() < self->endpoints_.size())
+                        self->next(); });
+            }
+        }
+
+        void onAttempt(std::size_t index, beast::error_code ec)
+        {
+            if (done_)
+            {
+                return;
+            }
+            if (!ec)
+            {
+                stopped_ = true;
+                staggerTimer_.cancel();
+                deadlineTimer_.cancel();
+                for (std::size_t i = 0; i < attempts_.size(); ++i)
+                {
+                    beast::error_code ignored;
+                    if (i != index)
+                        attempts_[i]->close(ignored);
+                }
+                finish({}, std::move(*attempts_[index]));
+                return;
+            }
+
+            lastError_ = ec;
+            ++failed_;
+            if (!stopped_ && attempts_.size() < endpoints_.size())
+            {
+                // No point waiting out the delay behind an address that already refused
+                next();
+                return;
+            }
+            if (failed_ == attempts_.size())
+            {
+                finish(timedOut_ ? beast::error_code(beast::error::timeout) : lastError_, Socket(executor_));
+            }
+        }
+
+        void finish(beast::error_code ec, Socket socket)
+        {
+            done_ = true;
+            staggerTimer_.cancel();
+            deadlineTimer_.cancel();
+            attempts_.clear();
+            handler_(ec, std::move(socket));
+        }
+
+        net::any_io_executor executor_;
+        std::vector<tcp::endpoint> endpoints_;
+        Handler handler_;
+        std::chrono::milliseconds delay_;
+        net::steady_timer staggerTimer_;
+        net::steady_timer deadlineTimer_;
+        std::vector<std::unique_ptr<Socket>> attempts_;
+        std::size_t failed_ = 0;
+        beast::error_code lastError_;
+        bool stopped_ = false;
+        bool timedOut_ = false;
+        bool done_ = false;
+    };
+}
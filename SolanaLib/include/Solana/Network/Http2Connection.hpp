@@ -0,0 +1,452 @@
+#pragma once
+#if SOLANA_HAS_HTTP2
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <nghttp2/nghttp2.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Solana/Logger.hpp"
+#include "Solana/Network/Connector.hpp"
+#include "Solana/Network/MultiplexedConnection.hpp"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace ssl = net::ssl;
+
+namespace Solana::Network
+{
+    // One TLS connection negotiated to h2 via ALPN, carrying every request as its
+    // own HTTP/2 stream. Framing and HPACK are done by nghttp2; this class only
+    // feeds it bytes from the socket and writes out whatever it produces.
+    // Requests beyond the server's SETTINGS_MAX_CONCURRENT_STREAMS wait in a queue.
+    class Http2Connection : public MultiplexedConnection, public std::enable_shared_from_this<Http2Connection>
+    {
+    public:
+        using Stream = beast::ssl_stream<beast::tcp_stream>;
+
+        Http2Connection(
+            net::io_context &ioc,
+            std::shared_ptr<ssl::context> ctx,
+            const std::string &host,
+            const std::string &port)
+            : strand_(net::make_strand(ioc)),
+              ctx_(std::move(ctx)),
+              host_(host),
+              port_(port)
+        {
+        }
+
+        ~Http2Connection() override
+        {
+            if (session_)
+            {
+                nghttp2_session_del(session_);
+            }
+        }
+
+        void submit(http::request<http::string_body> &&req, Completion done) override
+        {
+            ++pending_;
+            net::dispatch(strand_, [self = shared_from_this(), req = std::move(req), done = std::move(done)]() mutable
+                          {
+                self->queued_.push_back(Call{std::move(req), std::move(done)});
+                self->pump(); });
+        }
+
+        void warm(std::function<void(bool)> done) override
+        {
+            net::dispatch(strand_, [self = shared_from_this(), done = std::move(done)]() mutable
+                          {
+                if (self->session_ && !self->connecting_)
+                {
+                    done(true);
+                    return;
+                }
+                self->warming_.push_back(std::move(done));
+                if (!self->connecting_)
+                    self->connect(); });
+        }
+
+        std::size_t pending() const override { return pending_; }
+
+    private:
+        struct Call
+        {
+            http::request<http::string_body> req;
+            Completion done;
+        };
+
+        struct StreamState
+        {
+            Call call;
+            std::size_t sent = 0;
+            http::response<http::string_body> response;
+        };
+
+        void pump()
+        {
+            if (connecting_)
+            {
+                return;
+            }
+
+            if (!session_)
+            {
+                if (!queued_.empty())
+                {
+                    connect();
+                }
+                return;
+            }
+
+            const auto limit = nghttp2_session_get_remote_settings(session_, NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS);
+            while (!queued_.empty() && streams_.size() < limit)
+            {
+                auto state = std::make_unique<StreamState>(StreamState{std::move(queued_.front())});
+                queued_.pop_front();
+                submitStream(std::move(state));
+            }
+            flush();
+        }
+
+        void connect()
+        {
+            connecting_ = true;
+            stream_ = std::make_unique<Stream>(strand_, *ctx_);
+
+            static const unsigned char alpn[] = {2, 'h', '2'};
+            SSL_set_alpn_protos(stream_->native_handle(), alpn, sizeof(alpn));
+
+            Connector::establish(*stream_, host_, port_,
+                                 [self = shared_from_this()](beast::error_code ec, const char *what)
+                                 {
+                                     self->connecting_ = false;
+                                     if (!ec && !self->negotiatedH2())
+                                     {
+                                         ec = boost::system::errc::make_error_code(boost::system::errc::protocol_not_supported);
+                                         what = "alpn";
+                                     }
+                                     for (auto &done : std::exchange(self->warming_, {}))
+                                     {
+                                         done(!ec);
+                                     }
+                                     if (ec)
+                                     {
+                                         self->stream_.reset();
+                                         self->failQueued(ec, what);
+                                         return;
+                                     }
+                                     LOG_INFO("HTTP/2 connection ready for {}:{}", self->host_, self->port_);
+                                     self->startSession();
+                                 });
+        }
+
+        bool negotiatedH2() const
+        {
+            const unsigned char *proto = nullptr;
+            unsigned int length = 0;
+            SSL_get0_alpn_selected(stream_->native_handle(), &proto, &length);
+            return length == 2 && proto[0] == 'h' && proto[1] == '2';
+        }
+
+        void startSession()
+        {
+            nghttp2_session_callbacks *callbacks;
+            nghttp2_session_callbacks_new(&callbacks);
+            nghttp2_session_callbacks_set_on_header_callback(callbacks, &Http2Connection::onHeader);
+            nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, &Http2Connection::onDataChunk);
+            nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, &Http2Connection::onStreamClose);
+            nghttp2_session_client_new(&session_, callbacks, this);
+            nghttp2_session_callbacks_del(callbacks);
+
+            // Large stream windows: JSON-RPC replies (getBlock) are often bigger than the 64KB default
+            const nghttp2_settings_entry settings[] = {
+                {NGHTTP2_SETTINGS_ENABLE_PUSH, 0},
+                {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, 16 * 1024 * 1024},
+            };
+            nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, settings, std::size(settings));
+            nghttp2_session_set_local_window_size(session_, NGHTTP2_FLAG_NONE, 0, 64 * 1024 * 1024);
+
+            read();
+            pump();
+        }
+
+        void submitStream(std::unique_ptr<StreamState> state)
+        {
+            auto &req = state->call.req;
+            const std::string method(req.method_string());
+            const std::string path(req.target());
+            const std::string authority(req[http::field::host]);
+            std::vector<std::pair<std::string, std::string>> fields;
+            for (const auto &field : req)
+            {
+                // Connection-specific headers are forbidden in HTTP/2
+                if (field.name() == http::field::host || field.name() == http::field::connection ||
+                    field.name() == http::field::content_length)
+                {
+                    continue;
+                }
+                std::string name(field.name_string());
+                std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+                fields.emplace_back(std::move(name), std::string(field.value()));
+            }
+
+            std::vector<nghttp2_nv> nva;
+            const auto add = [&nva](const std::string &name, const std::string &value)
+            {
+                nva.push_back({(uint8_t *)name.data(), (uint8_t *)value.data(), name.size(), value.size(), NGHTTP2_NV_FLAG_NONE});
+            };
+            static const std::string methodKey = ":method", schemeKey = ":scheme", authorityKey = ":authority", pathKey = ":path", https = "https";
+            add(methodKey, method);
+            add(schemeKey, https);
+            add(authorityKey, authority);
+            add(pathKey, path);
+            for (const auto &[name, value] : fields)
+            {
+                add(name, value);
+            }
+
+            nghttp2_data_provider provider{};
+            provider.source.ptr = state.get();
+            provider.read_callback = &Http2Connection::readBody;
+
+            const auto id = nghttp2_submit_request(session_, nullptr, nva.data(), nva.size(),
+                                                   req.body().empty() ? nullptr : &provider, nullptr);
+            if (id < 0)
+            {
+                --pending_;
+                state->call.done(boost::system::errc::make_error_code(boost::system::errc::protocol_error), "submit", {});
+                return;
+            }
+            streams_.emplace(id, std::move(state));
+        }
+
+        void flush()
+        {
+            if (writing_ || !session_)
+            {
+                return;
+            }
+
+            out_.clear();
+            for (;;)
+            {
+                const uint8_t *data = nullptr;
+                const auto n = nghttp2_session_mem_send(session_, &data);
+                if (n <= 0)
+                {
+                    break;
+                }
+                out_.append(reinterpret_cast<const char *>(data), n);
+            }
+            if (out_.empty())
+            {
+                closeIfDone();
+                return;
+            }
+
+            writing_ = true;
+            net::async_write(*stream_, net::buffer(out_),
+                             [self = shared_from_this()](beast::error_code ec, std::size_t)
+                             {
+                                 self->writing_ = false;
+                                 if (ec)
+                                 {
+                                     self->reset(ec, "write");
+                                     return;
+                                 }
+                                 self->flush();
+                             });
+        }
+
+        void read()
+        {
+            reading_ = true;
+            beast::get_lowest_layer(*stream_).expires_never();
+            stream_->async_read_some(net::buffer(in_),
+                                     [self = shared_from_this()](beast::error_code ec, std::size_t n)
+                                     {
+                                         self->reading_ = false;
+                                         self->on_read(ec, n);
+                                     });
+        }
+
+        void on_read(beast::error_code ec, std::size_t n)
+        {
+            if (ec)
+            {
+                reset(ec, "read");
+                return;
+            }
+
+            const auto rv = nghttp2_session_mem_recv(session_, reinterpret_cast<const uint8_t *>(in_.data()), n);
+            if (rv < 0)
+            {
+                LOG_ERROR("HTTP/2 protocol error from {}: {}", host_, nghttp2_strerror(static_cast<int>(rv)));
+                reset(boost::system::errc::make_error_code(boost::system::errc::protocol_error), "read");
+                return;
+            }
+
+            pump();
+            if (session_ && nghttp2_session_want_read(session_))
+            {
+                read();
+            }
+        }
+
+        // Session finished (GOAWAY received and all streams closed)
+        void closeIfDone()
+        {
+            if (session_ && !nghttp2_session_want_read(session_) && !nghttp2_session_want_write(session_))
+            {
+                reset(http::error::end_of_stream, "goaway");
+            }
+        }
+
+        // Drops the connection, failing every open stream. Queued requests go out on a fresh connection.
+        void reset(beast::error_code ec, const char *what)
+        {
+            if (writing_ || reading_)
+            {
+                beast::error_code ignored;
+                beast::get_lowest_layer(*stream_).socket().close(ignored);
+                return;
+            }
+
+            LOG_WARN("HTTP/2 connection to {}:{} failed in {}: {}", host_, port_, what, ec.message());
+            if (session_)
+            {
+                nghttp2_session_del(session_);
+                session_ = nullptr;
+            }
+            stream_.reset();
+            auto streams = std::move(streams_);
+            streams_.clear();
+            for (auto &[id, state] : streams)
+            {
+                --pending_;
+                state->call.done(ec, what, {});
+            }
+            pump();
+        }
+
+        void failQueued(beast::error_code ec, const char *what)
+        {
+            auto queued = std::move(queued_);
+            queued_.clear();
+            for (auto &call : queued)
+            {
+                --pending_;
+                call.done(ec, what, {});
+            }
+        }
+
+        StreamState *find(int32_t id)
+        {
+            auto it = streams_.find(id);
+            return it == streams_.end() ? nullptr : it->second.get();
+        }
+
+        static ssize_t readBody(nghttp2_session *, int32_t, uint8_t *buf, size_t length, uint32_t *flags, nghttp2_data_source *source, void *)
+        {
+            auto *state = static_cast<StreamState *>(source->ptr);
+            const auto &body = state->call.req.body();
+            const auto n = std::min(length, body.size() - state->sent);
+            std::memcpy(buf, body.data() + state->sent, n);
+            state->sent += n;
+            if (state->sent == body.size())
+            {
+                *flags |= NGHTTP2_DATA_FLAG_EOF;
+            }
+            return static_cast<ssize_t>(n);
+        }
+
+        static int onHeader(nghttp2_session *, const nghttp2_frame *frame, const uint8_t *name, size_t namelen,
+                            const uint8_t *value, size_t valuelen, uint8_t, void *user)
+        {
+            auto *self = static_cast<Http2Connection *>(user);
+            if (frame->hd.type != NGHTTP2_HEADERS)
+            {
+                return 0;
+            }
+            auto *state = self->find(frame->hd.stream_id);
+            if (!state)
+            {
+                return 0;
+            }
+            const std::string_view key(reinterpret_cast<const char *>(name), namelen);
+            const std::string_view val(reinterpret_cast<const char *>(value), valuelen);
+            if (key == ":status")
+            {
+                state->response.result(std::stoi(std::string(val)));
+            }
+            else if (!key.starts_with(":"))
+            {
+                state->response.set(key, val);
+            }
+            return 0;
+        }
+
+        static int onDataChunk(nghttp2_session *, uint8_t, int32_t id, const uint8_t *data, size_t len, void *user)
+        {
+            auto *self = static_cast<Http2Connection *>(user);
+            if (auto *state = self->find(id))
+            {
+                state->response.body().append(reinterpret_cast<const char *>(data), len);
+            }
+            return 0;
+        }
+
+        static int onStreamClose(nghttp2_session *, int32_t id, uint32_t error, void *user)
+        {
+            auto *self = static_cast<Http2Connection *>(user);
+            auto it = self->streams_.find(id);
+            if (it == self->streams_.end())
+            {
+                return 0;
+            }
+            auto state = std::move(it->second);
+            self->streams_.erase(it);
+            --self->pending_;
+            if (error != NGHTTP2_NO_ERROR)
+            {
+                LOG_WARN("HTTP/2 stream {} reset by {}: {}", id, self->host_, nghttp2_http2_strerror(error));
+                state->call.done(boost::system::errc::make_error_code(boost::system::errc::connection_reset), "stream", {});
+                return 0;
+            }
+            state->response.version(20);
+            state->call.done({}, nullptr, std::move(state->response));
+            return 0;
+        }
+
+        net::strand<net::io_context::executor_type> strand_;
+        std::shared_ptr<ssl::context> ctx_;
+        std::string host_;
+        std::string port_;
+        std::unique_ptr<Stream> stream_;
+        nghttp2_session *session_ = nullptr;
+        std::array<char, 64 * 1024> in_;
+        std::string out_;
+        std::deque<Call> queued_;
+        std::unordered_map<int32_t, std::unique_ptr<StreamState>> streams_;
+        std::atomic<std::size_t> pending_ = 0;
+        bool connecting_ = false;
+        // warm() callers waiting for the connection attempt in progress
+        std::vector<std::function<void(bool)>> warming_;
+        bool writing_ = false;
+        bool reading_ = false;
+    };
+}
+#endif
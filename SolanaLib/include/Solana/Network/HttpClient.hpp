@@ -9,9 +9,16 @@
 #include <iostream>
 #include <memory>
 #include <future>
+#include <atomic>
 #include <boost/url.hpp>
 #include "Solana/Logger.hpp"
 #include "Solana/Network/ConnectionPool.hpp"
+#include "Solana/Network/Connector.hpp"
+#include "Solana/Network/PipelinedConnection.hpp"
+#include "Solana/Network/Http2Connection.hpp"
+#include "Solana/Network/HttpStatusError.hpp"
+#include "Solana/Network/RequestOptions.hpp"
+#include "Solana/Network/TlsSessionCache.hpp"
 
 using namespace boost::urls;
 using json = nlohmann::json;
@@ -28,7 +35,7 @@ namespace Solana::Network
         Url(const std::string &endpoint)
         {
             auto url = parse_uri(endpoint);
-            service = (url->scheme() == "https" ? "443" : "80");
+            service = url->has_port() ? std::string(url->port()) : (url->scheme() == "https" ? "443" : "80");
             this->endpoint = url->host();
             targetBase = url->path() + (url->has_query() ? ("?" + url->query()) : "");
             if (targetBase.empty())
@@ -42,35 +49,134 @@ namespace Solana::Network
         std::string targetBase;
     };
 
+    struct HttpClientConfig
+    {
+        // Number of threads running the io_context. Each connection is bound to
+        // its own strand, so a request chain stays serialized while separate
+        // connections (TLS, reads and T::parse) spread across the threads.
+        std::size_t threads = 1;
+        ConnectionPoolConfig pool;
+        // When non-zero, POSTs are pipelined over at most this many keep-alive
+        // connections instead of taking one pooled connection per request
+        std::size_t pipelineConnections = 0;
+        // Unanswered requests allowed on one pipelined connection before further
+        // requests wait in its queue
+        std::size_t pipelineDepth = 16;
+        // When non-zero, POSTs go out as HTTP/2 streams multiplexed over this many
+        // connections negotiated via ALPN. Takes precedence over pipelining and
+        // requires a build with SOLANA_HAS_HTTP2.
+        std::size_t http2Connections = 0;
+    };
+
+    // Reply types with a T::parse(std::shared_ptr<const std::string>) overload take
+    // ownership of the response body (moved, never copied) and may keep views into
+    // it; everything else parses it in place as before
+    template <typename T>
+    T parseResponseBody(std::string &body)
+    {
+        if constexpr (requires(std::shared_ptr<const std::string> owned) { T::parse(owned); })
+        {
+            return T::parse(std::make_shared<const std::string>(std::move(body)));
+        }
+        else
+        {
+            return T::parse(body);
+        }
+    }
+
+    // Non-2xx replies throw HttpStatusError instead of reaching T::parse
+    template <typename T>
+    T parseResponse(http::response<http::string_body> &response)
+    {
+        if (response.result_int() / 100 != 2)
+        {
+            const auto retryAfter = response[http::field::retry_after];
+            throw HttpStatusError(response.result_int(), parseRetryAfter(std::string_view(retryAfter.data(), retryAfter.size())), response.body());
+        }
+        return parseResponseBody<T>(response.body());
+    }
+
+    // Callback core every request path completes through
+    template <typename T>
+    using Completion = std::function<void(std::exception_ptr, T)>;
+
+    // Completion handlers are move-only and must run on their associated executor
+    // (for use_awaitable, the coroutine's), so hold them behind a shared_ptr for
+    // std::function and hop executors when the reply arrives.
+    template <typename T, typename Handler, typename Executor>
+    Completion<T> bindCompletion(Handler &&handler, const Executor &fallback)
+    {
+        auto work = net::make_work_guard(handler, fallback);
+        auto shared = std::make_shared<std::decay_t<Handler>>(std::forward<Handler>(handler));
+        return [shared, work = std::move(work)](std::exception_ptr ex, T result) mutable
+        {
+            auto executor = net::get_associated_executor(*shared, work.get_executor());
+            net::dispatch(executor, [shared, ex, result = std::move(result)]() mutable
+                          { (*shared)(ex, std::move(result)); });
+            work.reset();
+        };
+    }
+
     template <typename T>
     class HttpRequestHandler;
 
     class HttpClient
     {
     public:
-        HttpClient(const Url &url)
-            : ioc(std::make_shared<net::io_context>()),
+        HttpClient(const Url &url, const HttpClientConfig &config = {})
+            : ioc(std::make_shared<net::io_context>(static_cast<int>(std::max<std::size_t>(config.threads, 1)))),
               work_guard(net::make_work_guard(*ioc)),
               ctx(std::make_shared<ssl::context>(ssl::context::tlsv12_client)),
               url(url),
-              connection_pool_(ioc)
+              connection_pool_(ioc, config.pool)
         {
+            if (config.http2Connections > 0)
+            {
+#if SOLANA_HAS_HTTP2
+                for (std::size_t i = 0; i < config.http2Connections; ++i)
+                {
+                    multiplexed_.push_back(std::make_shared<Http2Connection>(*ioc, ctx, url.endpoint, url.service));
+                }
+#else
+                throw std::invalid_argument("HTTP/2 transport requested but SolanaLib was built without nghttp2");
+#endif
+            }
+            else
+            {
+                for (std::size_t i = 0; i < config.pipelineConnections; ++i)
+                {
+                    multiplexed_.push_back(std::make_shared<PipelinedConnection>(*ioc, ctx, url.endpoint, url.service, config.pipelineDepth));
+                }
+            }
+
             ctx->set_default_verify_paths();
             ctx->set_options(
                 ssl::context::default_workarounds |
                 ssl::context::no_sslv2 |
                 ssl::context::no_sslv3);
+            // Every connection from this client goes to the same host, so after the
+            // first one the rest can resume its TLS session
+            TlsSessionCache::enable(*ctx);
             LOG_INFO("SSL context configured with default verify paths and options");
 
-            runner_thread = std::thread([this]()
-                                        {
-                LOG_INFO("IO context thread started");
-                try {
-                    ioc->run();
-                } catch (const std::exception& e) {
-                    LOG_ERROR("IO Context error: {}", e.what());
-                }
-                LOG_INFO("IO context thread exited"); });
+            const auto threads = std::max<std::size_t>(config.threads, 1);
+            runner_threads.reserve(threads);
+            for (std::size_t i = 0; i < threads; ++i)
+            {
+                runner_threads.emplace_back([this, i]()
+                                            {
+                    LOG_INFO("IO context thread {} started", i);
+                    try {
+                        ioc->run();
+                    } catch (const std::exception& e) {
+                        LOG_ERROR("IO Context error: {}", e.what());
+                    }
+                    LOG_INFO("IO context thread {} exited", i); });
+            }
+            LOG_INFO("HttpClient running on {} IO thread(s)", threads);
+
+            // Resolve the host while nothing waits on it, so the first request goes straight to connect
+            DnsCache::shared()->prefetch(ioc->get_executor(), url.endpoint, url.service);
         }
 
         ~HttpClient()
@@ -80,28 +186,172 @@ namespace Solana::Network
             {
                 ioc->stop();
             }
-            if (runner_thread.joinable())
+            for (auto &runner_thread : runner_threads)
+            {
+                if (runner_thread.joinable())
+                {
+                    runner_thread.join();
+                }
+            }
+            LOG_INFO("IO context threads joined and stopped");
+        }
+
+        std::size_t threadCount() const { return runner_threads.size(); }
+
+        ConnectionPoolStats poolStats() const { return connection_pool_.stats(); }
+
+        TlsSessionStats tlsStats() const { return TlsSessionCache::stats(*ctx); }
+
+        // Opens and handshakes connections ahead of the first requests, so they skip
+        // connect and TLS. Pooled connections are parked idle in the pool (at most
+        // its maxIdlePerHost); with pipelining or HTTP/2 every multiplexed connection
+        // is opened and `connections` is ignored. Resolves to how many are ready.
+        std::future<std::size_t> warmup(std::size_t connections, const RequestOptions &options = {})
+        {
+            struct Progress
+            {
+                std::mutex mutex;
+                std::size_t remaining;
+                std::size_t ready = 0;
+                std::promise<std::size_t> promise;
+            };
+            auto progress = std::make_shared<Progress>();
+            auto future = progress->promise.get_future();
+            const auto finished = [progress](bool ok)
+            {
+                std::unique_lock<std::mutex> lock(progress->mutex);
+                progress->ready += ok;
+                if (--progress->remaining == 0)
+                {
+                    LOG_INFO("Warmed up {} connection(s)", progress->ready);
+                    progress->promise.set_value(progress->ready);
+                }
+            };
+
+            if (!multiplexed_.empty())
+            {
+                progress->remaining = multiplexed_.size();
+                for (const auto &connection : multiplexed_)
+                {
+                    connection->warm(finished);
+                }
+                return future;
+            }
+
+            const auto &pool = connection_pool_.config();
+            progress->remaining = std::min({connections, pool.maxIdlePerHost, pool.maxTotalPerHost});
+            if (progress->remaining == 0)
+            {
+                progress->promise.set_value(0);
+                return future;
+            }
+            // Take them all before connecting any, so the pool hands out distinct
+            // streams. At its connection limit the pool queues the rest, bounded by
+            // the same deadline as the connects.
+            struct Taken
+            {
+                std::mutex mutex;
+                std::size_t pending;
+                std::vector<std::unique_ptr<ConnectionPool::Stream>> streams;
+            };
+            auto taken = std::make_shared<Taken>();
+            taken->pending = progress->remaining;
+            const auto deadline = options.expiry();
+            const auto connect = [this, finished, deadline](std::unique_ptr<ConnectionPool::Stream> connection)
+            {
+                auto stream = std::make_shared<std::unique_ptr<ConnectionPool::Stream>>(std::move(connection));
+                const auto release = [this, stream, finished](beast::error_code ec, const char *what)
+                {
+                    if (ec)
+                    {
+                        LOG_WARN("Warm-up connection to {}:{} failed in {}: {}", url.endpoint, url.service, what, ec.message());
+                    }
+                    connection_pool_.releaseConnection(url.endpoint, url.service, ctx, std::move(*stream), !ec);
+                    finished(!ec);
+                };
+                if (beast::get_lowest_layer(**stream).socket().is_open())
+                {
+                    release({}, nullptr);
+                    return;
+                }
+                net::dispatch((*stream)->get_executor(), [this, stream, release, deadline]()
+                              { Connector::establish(**stream, url.endpoint, url.service, release, deadline); });
+            };
+            const auto total = progress->remaining;
+            for (std::size_t i = 0; i < total; ++i)
             {
-                runner_thread.join();
-                LOG_INFO("IO context thread joined and stopped");
+                connection_pool_.asyncGetConnection(url.endpoint, url.service, ctx, RequestOptions{.deadline = deadline, .cancellation = options.cancellation},
+                                                    [this, taken, finished, connect](beast::error_code ec, std::unique_ptr<ConnectionPool::Stream> stream)
+                                                    {
+                                                        if (ec)
+                                                        {
+                                                            LOG_WARN("Warm-up connection to {}:{} not started: {}", url.endpoint, url.service, ec.message());
+                                                            finished(false);
+                                                        }
+                                                        std::vector<std::unique_ptr<ConnectionPool::Stream>> streams;
+                                                        {
+                                                            std::unique_lock<std::mutex> lock(taken->mutex);
+                                                            if (stream)
+                                                            {
+                                                                taken->streams.push_back(std::move(stream));
+                                                            }
+                                                            if (--taken->pending > 0)
+                                                            {
+                                                                return;
+                                                            }
+                                                            streams.swap(taken->streams);
+                                                        }
+                                                        for (auto &connection : streams)
+                                                        {
+                                                            connect(std::move(connection));
+                                                        }
+                                                    });
             }
+            return future;
         }
 
+        // The io_context the IO threads run; lets callers schedule timers alongside requests
+        std::shared_ptr<net::io_context> context() const { return ioc; }
+
+        // Failures are thrown as boost::system::system_error; running out of the
+        // deadline or being cancelled carries a Network::Error code
         template <typename T>
-        std::future<T> post(const json &body)
+        std::future<T> post(const json &body, const RequestOptions &options = {})
         {
-            http::request<http::string_body> req;
-            req.method(http::verb::post);
-            req.target(url.targetBase);
-            req.set(http::field::host, url.endpoint);
-            req.set(http::field::user_agent, "Solana/1.0");
-            req.set(http::field::content_type, "application/json");
-            req.set(http::field::accept, "application/json");
-            req.body() = body.dump();
-            req.prepare_payload();
-            LOG_INFO("HTTP POST Request to {}{} with body: {}", url.endpoint, url.targetBase, body.dump());
+            return toFuture<T>([this, &body, &options](Completion<T> done)
+                               { send<T>(makePost(body), std::move(done), options); });
+        }
+
+        // Completion-token flavour of post(): the handler signature is
+        // void(std::exception_ptr, T), so net::use_awaitable yields an awaitable<T>
+        // that rethrows on failure, and plain callbacks avoid the promise/future pair.
+        template <typename T, typename CompletionToken>
+        auto asyncPost(const json &body, CompletionToken &&token)
+        {
+            return asyncPost<T>(body, RequestOptions{}, std::forward<CompletionToken>(token));
+        }
 
-            return sendRequest<T>(std::move(req));
+        // A cancellation slot bound to the token (e.g. via net::bind_cancellation_slot,
+        // or an awaitable_operators race) cancels the request like options.cancellation
+        template <typename T, typename CompletionToken>
+        auto asyncPost(const json &body, const RequestOptions &options, CompletionToken &&token)
+        {
+            return net::async_initiate<CompletionToken, void(std::exception_ptr, T)>(
+                [this](auto handler, http::request<http::string_body> req, RequestOptions options)
+                {
+                    auto slot = net::get_associated_cancellation_slot(handler);
+                    if (slot.is_connected())
+                    {
+                        if (!options.cancellation)
+                        {
+                            options.cancellation = std::make_shared<CancellationToken>();
+                        }
+                        slot.assign([cancellation = options.cancellation](net::cancellation_type)
+                                    { cancellation->cancel(); });
+                    }
+                    send<T>(std::move(req), bindCompletion<T>(std::move(handler), ioc->get_executor()), options);
+                },
+                token, makePost(body), options);
         }
 
         template <typename T>
@@ -116,30 +366,155 @@ namespace Solana::Network
 
             LOG_INFO("HTTP GET Request to {}{}", url.endpoint, req.target());
 
-            return sendRequest<T>(std::move(req));
+            return toFuture<T>([this, &req](Completion<T> done)
+                               { sendRequest<T>(std::move(req), std::move(done)); });
         }
 
     private:
+        http::request<http::string_body> makePost(const json &body) const
+        {
+            http::request<http::string_body> req;
+            req.method(http::verb::post);
+            req.target(url.targetBase);
+            req.set(http::field::host, url.endpoint);
+            req.set(http::field::user_agent, "Solana/1.0");
+            req.set(http::field::content_type, "application/json");
+            req.set(http::field::accept, "application/json");
+            req.body() = body.dump();
+            req.prepare_payload();
+            LOG_INFO("HTTP POST Request to {}{} with body: {}", url.endpoint, url.targetBase, req.body());
+            return req;
+        }
+
+        template <typename T, typename Start>
+        static std::future<T> toFuture(Start &&start)
+        {
+            auto promise = std::make_shared<std::promise<T>>();
+            auto future = promise->get_future();
+            start([promise](std::exception_ptr ex, T result)
+                  {
+                if (ex)
+                    promise->set_exception(ex);
+                else
+                    promise->set_value(std::move(result)); });
+            return future;
+        }
+
+        template <typename T>
+        void send(http::request<http::string_body> &&req, Completion<T> done, const RequestOptions &options)
+        {
+            if (!multiplexed_.empty())
+            {
+                sendMultiplexed<T>(std::move(req), std::move(done), options);
+                return;
+            }
+            sendRequest<T>(std::move(req), std::move(done), options);
+        }
+
         template <typename T>
-        std::future<T> sendRequest(http::request<http::string_body> &&req)
+        void sendRequest(http::request<http::string_body> &&req, Completion<T> done, const RequestOptions &options = {})
         {
-            // Get a connection from the pool (or create a new one)
-            auto connection = connection_pool_.getConnection(url.endpoint, url.service, ctx);
-            LOG_INFO("Sending request using connection: {}", (void *)connection.get());
-            auto handler = std::make_shared<HttpRequestHandler<T>>(ioc, std::move(connection), std::move(req),
-                                                                   [this](std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream)
-                                                                   {
-                                                                       connection_pool_.releaseConnection(std::move(stream));
-                                                                   });
-            return handler->start();
+            // The pool may queue the request for a connection, and that wait comes out
+            // of its budget
+            auto anchored = options.anchored();
+            connection_pool_.asyncGetConnection(url.endpoint, url.service, ctx, anchored,
+                                                [this, req = std::move(req), done = std::move(done), anchored](beast::error_code ec, std::unique_ptr<ConnectionPool::Stream> connection) mutable
+                                                {
+                                                    if (ec)
+                                                    {
+                                                        LOG_ERROR("Error in connection pool: {}", ec.message());
+                                                        done(std::make_exception_ptr(boost::system::system_error(ec, "connection pool")), T{});
+                                                        return;
+                                                    }
+                                                    LOG_INFO("Sending request using connection: {}", (void *)connection.get());
+                                                    auto handler = std::make_shared<HttpRequestHandler<T>>(ioc, std::move(connection), std::move(req), url.service,
+                                                                                                           std::move(done), anchored,
+                                                                                                           [this](std::unique_ptr<ConnectionPool::Stream> stream, bool reusable)
+                                                                                                           {
+                                                                                                               connection_pool_.releaseConnection(url.endpoint, url.service, ctx, std::move(stream), reusable);
+                                                                                                           });
+                                                    handler->start();
+                                                });
+        }
+
+        // A shared connection cannot abort one stream without disturbing the others,
+        // so a deadline or cancellation here completes the caller early and the late
+        // response, if any, is dropped when it arrives
+        template <typename T>
+        Completion<T> guardMultiplexed(Completion<T> done, const RequestOptions &options)
+        {
+            auto settled = std::make_shared<std::atomic<bool>>(false);
+            auto timer = std::make_shared<net::steady_timer>(*ioc, options.expiry());
+            auto registration = std::make_shared<CancellationToken::Registration>();
+            // byToken: the token has already dropped the callback, and may be running it
+            // before *registration is even set
+            auto settle = [done = std::move(done), settled, timer, registration](std::exception_ptr ex, T result, bool byToken)
+            {
+                if (settled->exchange(true))
+                {
+                    return;
+                }
+                timer->cancel();
+                if (!byToken)
+                {
+                    registration->reset();
+                }
+                done(ex, std::move(result));
+            };
+            if (options.cancellation)
+            {
+                *registration = options.cancellation->onCancel([settle]()
+                                                               { settle(std::make_exception_ptr(boost::system::system_error(Error::Cancelled, "multiplexed")), T{}, true); });
+            }
+            timer->async_wait([settle](beast::error_code ec)
+                              {
+                if (!ec)
+                    settle(std::make_exception_ptr(boost::system::system_error(Error::ReadTimeout, "multiplexed")), T{}, false); });
+            return [settle](std::exception_ptr ex, T result)
+            { settle(ex, std::move(result), false); };
+        }
+
+        template <typename T>
+        void sendMultiplexed(http::request<http::string_body> &&req, Completion<T> done, const RequestOptions &options)
+        {
+            if (options.bounded())
+            {
+                done = guardMultiplexed<T>(std::move(done), options);
+            }
+            auto connection = *std::min_element(multiplexed_.begin(), multiplexed_.end(),
+                                                [](const auto &a, const auto &b)
+                                                { return a->pending() < b->pending(); });
+            connection->submit(std::move(req),
+                               [done = std::move(done)](beast::error_code ec, const char *what, http::response<http::string_body> &&response)
+                               {
+                                   if (ec)
+                                   {
+                                       LOG_ERROR("Error in {}: {}", what, ec.message());
+                                       done(std::make_exception_ptr(boost::system::system_error(ec, what)), T{});
+                                       return;
+                                   }
+                                   std::exception_ptr ex;
+                                   T result{};
+                                   try
+                                   {
+                                       result = parseResponse<T>(response);
+                                   }
+                                   catch (const std::exception &e)
+                                   {
+                                       LOG_ERROR("Exception parsing HTTP response: {}", e.what());
+                                       ex = std::current_exception();
+                                   }
+                                   done(ex, std::move(result));
+                               });
         }
 
         std::shared_ptr<net::io_context> ioc;
         net::executor_work_guard<net::io_context::executor_type> work_guard;
         std::shared_ptr<ssl::context> ctx;
         Url url;
-        std::thread runner_thread;
+        std::vector<std::thread> runner_threads;
         ConnectionPool connection_pool_;
+        std::vector<std::shared_ptr<MultiplexedConnection>> multiplexed_;
     };
 
     template <typename T>
@@ -150,32 +525,55 @@ namespace Solana::Network
             std::shared_ptr<net::io_context> ioc,
             std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream,
             http::request<http::string_body> &&req,
-            std::function<void(std::unique_ptr<beast::ssl_stream<beast::tcp_stream>>)> release_callback)
+            const std::string &port,
+            std::function<void(std::exception_ptr, T)> done,
+            const RequestOptions &options,
+            std::function<void(std::unique_ptr<beast::ssl_stream<beast::tcp_stream>>, bool)> release_callback)
             : ioc_(ioc),
               stream_(std::move(stream)),
               req_(std::move(req)),
-              promise_(std::make_shared<std::promise<T>>()),
+              done_(std::move(done)),
+              deadline_(options.expiry()),
+              cancellation_(options.cancellation),
+              executor_(stream_->get_executor()),
               release_callback_(std::move(release_callback))
         {
             // Extract host and port from the request for logging
             host_ = req_.base()[http::field::host];
-            // Port might need to be determined based on whether you're using HTTPS or not
-            port_ = "443"; // Assuming HTTPS; would be "80" for HTTP
+            port_ = port;
             LOG_INFO("HttpRequestHandler constructed for host: {}, port: {}", host_, port_);
         }
 
-        std::future<T> start()
+        void start()
         {
             LOG_INFO("Initiating HTTP request to {}:{}", host_, port_);
-            auto future = promise_->get_future();
 
-            // Set the SNI Hostname (many hosts need this to handshake successfully)
-            if (!SSL_set_tlsext_host_name(stream_->native_handle(), host_.c_str()))
+            // Enter the stream's strand before touching it
+            net::dispatch(stream_->get_executor(), [self = this->shared_from_this()]()
+                          { self->run(); });
+        }
+
+    private:
+        void run()
+        {
+            if (cancellation_)
             {
-                LOG_ERROR("Failed to set SNI hostname: {}", host_);
-                boost::system::error_code ec{static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()};
-                promise_->set_exception(std::make_exception_ptr(boost::system::system_error{ec}));
-                return future;
+                cancelRegistration_ = cancellation_->onCancel([weak = this->weak_from_this()]()
+                                                              {
+                    if (auto self = weak.lock())
+                    {
+                        net::dispatch(self->executor_, [self]()
+                                      { self->cancel(); });
+                    } });
+                if (cancelled_)
+                {
+                    // Cancelled before anything touched the stream, so it can go straight back
+                    finished_ = true;
+                    cancelRegistration_.reset();
+                    release_callback_(std::move(stream_), true);
+                    done_(std::make_exception_ptr(boost::system::system_error(Error::Cancelled, "cancel")), T{});
+                    return;
+                }
             }
 
             // Check if the stream is already connected
@@ -184,79 +582,48 @@ namespace Solana::Network
                 LOG_INFO("Using existing connection to {}:{}", host_, port_);
                 // Skip directly to writing the request
                 send_request();
-            }
-            else
-            {
-                LOG_INFO("Opening new connection to {}:{}", host_, port_);
-                // Need to resolve first, then connect
-                resolver_.emplace(*ioc_);
-                resolver_->async_resolve(
-                    host_,
-                    port_,
-                    [self = this->shared_from_this()](beast::error_code ec, tcp::resolver::results_type results)
-                    {
-                        self->on_resolve(ec, results);
-                    });
-            }
-
-            return future;
-        }
-
-    private:
-        void on_resolve(beast::error_code ec, tcp::resolver::results_type results)
-        {
-            LOG_INFO("DNS resolution complete for {}:{}", host_, port_);
-
-            if (ec)
-            {
-                fail(ec, "resolve");
                 return;
             }
 
-            beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
-
-            beast::get_lowest_layer(*stream_).async_connect(
-                results,
-                [self = this->shared_from_this()](beast::error_code ec, tcp::resolver::endpoint_type)
+            connector_ = Connector::establish(
+                *stream_, host_, port_,
+                [self = this->shared_from_this()](beast::error_code ec, const char *what)
                 {
-                    self->on_connect(ec);
-                });
+                    self->connector_.reset();
+                    if (ec)
+                    {
+                        self->fail(ec, what);
+                        return;
+                    }
+                    self->send_request();
+                },
+                deadline_);
         }
 
-        void on_connect(beast::error_code ec)
+        // Runs on the stream's strand. Aborting the in-flight stage makes its
+        // completion fail with operation_aborted, which fail() reports as Cancelled.
+        void cancel()
         {
-            LOG_INFO("TCP connection established with {}:{}", host_, port_);
-            if (ec)
+            if (cancelled_ || !stream_ || finished_)
             {
-                fail(ec, "connect");
                 return;
             }
-
-            beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
-
-            stream_->async_handshake(
-                ssl::stream_base::client,
-                [self = this->shared_from_this()](beast::error_code ec)
-                {
-                    self->on_handshake(ec);
-                });
-        }
-
-        void on_handshake(beast::error_code ec)
-        {
-            LOG_INFO("TLS handshake completed for {}:{}", host_, port_);
-            if (ec)
+            cancelled_ = true;
+            LOG_INFO("Cancelling request to {}:{}", host_, port_);
+            if (connector_)
             {
-                fail(ec, "handshake");
-                return;
+                connector_->cancel();
+            }
+            else
+            {
+                beast::get_lowest_layer(*stream_).cancel();
             }
-
-            send_request();
         }
 
         void send_request()
         {
-            beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
+            // One deadline covers connection setup, the write and the read
+            beast::get_lowest_layer(*stream_).expires_at(deadline_);
 
             http::async_write(*stream_, req_,
                               [self = this->shared_from_this()](beast::error_code ec, std::size_t bytes_transferred)
@@ -293,18 +660,21 @@ namespace Solana::Network
                 fail(ec, "read");
                 return;
             }
+            finished_ = true;
+            cancelRegistration_.reset();
 
+            std::exception_ptr ex;
+            T result{};
             try
             {
                 // LOG_INFO("HTTP response body:\n{}", json::parse(response_->body()).dump(2));
-                auto result = T::parse(response_->body());
-                promise_->set_value(std::move(result));
+                result = parseResponse<T>(*response_);
                 LOG_INFO("Parsed HTTP response successfully");
             }
             catch (const std::exception &e)
             {
                 LOG_ERROR("Exception parsing HTTP response: {}", e.what());
-                promise_->set_exception(std::current_exception());
+                ex = std::current_exception();
             }
 
             // Check if the server wants to keep the connection alive
@@ -313,7 +683,7 @@ namespace Solana::Network
             {
                 LOG_INFO("Server indicates Keep-Alive for {}:{}, returning connection to pool", host_, port_);
                 // Return the connection to the pool
-                release_callback_(std::move(stream_));
+                release_callback_(std::move(stream_), true);
             }
             else
             {
@@ -326,6 +696,9 @@ namespace Solana::Network
                         self->on_shutdown(ec);
                     });
             }
+
+            // The stream is already back in the pool (or closing) when the caller resumes
+            done_(ex, std::move(result));
         }
 
         void on_shutdown(beast::error_code ec)
@@ -345,36 +718,49 @@ namespace Solana::Network
             }
 
             LOG_INFO("Connection Closed to {}:{}", host_, port_);
-            // Even after graceful shutdown, return the stream to the pool
-            // The pool can decide whether to reuse it or not
-            release_callback_(std::move(stream_));
+            // The pool still has to account for the stream, but must never hand it out again
+            release_callback_(std::move(stream_), false);
         }
 
         void fail(beast::error_code ec, const char *what)
         {
-            std::string error_msg = what;
-            error_msg += ": ";
-            error_msg += ec.message();
+            finished_ = true;
+            cancelRegistration_.reset();
+            if (cancelled_)
+            {
+                ec = Error::Cancelled;
+            }
+            else if (ec == beast::error::timeout)
+            {
+                ec = timeoutAt(what);
+            }
             LOG_ERROR("Error in {}: {}", what, ec.message());
-            promise_->set_exception(std::make_exception_ptr(std::runtime_error(std::move(error_msg))));
-
-            // Return the stream to the pool even on failure
-            // The pool can decide whether to reuse it or not
+            // Return the stream to the pool even on failure so its slot is freed;
+            // a stream in an unknown state is closed rather than reused
             if (stream_)
             {
-                release_callback_(std::move(stream_));
+                release_callback_(std::move(stream_), false);
             }
+
+            done_(std::make_exception_ptr(boost::system::system_error(ec, what)), T{});
         }
 
         std::shared_ptr<net::io_context> ioc_;
         std::unique_ptr<beast::ssl_stream<beast::tcp_stream>> stream_;
-        std::optional<tcp::resolver> resolver_; // Only create when needed
         beast::flat_buffer buffer_;
         std::string host_;
         std::string port_;
         http::request<http::string_body> req_;
-        std::shared_ptr<std::promise<T>> promise_;
+        std::function<void(std::exception_ptr, T)> done_;
+        std::chrono::steady_clock::time_point deadline_;
+        std::shared_ptr<CancellationToken> cancellation_;
+        // Dropped once the request is finished, so a long-lived token does not keep it
+        CancellationToken::Registration cancelRegistration_;
+        beast::tcp_stream::executor_type executor_;
+        std::shared_ptr<Connector> connector_;
+        bool cancelled_ = false;
+        bool finished_ = false;
         std::unique_ptr<http::response<http::string_body>> response_;
-        std::function<void(std::unique_ptr<beast::ssl_stream<beast::tcp_stream>>)> release_callback_;
+        std::function<void(std::unique_ptr<beast::ssl_stream<beast::tcp_stream>>, bool)> release_callback_;
     };
 } // namespace Solana::Network
@@ -0,0 +1,47 @@
+#pragma once
+#include <charconv>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Solana::Network
+{
+    // A reply that arrived but with a non-2xx status, e.g. 429 from a provider
+    // enforcing its quota or 503 from an overloaded node
+    class HttpStatusError : public std::runtime_error
+    {
+    public:
+        HttpStatusError(unsigned status, std::optional<std::chrono::seconds> retryAfter, std::string_view body)
+            : std::runtime_error("HTTP " + std::to_string(status) + ": " + std::string(body.substr(0, 256))),
+              status_(status),
+              retryAfter_(retryAfter)
+        {
+        }
+
+        unsigned status() const { return status_; }
+
+        bool rateLimited() const { return status_ == 429; }
+
+        // How long the server asked us to wait, when it sent Retry-After
+        std::optional<std::chrono::seconds> retryAfter() const { return retryAfter_; }
+
+    private:
+        unsigned status_;
+        std::optional<std::chrono::seconds> retryAfter_;
+    };
+
+    // Retry-After as delay-seconds. The HTTP-date form is rare from RPC providers
+    // and is treated as absent.
+    inline std::optional<std::chrono::seconds> parseRetryAfter(std::string_view value)
+    {
+        long seconds = 0;
+        const auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), seconds);
+        if (value.empty() || ec != std::errc() || end != value.data() + value.size() || seconds < 0)
+        {
+            return std::nullopt;
+        }
+        return std::chrono::seconds(seconds);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace Solana::Network
+{
+    // The most recent `capacity` latency samples, oldest overwritten first, for
+    // percentiles over recent behaviour. Not thread-safe.
+    class LatencyWindow
+    {
+    public:
+        explicit LatencyWindow(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+        void record(std::chrono::microseconds latency)
+        {
+            if (samples_.size() < capacity_)
+            {
+                samples_.push_back(latency);
+            }
+            else
+            {
+                samples_[next_] = latency;
+                next_ = (next_ + 1) % capacity_;
+            }
+        }
+
+        bool empty() const { return samples_.empty(); }
+
+        std::chrono::microseconds quantile(double q) const
+        {
+            return quantile(samples_, q);
+        }
+
+        // Quantile over several windows' samples together
+        static std::chrono::microseconds quantile(const std::vector<const LatencyWindow *> &windows, double q)
+        {
+            std::vector<std::chrono::microseconds> samples;
+            for (const auto *window : windows)
+            {
+                samples.insert(samples.end(), window->samples_.begin(), window->samples_.end());
+            }
+            return quantile(std::move(samples), q);
+        }
+
+    private:
+        static std::chrono::microseconds quantile(std::vector<std::chrono::microseconds> sorted, double q)
+        {
+            if (sorted.empty())
+            {
+                return std::chrono::microseconds{0};
+            }
+            const auto rank = std::min(sorted.size() - 1, static_cast<std::size_t>(q * sorted.size()));
+            std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+            return sorted[rank];
+        }
+
+        std::size_t capacity_;
+        std::size_t next_ = 0;
+        std::vector<std::chrono::microseconds> samples_;
+    };
+}
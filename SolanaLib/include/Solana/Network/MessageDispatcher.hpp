@@ -0,0 +1,218 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Solana/Logger.hpp"
+#include "Solana/Network/BoundedQueue.hpp"
+#include "Solana/Network/BufferPool.hpp"
+#include "Solana/Network/LatencyWindow.hpp"
+
+namespace Solana::Network
+{
+    // What the reader does with a message when the queue is full
+    enum class OverflowPolicy
+    {
+        // Stop reading until a worker makes room; TCP flow control then pushes back
+        // on the server, and nothing is lost unless the server gives up on us
+        Block,
+        // Discard the message just read
+        DropNewest,
+        // Discard the oldest queued message to make room, favouring fresh data
+        DropOldest,
+    };
+
+    struct DispatchConfig
+    {
+        // Threads running the message handler; 0 runs it on the read thread itself.
+        // One worker handles messages in the order they were read; with more, they
+        // are handled concurrently and out of order, so only for handlers that treat
+        // every message on its own. SubscriptionManager does not (a subscribe reply
+        // must be routed before the notifications it enables, and gaps are detected
+        // from slot order), so Rpc and WebSocketPool reject more than one.
+        std::size_t workers = 0;
+        // Messages read but not yet picked up by a worker, rounded up to a power of two
+        std::size_t queueCapacity = 1024;
+        OverflowPolicy overflow = OverflowPolicy::Block;
+    };
+
+    struct DispatchStats
+    {
+        std::size_t handled = 0;
+        std::size_t dropped = 0;
+        // Messages waiting for a worker right now, and the most there have been
+        std::size_t depth = 0;
+        std::size_t highWater = 0;
+        // Read to picked up by a worker, and time spent in the handler, over recent messages
+        std::chrono::microseconds queuedP50{0};
+        std::chrono::microseconds queuedP99{0};
+        std::chrono::microseconds handlerP50{0};
+        std::chrono::microseconds handlerP99{0};
+    };
+
+    // Hands messages from one reader to a pool of worker threads through a
+    // lock-free BoundedQueue, so a slow handler delays other messages but never
+    // the socket. Workers sleep on an atomic when the queue is empty; the reader
+    // wakes one per message. With several workers, handlers run concurrently and in
+    // no particular order; a single worker takes messages in the order offered.
+    class MessageDispatcher
+    {
+    public:
+        using Handler = std::function<void(PooledBuffer &&)>;
+
+        MessageDispatcher(const DispatchConfig &config, Handler handler)
+            : config_(config), handler_(std::move(handler)), queue_(config.queueCapacity)
+        {
+            const auto workers = std::max<std::size_t>(config_.workers, 1);
+            for (std::size_t i = 0; i < workers; ++i)
+            {
+                windows_.push_back(std::make_unique<Windows>());
+            }
+            for (std::size_t i = 0; i < workers; ++i)
+            {
+                workers_.emplace_back([this, i]()
+                                      { work(*windows_[i]); });
+            }
+        }
+
+        ~MessageDispatcher() { stop(); }
+
+        // Waits for the workers to finish the messages already queued, then stops
+        // them. Nothing may be offered afterwards.
+        void stop()
+        {
+            stopping_ = true;
+            signal_.fetch_add(1, std::memory_order_release);
+            signal_.notify_all();
+            for (auto &worker : workers_)
+            {
+                if (worker.joinable())
+                {
+                    worker.join();
+                }
+            }
+        }
+
+        // Queues a message read at `received`. Returns false, leaving message with
+        // the caller, only under OverflowPolicy::Block with the queue full.
+        bool offer(PooledBuffer &message, std::chrono::steady_clock::time_point received)
+        {
+            Frame frame{std::move(message), received};
+            while (!queue_.tryPush(std::move(frame)))
+            {
+                if (config_.overflow == OverflowPolicy::Block)
+                {
+                    message = std::move(frame.message);
+                    return false;
+                }
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                if (config_.overflow == OverflowPolicy::DropNewest)
+                {
+                    return true;
+                }
+                Frame oldest;
+                queue_.tryPop(oldest);
+            }
+
+            const auto depth = queue_.size();
+            if (depth > highWater_.load(std::memory_order_relaxed))
+            {
+                highWater_.store(depth, std::memory_order_relaxed);
+            }
+            signal_.fetch_add(1, std::memory_order_release);
+            signal_.notify_one();
+            return true;
+        }
+
+        DispatchStats stats() const
+        {
+            DispatchStats stats{
+                .handled = handled_.load(std::memory_order_relaxed),
+                .dropped = dropped_.load(std::memory_order_relaxed),
+                .depth = queue_.size(),
+                .highWater = highWater_.load(std::memory_order_relaxed)};
+            std::vector<std::unique_lock<std::mutex>> locks;
+            std::vector<const LatencyWindow *> queued;
+            std::vector<const LatencyWindow *> handling;
+            for (const auto &windows : windows_)
+            {
+                locks.emplace_back(windows->mutex);
+                queued.push_back(&windows->queued);
+                handling.push_back(&windows->handling);
+            }
+            stats.queuedP50 = LatencyWindow::quantile(queued, 0.5);
+            stats.queuedP99 = LatencyWindow::quantile(queued, 0.99);
+            stats.handlerP50 = LatencyWindow::quantile(handling, 0.5);
+            stats.handlerP99 = LatencyWindow::quantile(handling, 0.99);
+            return stats;
+        }
+
+    private:
+        struct Frame
+        {
+            PooledBuffer message;
+            std::chrono::steady_clock::time_point received;
+        };
+
+        // One set per worker, so recording a sample never contends with other workers
+        struct Windows
+        {
+            LatencyWindow queued{1024};
+            LatencyWindow handling{1024};
+            std::mutex mutex;
+        };
+
+        void work(Windows &windows)
+        {
+            Frame frame;
+            for (;;)
+            {
+                const auto seen = signal_.load(std::memory_order_acquire);
+                if (!queue_.tryPop(frame))
+                {
+                    if (stopping_)
+                    {
+                        return;
+                    }
+                    // Returns at once if a message was offered since `seen` was read
+                    signal_.wait(seen, std::memory_order_acquire);
+                    continue;
+                }
+
+                const auto picked = std::chrono::steady_clock::now();
+                try
+                {
+                    handler_(std::move(frame.message));
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_ERROR("WebSocket message handler threw: {}", e.what());
+                }
+                // Back to the pool now rather than when the slot is reused
+                frame.message = PooledBuffer();
+                const auto done = std::chrono::steady_clock::now();
+                handled_.fetch_add(1, std::memory_order_relaxed);
+
+                std::unique_lock<std::mutex> lock(windows.mutex);
+                windows.queued.record(std::chrono::duration_cast<std::chrono::microseconds>(picked - frame.received));
+                windows.handling.record(std::chrono::duration_cast<std::chrono::microseconds>(done - picked));
+            }
+        }
+
+        DispatchConfig config_;
+        Handler handler_;
+        BoundedQueue<Frame> queue_;
+        std::vector<std::unique_ptr<Windows>> windows_;
+        std::atomic<std::uint32_t> signal_ = 0;
+        std::atomic<bool> stopping_ = false;
+        std::atomic<std::size_t> handled_ = 0;
+        std::atomic<std::size_t> dropped_ = 0;
+        std::atomic<std::size_t> highWater_ = 0;
+        // Last, so the threads stop before anything they use goes away
+        std::vector<std::thread> workers_;
+    };
+}
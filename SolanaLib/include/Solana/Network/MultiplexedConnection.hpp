@@ -0,0 +1,29 @@
+#pragma once
+#include <boost/beast.hpp>
+#include <functional>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+namespace Solana::Network
+{
+    // A single connection that carries many concurrent requests (HTTP/1.1 pipelining
+    // or HTTP/2 streams). The completion receives the failed stage name on error.
+    class MultiplexedConnection
+    {
+    public:
+        using Completion = std::function<void(beast::error_code, const char *, http::response<http::string_body> &&)>;
+
+        virtual ~MultiplexedConnection() = default;
+
+        // May be called from any thread
+        virtual void submit(http::request<http::string_body> &&req, Completion done) = 0;
+
+        // Opens the connection ahead of the first request, or reports true at once if
+        // it is already open. May be called from any thread.
+        virtual void warm(std::function<void(bool)> done) = 0;
+
+        // Requests queued or awaiting a response; used to pick the least loaded connection
+        virtual std::size_t pending() const = 0;
+    };
+}
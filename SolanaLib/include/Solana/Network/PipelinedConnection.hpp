@@ -0,0 +1,299 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Solana/Logger.hpp"
+#include "Solana/Network/Connector.hpp"
+#include "Solana/Network/MultiplexedConnection.hpp"
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace ssl = net::ssl;
+
+namespace Solana::Network
+{
+    // One keep-alive TLS stream carrying several in-flight HTTP/1.1 requests.
+    // Requests are written back to back (up to maxInFlight unanswered) and
+    // responses are matched to callers in FIFO order, as HTTP/1.1 requires.
+    // Requests written to a kept-alive stream after it sat idle go out once more on
+    // a fresh connection if the server turns out to have closed it meanwhile.
+    // All state lives on the connection's strand; submit() may be called from any thread.
+    class PipelinedConnection : public MultiplexedConnection, public std::enable_shared_from_this<PipelinedConnection>
+    {
+    public:
+        using Stream = beast::ssl_stream<beast::tcp_stream>;
+
+        PipelinedConnection(
+            net::io_context &ioc,
+            std::shared_ptr<ssl::context> ctx,
+            const std::string &host,
+            const std::string &port,
+            std::size_t maxInFlight)
+            : strand_(net::make_strand(ioc)),
+              ctx_(std::move(ctx)),
+              host_(host),
+              port_(port),
+              maxInFlight_(std::max<std::size_t>(maxInFlight, 1))
+        {
+        }
+
+        void submit(http::request<http::string_body> &&req, Completion done) override
+        {
+            ++pending_;
+            net::dispatch(strand_, [self = shared_from_this(), req = std::move(req), done = std::move(done)]() mutable
+                          {
+                self->queued_.push_back(Call{std::move(req), std::move(done)});
+                self->pump(); });
+        }
+
+        void warm(std::function<void(bool)> done) override
+        {
+            net::dispatch(strand_, [self = shared_from_this(), done = std::move(done)]() mutable
+                          {
+                if (self->stream_ && !self->connecting_)
+                {
+                    done(true);
+                    return;
+                }
+                self->warming_.push_back(std::move(done));
+                if (!self->connecting_)
+                    self->connect(); });
+        }
+
+        std::size_t pending() const override { return pending_; }
+
+    private:
+        struct Call
+        {
+            http::request<http::string_body> req;
+            Completion done;
+            bool resent = false;
+        };
+
+        struct Flight
+        {
+            Completion done;
+            // A copy of the request while it may have to go out again
+            std::optional<http::request<http::string_body>> req;
+            bool resent = false;
+        };
+
+        // How a server closing a kept-alive stream shows up on the next request
+        static bool closedByPeer(const beast::error_code &ec)
+        {
+            return ec == net::error::eof || ec == http::error::end_of_stream ||
+                   ec == net::error::connection_reset || ec == net::error::broken_pipe ||
+                   ec == ssl::error::stream_truncated;
+        }
+
+        void pump()
+        {
+            if (connecting_)
+            {
+                return;
+            }
+
+            if (!stream_)
+            {
+                if (!queued_.empty())
+                {
+                    connect();
+                }
+                return;
+            }
+
+            if (!writing_ && !queued_.empty() && inFlight_.size() < maxInFlight_)
+            {
+                write();
+            }
+
+            if (!reading_ && !inFlight_.empty())
+            {
+                read();
+            }
+        }
+
+        void connect()
+        {
+            connecting_ = true;
+            stream_ = std::make_unique<Stream>(strand_, *ctx_);
+            Connector::establish(*stream_, host_, port_,
+                                 [self = shared_from_this()](beast::error_code ec, const char *what)
+                                 {
+                                     self->connecting_ = false;
+                                     for (auto &done : std::exchange(self->warming_, {}))
+                                     {
+                                         done(!ec);
+                                     }
+                                     if (ec)
+                                     {
+                                         // Nothing was written yet, so everything queued fails
+                                         self->stream_.reset();
+                                         self->failQueued(ec, what);
+                                         return;
+                                     }
+                                     LOG_INFO("Pipelined connection ready for {}:{}", self->host_, self->port_);
+                                     self->pump();
+                                 });
+        }
+
+        void write()
+        {
+            writing_ = true;
+            auto &call = queued_.front();
+            if (reused_ && inFlight_.empty())
+            {
+                resumed_ = true;
+            }
+            inFlight_.push_back(Flight{std::move(call.done), std::nullopt, call.resent});
+            if (resumed_ && !call.resent)
+            {
+                inFlight_.back().req = call.req;
+            }
+            writeReq_ = std::move(call.req);
+            queued_.pop_front();
+
+            beast::get_lowest_layer(*stream_).expires_after(std::chrono::seconds(30));
+            http::async_write(*stream_, writeReq_,
+                              [self = shared_from_this()](beast::error_code ec, std::size_t)
+                              {
+                                  self->writing_ = false;
+                                  if (ec)
+                                  {
+                                      self->reset(ec, "write");
+                                      return;
+                                  }
+                                  self->pump();
+                              });
+        }
+
+        void read()
+        {
+            reading_ = true;
+            response_ = {};
+            http::async_read(*stream_, buffer_, response_,
+                             [self = shared_from_this()](beast::error_code ec, std::size_t)
+                             {
+                                 self->reading_ = false;
+                                 self->on_read(ec);
+                             });
+        }
+
+        void on_read(beast::error_code ec)
+        {
+            if (ec)
+            {
+                reset(ec, "read");
+                return;
+            }
+
+            auto done = std::move(inFlight_.front().done);
+            inFlight_.pop_front();
+            --pending_;
+            reused_ = true;
+            resumed_ = false;
+            const bool keep_alive = response_.keep_alive();
+            done({}, nullptr, std::move(response_));
+
+            if (!keep_alive)
+            {
+                // Anything already written behind this response will never be answered
+                LOG_INFO("Server closed pipelined connection to {}:{}", host_, port_);
+                reset(http::error::end_of_stream, "read");
+                return;
+            }
+            pump();
+        }
+
+        // Drops the stream and fails every request written on it. Requests that were
+        // never written stay queued and go out on a fresh connection, as do those
+        // written after the stream sat idle if the server had closed it by then.
+        void reset(beast::error_code ec, const char *what)
+        {
+            // The operation still outstanding fails with operation_aborted; report
+            // what broke the stream
+            if (!failure_)
+            {
+                failure_ = ec;
+                failedIn_ = what;
+            }
+            if (writing_ || reading_)
+            {
+                // Let the outstanding operation complete; it will observe the closed socket
+                beast::error_code ignored;
+                beast::get_lowest_layer(*stream_).socket().close(ignored);
+                return;
+            }
+            ec = std::exchange(failure_, {});
+            what = failedIn_;
+
+            LOG_WARN("Pipelined connection to {}:{} failed in {}: {}", host_, port_, what, ec.message());
+            const bool resend = resumed_ && closedByPeer(ec);
+            stream_.reset();
+            buffer_.clear();
+            reused_ = false;
+            resumed_ = false;
+            auto inFlight = std::move(inFlight_);
+            inFlight_.clear();
+            for (auto it = inFlight.rbegin(); it != inFlight.rend(); ++it)
+            {
+                if (resend && it->req)
+                {
+                    queued_.push_front(Call{std::move(*it->req), std::move(it->done), true});
+                    continue;
+                }
+                --pending_;
+                it->done(ec, what, {});
+            }
+            if (resend)
+            {
+                LOG_INFO("Resending requests to {}:{} on a fresh connection", host_, port_);
+            }
+            pump();
+        }
+
+        void failQueued(beast::error_code ec, const char *what)
+        {
+            auto queued = std::move(queued_);
+            queued_.clear();
+            for (auto &call : queued)
+            {
+                --pending_;
+                call.done(ec, what, {});
+            }
+        }
+
+        net::strand<net::io_context::executor_type> strand_;
+        std::shared_ptr<ssl::context> ctx_;
+        std::string host_;
+        std::string port_;
+        std::size_t maxInFlight_;
+        std::unique_ptr<Stream> stream_;
+        beast::flat_buffer buffer_;
+        http::request<http::string_body> writeReq_;
+        http::response<http::string_body> response_;
+        std::deque<Call> queued_;
+        std::deque<Flight> inFlight_;
+        std::atomic<std::size_t> pending_ = 0;
+        // The stream has answered a request, so the server may close it while idle
+        bool reused_ = false;
+        // Requests went out on a reused stream that has answered none of them yet
+        bool resumed_ = false;
+        beast::error_code failure_;
+        const char *failedIn_ = "";
+        bool connecting_ = false;
+        // warm() callers waiting for the connection attempt in progress
+        std::vector<std::function<void(bool)>> warming_;
+        bool writing_ = false;
+        bool reading_ = false;
+    };
+}
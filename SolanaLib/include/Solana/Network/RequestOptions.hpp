@@ -0,0 +1,242 @@
+#pragma once
+#include <boost/system/error_code.hpp>
+#include <boost/system/system_error.hpp>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Solana::Network
+{
+    // Failures HttpClient reports itself rather than passing through from Asio/Beast.
+    // Requests fail with boost::system::system_error carrying one of these codes, so
+    // callers can tell which stage ran out of time and hedge or fail over.
+    enum class Error
+    {
+        ResolveTimeout = 1,
+        ConnectTimeout,
+        HandshakeTimeout,
+        WriteTimeout,
+        ReadTimeout,
+        Cancelled,
+        // Still queued for a rate limiter or a pooled connection when the deadline passed
+        QueueTimeout
+    };
+}
+
+namespace boost::system
+{
+    template <>
+    struct is_error_code_enum<Solana::Network::Error> : std::true_type
+    {
+    };
+}
+
+namespace Solana::Network
+{
+    class ErrorCategory : public boost::system::error_category
+    {
+    public:
+        const char *name() const noexcept override { return "solana.network"; }
+
+        std::string message(int ev) const override
+        {
+            switch (static_cast<Error>(ev))
+            {
+            case Error::ResolveTimeout:
+                return "deadline expired while resolving";
+            case Error::ConnectTimeout:
+                return "deadline expired while connecting";
+            case Error::HandshakeTimeout:
+                return "deadline expired during the TLS handshake";
+            case Error::WriteTimeout:
+                return "deadline expired while sending the request";
+            case Error::ReadTimeout:
+                return "deadline expired while waiting for the response";
+            case Error::Cancelled:
+                return "request cancelled";
+            case Error::QueueTimeout:
+                return "deadline expired before the request was sent";
+            }
+            return "unknown network error";
+        }
+    };
+
+    inline const boost::system::error_category &errorCategory()
+    {
+        static const ErrorCategory category;
+        return category;
+    }
+
+    inline boost::system::error_code make_error_code(Error e)
+    {
+        return {static_cast<int>(e), errorCategory()};
+    }
+
+    inline bool isTimeout(const boost::system::error_code &ec)
+    {
+        return ec.category() == errorCategory() && ec.value() != static_cast<int>(Error::Cancelled);
+    }
+
+    // Maps a stream timeout at the given stage ("resolve", "connect", "handshake",
+    // "write", "read") to its distinct code
+    inline boost::system::error_code timeoutAt(const char *stage)
+    {
+        if (std::strcmp(stage, "resolve") == 0)
+            return Error::ResolveTimeout;
+        if (std::strcmp(stage, "connect") == 0)
+            return Error::ConnectTimeout;
+        if (std::strcmp(stage, "handshake") == 0)
+            return Error::HandshakeTimeout;
+        if (std::strcmp(stage, "write") == 0)
+            return Error::WriteTimeout;
+        return Error::ReadTimeout;
+    }
+
+    // Cancels every request it was passed to. Thread-safe; cancelling twice is a no-op.
+    class CancellationToken
+    {
+        struct State
+        {
+            std::mutex mutex;
+            bool cancelled = false;
+            std::size_t nextId = 0;
+            std::map<std::size_t, std::function<void()>> callbacks;
+        };
+
+    public:
+        // Keeps a callback passed to onCancel() registered; resetting or destroying it
+        // removes the callback, so a token shared by many requests only holds those
+        // still in flight
+        class Registration
+        {
+        public:
+            Registration() = default;
+
+            Registration(Registration &&other) noexcept
+                : state_(std::move(other.state_)), id_(other.id_)
+            {
+            }
+
+            Registration &operator=(Registration &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    reset();
+                    state_ = std::move(other.state_);
+                    id_ = other.id_;
+                }
+                return *this;
+            }
+
+            ~Registration() { reset(); }
+
+            // A callback already running on cancel() may still finish after this returns
+            void reset()
+            {
+                if (auto state = state_.lock())
+                {
+                    std::unique_lock<std::mutex> lock(state->mutex);
+                    state->callbacks.erase(id_);
+                }
+                state_.reset();
+            }
+
+        private:
+            friend class CancellationToken;
+
+            Registration(const std::shared_ptr<State> &state, std::size_t id) : state_(state), id_(id) {}
+
+            std::weak_ptr<State> state_;
+            std::size_t id_ = 0;
+        };
+
+        void cancel()
+        {
+            std::map<std::size_t, std::function<void()>> callbacks;
+            {
+                std::unique_lock<std::mutex> lock(state_->mutex);
+                if (state_->cancelled)
+                {
+                    return;
+                }
+                state_->cancelled = true;
+                callbacks.swap(state_->callbacks);
+            }
+            for (auto &[id, callback] : callbacks)
+            {
+                callback();
+            }
+        }
+
+        bool cancelled() const
+        {
+            std::unique_lock<std::mutex> lock(state_->mutex);
+            return state_->cancelled;
+        }
+
+        // Runs the callback on cancel(), or right away if that already happened.
+        // Keep the registration until the request it cancels completes.
+        [[nodiscard]] Registration onCancel(std::function<void()> callback)
+        {
+            {
+                std::unique_lock<std::mutex> lock(state_->mutex);
+                if (!state_->cancelled)
+                {
+                    const auto id = state_->nextId++;
+                    state_->callbacks.emplace(id, std::move(callback));
+                    return Registration(state_, id);
+                }
+            }
+            callback();
+            return {};
+        }
+
+    private:
+        std::shared_ptr<State> state_ = std::make_shared<State>();
+    };
+
+    struct RequestOptions
+    {
+        // Budget for the whole call, measured from when it is issued and shared by
+        // resolve, connect, handshake, write and read
+        std::optional<std::chrono::milliseconds> timeout;
+        // Absolute alternative to timeout; the earlier of the two applies
+        std::optional<std::chrono::steady_clock::time_point> deadline;
+        std::shared_ptr<CancellationToken> cancellation;
+        // Safe to send more than once, so a multi-endpoint client may hedge it
+        bool idempotent = false;
+        // Queue position while a rate-limited client holds requests back; higher goes first
+        int priority = 0;
+
+        static constexpr std::chrono::seconds defaultTimeout{30};
+
+        bool bounded() const { return timeout || deadline || cancellation; }
+
+        std::chrono::steady_clock::time_point expiry() const
+        {
+            auto expiry = std::chrono::steady_clock::now() + (timeout ? *timeout : std::chrono::milliseconds(defaultTimeout));
+            if (deadline && *deadline < expiry)
+            {
+                expiry = *deadline;
+            }
+            return expiry;
+        }
+
+        // The same budget as an absolute deadline, for calls that may be queued or
+        // retried before their last attempt starts. The default budget is anchored
+        // too, so waiting never restarts it.
+        RequestOptions anchored() const
+        {
+            auto result = *this;
+            result.deadline = expiry();
+            result.timeout.reset();
+            return result;
+        }
+    };
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Solana::Network
+{
+    // A well-formed JSON-RPC reply carrying an `error` member, e.g. an invalid
+    // param or a preflight failure. The endpoint did its job, so unlike a reply
+    // that cannot be parsed at all this does not count against its health.
+    class RpcError : public std::runtime_error
+    {
+    public:
+        // error: raw JSON of the reply's error member
+        explicit RpcError(std::string error)
+            : std::runtime_error("request error: " + error),
+              error_(std::move(error))
+        {
+        }
+
+        const std::string &error() const { return error_; }
+
+    private:
+        std::string error_;
+    };
+}
@@ -0,0 +1,186 @@
+#pragma once
+#include <boost/asio/ssl.hpp>
+#include <openssl/ssl.h>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace net = boost::asio;
+namespace ssl = net::ssl;
+
+namespace Solana::Network
+{
+    struct TlsSessionStats
+    {
+        // Sessions (or TLS 1.3 tickets) the servers handed out
+        std::size_t stored = 0;
+        std::size_t offered = 0;
+        std::size_t resumed = 0;
+        std::size_t fullHandshakes = 0;
+    };
+
+    // Client-side TLS session cache attached to an ssl::context, keyed by SNI host
+    // name. A new connection to a host offers a session from an earlier one, so the
+    // server can skip certificate exchange and key agreement (one round trip
+    // instead of two on TLS 1.2, no certificate verification on either version).
+    // TLS 1.3 tickets are used once each (RFC 8446 C.4); every resumed connection
+    // brings fresh ones. Thread-safe; the cache lives as long as the context.
+    class TlsSessionCache
+    {
+    public:
+        // Tickets kept per host; servers typically send two per connection
+        static constexpr std::size_t maxPerHost = 8;
+
+        static void enable(ssl::context &ctx)
+        {
+            auto *native = ctx.native_handle();
+            if (from(native))
+            {
+                return;
+            }
+            SSL_CTX_set_ex_data(native, index(), new TlsSessionCache());
+            // OpenSSL's internal store is keyed by session ID, which a client cannot look
+            // up by host, so keep sessions here instead
+            SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(native, &onNewSession);
+        }
+
+        // Offers a cached session for the stream's SNI host, if there is one. Call
+        // after setting SNI and before the handshake; a no-op on contexts without a cache.
+        static void offer(SSL *ssl)
+        {
+            auto *cache = from(SSL_get_SSL_CTX(ssl));
+            const char *host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+            if (!cache || !host)
+            {
+                return;
+            }
+            if (auto *session = cache->take(host))
+            {
+                SSL_set_session(ssl, session);
+                SSL_SESSION_free(session);
+            }
+        }
+
+        // Counts a finished handshake as resumed or full
+        static void completed(SSL *ssl)
+        {
+            if (auto *cache = from(SSL_get_SSL_CTX(ssl)))
+            {
+                std::unique_lock<std::mutex> lock(cache->mutex_);
+                ++(SSL_session_reused(ssl) ? cache->stats_.resumed : cache->stats_.fullHandshakes);
+            }
+        }
+
+        static TlsSessionStats stats(ssl::context &ctx)
+        {
+            auto *cache = from(ctx.native_handle());
+            if (!cache)
+            {
+                return {};
+            }
+            std::unique_lock<std::mutex> lock(cache->mutex_);
+            return cache->stats_;
+        }
+
+        ~TlsSessionCache()
+        {
+            for (auto &[host, sessions] : sessions_)
+            {
+                for (auto *session : sessions)
+                {
+                    SSL_SESSION_free(session);
+                }
+            }
+        }
+
+    private:
+        TlsSessionCache() = default;
+
+        static int index()
+        {
+            static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, &freeCache);
+            return index;
+        }
+
+        static void freeCache(void *, void *cache, CRYPTO_EX_DATA *, int, long, void *)
+        {
+            delete static_cast<TlsSessionCache *>(cache);
+        }
+
+        static TlsSessionCache *from(SSL_CTX *ctx)
+        {
+            return static_cast<TlsSessionCache *>(SSL_CTX_get_ex_data(ctx, index()));
+        }
+
+        // OpenSSL calls this for every session or ticket received. A copy is kept
+        // because OpenSSL marks the connection's own session unresumable once the
+        // connection is freed without a close_notify, which is how the pool drops them.
+        static int onNewSession(SSL *ssl, SSL_SESSION *session)
+        {
+            auto *cache = from(SSL_get_SSL_CTX(ssl));
+            const char *host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+            if (cache && host)
+            {
+                if (auto *copy = SSL_SESSION_dup(session))
+                {
+                    cache->store(host, copy);
+                }
+            }
+            return 0;
+        }
+
+        void store(const std::string &host, SSL_SESSION *session)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto &sessions = sessions_[host];
+            sessions.push_back(session);
+            ++stats_.stored;
+            if (sessions.size() > maxPerHost)
+            {
+                SSL_SESSION_free(sessions.front());
+                sessions.pop_front();
+            }
+        }
+
+        // Newest usable session for host with a reference for the caller, or nullptr
+        SSL_SESSION *take(const std::string &host)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const auto it = sessions_.find(host);
+            if (it == sessions_.end())
+            {
+                return nullptr;
+            }
+            auto &sessions = it->second;
+            const auto now = std::time(nullptr);
+            while (!sessions.empty())
+            {
+                auto *session = sessions.back();
+                if (!SSL_SESSION_is_resumable(session) ||
+                    SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) <= now)
+                {
+                    SSL_SESSION_free(session);
+                    sessions.pop_back();
+                    continue;
+                }
+                ++stats_.offered;
+                if (SSL_SESSION_get_protocol_version(session) >= TLS1_3_VERSION)
+                {
+                    sessions.pop_back();
+                    return session;
+                }
+                // Earlier versions may resume the same session again; hand out a copy
+                // so the connection using it cannot mark ours unresumable
+                return SSL_SESSION_dup(session);
+            }
+            return nullptr;
+        }
+
+        std::unordered_map<std::string, std::deque<SSL_SESSION *>> sessions_;
+        TlsSessionStats stats_;
+        std::mutex mutex_;
+    };
+}
@@ -5,12 +5,20 @@
 #include <boost/beast/ssl.hpp>
 #include <boost/beast/websocket.hpp>
 #include <boost/asio/spawn.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/json.hpp>
+#include "Solana/Network/BufferPool.hpp"
+#include "Solana/Network/LatencyWindow.hpp"
+#include "Solana/Network/MessageDispatcher.hpp"
 
+#include <chrono>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -21,9 +29,84 @@ using tcp = boost::asio::ip::tcp;
 
 namespace Solana::Network
 {
+    struct ReconnectConfig
+    {
+        // Delay before the first attempt after a drop, doubled after every failed
+        // attempt up to maxBackoff
+        std::chrono::milliseconds initialBackoff{250};
+        std::chrono::milliseconds maxBackoff{30000};
+        // Each delay is drawn from [delay * (1 - jitter), delay], so clients dropped
+        // together by a provider restart do not all come back at once
+        double jitter = 0.5;
+    };
+
+    // permessage-deflate (RFC 7692), offered in the upgrade request. A server that
+    // declines it sends plain frames as before; stats().compressed says which.
+    struct CompressionConfig
+    {
+        bool enabled = false;
+        // The server compresses what we read with a 2^bits byte window (9-15).
+        // Notifications repeat program ids, log lines and account layouts, so the
+        // full window pays off; smaller ones save the server memory per connection.
+        int serverMaxWindowBits = 15;
+        // Window for the requests we send
+        int clientMaxWindowBits = 15;
+        // Keep each side's window from one message to the next, so text repeated
+        // across notifications compresses too. Off, every message starts afresh:
+        // a worse ratio, but no inflate state held between messages.
+        bool contextTakeover = true;
+        // zlib level (0-9) and memory level (1-9) of our own deflate stream
+        int level = 6;
+        int memLevel = 4;
+    };
+
+    struct WebSocketConfig
+    {
+        std::string host;
+        std::string port = "443";
+        // Sent as the api-key query parameter of the upgrade request
+        std::string apiKey;
+        ReconnectConfig reconnect;
+        // Read buffers kept for reuse between messages; 0 reads every message into
+        // a fresh buffer
+        std::size_t pooledBuffers = 8;
+        // Hand messages to worker threads instead of running the handler on the
+        // read thread; the pool then also keeps a buffer per queue slot
+        DispatchConfig dispatch;
+        CompressionConfig compression;
+        // Requests queued with doWrite() while a write is in flight go out together
+        // as one JSON-RPC batch frame of up to this many; 1 sends each in a frame of
+        // its own. Only for servers that accept batch requests, and every message
+        // queued must then be a single JSON-RPC request.
+        std::size_t writeBatch = 1;
+    };
+
+    struct WebSocketStats
+    {
+        std::size_t connects = 0;
+        std::size_t disconnects = 0;
+        // Attempts that failed to resolve, connect or handshake
+        std::size_t failedAttempts = 0;
+        // Time from noticing a drop to being connected again with the subscriptions
+        // replayed, over recent reconnects
+        std::chrono::milliseconds recoverP50{0};
+        std::chrono::milliseconds recoverP99{0};
+        // Whether the current connection negotiated permessage-deflate
+        bool compressed = false;
+        // Messages queued with doWrite() that went out, and the frames they took
+        std::size_t messagesWritten = 0;
+        std::size_t framesWritten = 0;
+        BufferPoolStats buffers;
+        DispatchStats dispatch;
+    };
+
     class WebSocket : public std::enable_shared_from_this<WebSocket>
     {
     public:
+        // Gets each message in a pooled buffer: read it in place with view(), and
+        // it goes back to the pool when the handler returns, or move it out to keep it
+        using MessageHandler = std::function<void(PooledBuffer &&)>;
+
         // Factory method to ensure proper shared_ptr creation
         static std::shared_ptr<WebSocket> create(
             net::io_context &ioc,
@@ -32,27 +115,59 @@ namespace Solana::Network
             const std::string &port,
             const std::string &api_key);
 
+        static std::shared_ptr<WebSocket> create(
+            net::io_context &ioc,
+            ssl::context &ctx,
+            const WebSocketConfig &config);
+
         // Constructor is private - use create() instead
         ~WebSocket();
 
-        // Start the WebSocket connection with retry logic
+        // Connect, send subscription_messages and read until stop(). A dropped
+        // connection is re-established with jittered exponential backoff and the
+        // messages sent again; start() returns after max_retries consecutive failed
+        // attempts (0 retries forever).
+        void start(const std::vector<std::string> &subscription_messages,
+                   MessageHandler on_msg_callback,
+                   int max_retries = 5);
+
+        // Same, handing over each message's flat_buffer; one the handler moves
+        // from is replaced with a new buffer for the next read
         void start(const std::vector<std::string> &subscription_messages,
                    std::function<void(beast::flat_buffer &&)> on_msg_callback,
                    int max_retries = 5);
 
-        // Send a message through the WebSocket
-        void doWrite(const std::string &message);
+        // Called on ioc once a replacement connection is up. Messages queued with
+        // doWrite() and not yet written when the old connection dropped are
+        // discarded first, so re-send whatever still matters here.
+        void onReconnect(std::function<void()> handler);
+
+        // Closes the connection without reconnecting. Safe from any thread.
+        void stop();
+
+        WebSocketStats stats() const;
+
+        // Queue a message for the WebSocket. Safe from any thread; messages go out
+        // in the order queued once the connection is up, batched per writeBatch.
+        // A reconnect drops them (see onReconnect).
+        // A burst of calls costs one hand-off to the strand, not one each.
+        void doWrite(std::string message);
 
     private:
         // Private constructor - use factory method instead
-        WebSocket(net::io_context &ioc, ssl::context &ctx,
-                  const std::string &host, const std::string &port,
-                  const std::string &api_key);
+        WebSocket(net::io_context &ioc, ssl::context &ctx, const WebSocketConfig &config);
+
+        // Spawn a connection attempt on a fresh stream
+        void connect();
 
         // Connect and subscribe to the WebSocket
-        void subscribe(net::yield_context yield,
-                       const std::vector<std::string> subscription_messages,
-                       std::function<void(beast::flat_buffer &&)> on_msg_callback);
+        void subscribe(net::yield_context yield);
+
+        // Count a failed attempt and schedule the next one
+        void retry(beast::error_code ec, char const *what);
+
+        // Wait out the backoff for the next attempt, or give up after max_retries
+        void scheduleReconnect();
 
         // Start reading messages
         void doRead();
@@ -60,21 +175,63 @@ namespace Solana::Network
         // Handle received messages
         void onRead(beast::error_code ec, std::size_t bytes_transferred);
 
+        // Queue message_ for the dispatcher's workers, then read the next one; with
+        // the queue full under OverflowPolicy::Block, retry shortly instead
+        void handOff(std::chrono::steady_clock::time_point received);
+
+        // Write the next queued message, or batch of them, if any. Runs on strand_.
+        void flush();
+
         // Report a failure
         void fail(beast::error_code ec, char const *what);
 
         // Member variables
         net::io_context &ioc;
         ssl::context &ctx;
+        // Every handler touching the stream or the state below runs here, so ioc
+        // may be run by several threads
+        net::strand<net::io_context::executor_type> strand_;
         std::string host;
         std::string port;
         std::string api_key;
+        ReconnectConfig reconnect_;
+        DispatchConfig dispatch_;
+        CompressionConfig compression_;
+        std::size_t writeBatch_;
 
         std::shared_ptr<websocket::stream<beast::ssl_stream<beast::tcp_stream>>> ws;
-        beast::flat_buffer buffer;
+        std::shared_ptr<BufferPool> buffers_;
+        // The buffer the read in progress fills
+        PooledBuffer message_;
         net::steady_timer timer_;
+        net::steady_timer backpressureTimer_;
         bool cancelled;
-        std::function<void(beast::flat_buffer &&)> onMessage_;
+        MessageHandler onMessage_;
+        std::function<void()> onReconnect_;
+        std::vector<std::string> subscriptionMessages_;
+        // Messages handed to doWrite() and not yet moved to writeQueue_
+        std::vector<std::string> outbox_;
+        bool flushPosted_ = false;
+        std::mutex outboxMutex_;
+        // Messages waiting for the connection or for the write in progress, and
+        // the frame being written; only touched on strand_
+        std::deque<std::string> writeQueue_;
+        std::string frame_;
+        bool open_ = false;
+        bool writing_ = false;
+        // Bumped per connection, so completions from a dropped one are ignored
+        std::size_t generation_ = 0;
+        int maxRetries_ = 5;
+        // Consecutive failed attempts
+        int attempts_ = 0;
+        bool connectedBefore_ = false;
+        std::chrono::steady_clock::time_point lostAt_;
+
+        WebSocketStats stats_;
+        LatencyWindow recoveries_{256};
+        // Created by start() when dispatch.workers is set
+        std::unique_ptr<MessageDispatcher> dispatcher_;
+        mutable std::mutex statsMutex_;
     };
 }
 
@@ -0,0 +1,125 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "Solana/Logger.hpp"
+
+using json = nlohmann::json;
+namespace net = boost::asio;
+
+namespace Solana
+{
+    // One member of a JSON-RPC batch: the request object and the callback that
+    // resolves the caller's future from the matching reply member
+    struct PendingCall
+    {
+        json request;
+        std::function<void(std::exception_ptr, const json &)> resolve;
+    };
+
+    struct BatchSchedulerStats
+    {
+        std::size_t flushes = 0;
+        std::size_t calls = 0;
+        // Flushes triggered by reaching maxBatchSize rather than by the window
+        std::size_t fullFlushes = 0;
+        std::size_t maxFlushSize = 0;
+        // Time the oldest call of each flush spent waiting to be sent
+        std::chrono::microseconds totalWait{0};
+        std::chrono::microseconds maxWait{0};
+
+        double meanFlushSize() const { return flushes ? static_cast<double>(calls) / flushes : 0.0; }
+
+        std::chrono::microseconds meanWait() const { return flushes ? totalWait / static_cast<long>(flushes) : std::chrono::microseconds{0}; }
+    };
+
+    // Coalesces calls that arrive within a short window into one batch. The first
+    // call of an empty batch arms the window timer; the batch is handed to the flush
+    // callback when the timer fires or as soon as it holds maxBatchSize calls.
+    // add() may be called from any thread; batching state lives on a strand.
+    class BatchScheduler
+    {
+    public:
+        using Flush = std::function<void(std::vector<PendingCall> &&)>;
+
+        BatchScheduler(
+            std::shared_ptr<net::io_context> ioc,
+            std::chrono::microseconds window,
+            std::size_t maxBatchSize,
+            Flush flush)
+            : ioc_(std::move(ioc)),
+              strand_(net::make_strand(*ioc_)),
+              timer_(strand_),
+              window_(window),
+              maxBatchSize_(std::max<std::size_t>(maxBatchSize, 1)),
+              flush_(std::move(flush))
+        {
+        }
+
+        void add(PendingCall &&call)
+        {
+            net::dispatch(strand_, [this, call = std::move(call)]() mutable
+                          {
+                if (queued_.empty())
+                {
+                    opened_ = std::chrono::steady_clock::now();
+                    timer_.expires_after(window_);
+                    timer_.async_wait([this, generation = generation_](boost::system::error_code ec)
+                                      {
+                        // A full flush may already have sent the batch this timer was armed for
+                        if (!ec && generation == generation_)
+                            flush(false); });
+                }
+                queued_.push_back(std::move(call));
+                if (queued_.size() >= maxBatchSize_)
+                {
+                    flush(true);
+                } });
+        }
+
+        BatchSchedulerStats stats() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+    private:
+        void flush(bool full)
+        {
+            ++generation_;
+            timer_.cancel();
+
+            const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - opened_);
+            auto calls = std::move(queued_);
+            queued_.clear();
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ++stats_.flushes;
+                stats_.calls += calls.size();
+                stats_.fullFlushes += full ? 1 : 0;
+                stats_.maxFlushSize = std::max(stats_.maxFlushSize, calls.size());
+                stats_.totalWait += waited;
+                stats_.maxWait = std::max(stats_.maxWait, waited);
+            }
+            LOG_INFO("Flushing {} coalesced calls after {}us", calls.size(), waited.count());
+            flush_(std::move(calls));
+        }
+
+        // Keeps the io_context (and so the timer's service) alive for the timer's lifetime
+        std::shared_ptr<net::io_context> ioc_;
+        net::strand<net::io_context::executor_type> strand_;
+        net::steady_timer timer_;
+        std::chrono::microseconds window_;
+        std::size_t maxBatchSize_;
+        Flush flush_;
+        std::vector<PendingCall> queued_;
+        std::chrono::steady_clock::time_point opened_;
+        std::uint64_t generation_ = 0;
+        BatchSchedulerStats stats_;
+        mutable std::mutex mutex_;
+    };
+}
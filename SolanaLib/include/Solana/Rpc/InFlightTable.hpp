@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace Solana
+{
+    // Requests awaiting a reply, keyed by JSON-RPC id. Ids come from a monotonic
+    // counter, so consecutive ids land on different shards and concurrent
+    // insert/take calls rarely contend on the same lock. Lookups are a single
+    // hash probe regardless of how many requests are outstanding.
+    template <typename Entry, std::size_t Shards = 16>
+    class InFlightTable
+    {
+    public:
+        void insert(std::uint64_t id, Entry entry)
+        {
+            auto &shard = shardFor(id);
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.entries.insert_or_assign(id, std::move(entry));
+        }
+
+        // Removes and returns the entry, or nullopt if the id is unknown or already taken
+        std::optional<Entry> take(std::uint64_t id)
+        {
+            auto &shard = shardFor(id);
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(id);
+            if (it == shard.entries.end())
+            {
+                return std::nullopt;
+            }
+            std::optional<Entry> entry(std::move(it->second));
+            shard.entries.erase(it);
+            return entry;
+        }
+
+        std::size_t size() const
+        {
+            std::size_t total = 0;
+            for (const auto &shard : shards_)
+            {
+                std::unique_lock<std::mutex> lock(shard.mutex);
+                total += shard.entries.size();
+            }
+            return total;
+        }
+
+    private:
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::unordered_map<std::uint64_t, Entry> entries;
+        };
+
+        Shard &shardFor(std::uint64_t id) { return shards_[id % Shards]; }
+
+        std::array<Shard, Shards> shards_;
+    };
+}
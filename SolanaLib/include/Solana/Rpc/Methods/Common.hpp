@@ -1,6 +1,7 @@
 #pragma once
 #include <optional>
 #include <string>
+#include <string_view>
 #include "RpcMethod.hpp"
 
 namespace Solana
@@ -161,7 +162,7 @@ namespace Solana
         // Add others here
     };
 
-    inline KnownProgram identify_program(const std::string &program_id)
+    inline KnownProgram identify_program(std::string_view program_id)
     {
         if (program_id == "JUP6LkbZbjS1jKKwapdHNy74zcZ3tLUZoi5QNyVTaV4")
             return KnownProgram::JupiterV6;
@@ -186,7 +187,7 @@ namespace Solana
         // Add more known accounts here
     };
 
-    inline KnownAccount identify_account(const std::string &account_id)
+    inline KnownAccount identify_account(std::string_view account_id)
     {
         if (account_id == "D8cy77BBepLMngZx6ZukaTff5hCt1HrWyKk3Hnd9oitf")
             return KnownAccount::JupiterAggregatorEventAuthority;
@@ -57,6 +57,34 @@ namespace Solana
             return Reply{.signatures = std::move(results)};
         }
 
+        static Reply parseReplyView(const Encoding::JsonView &j)
+        {
+            std::vector<SignatureInfo> results;
+            for (const auto &entry : j["result"].elements())
+            {
+                SignatureInfo info{};
+                for (const auto &[key, value] : entry.members())
+                {
+                    if (key == "blockTime")
+                        info.blockTime = value.isNull() ? 0 : value.get<int64_t>();
+                    else if (key == "confirmationStatus")
+                        info.confirmationStatus = value.isNull() ? "" : value.get<std::string>();
+                    else if (key == "err")
+                        info.err = value.isNull() ? json(nullptr) : json::parse(value.raw());
+                    else if (key == "memo" && !value.isNull())
+                        info.memo = value.get<std::string>();
+                    else if (key == "signature")
+                        info.signature = value.get<std::string>();
+                    else if (key == "slot")
+                        info.slot = value.get<int64_t>();
+                }
+                results.push_back(std::move(info));
+            }
+
+            LOG_INFO("Parsed {} signatures from GetSignaturesForAddress reply", results.size());
+            return Reply{.signatures = std::move(results)};
+        }
+
         explicit GetSignaturesForAddress(const std::string &address, const Config &config = {})
             : key(address), config(config) {}
 
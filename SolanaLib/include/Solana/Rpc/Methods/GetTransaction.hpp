@@ -6,6 +6,9 @@
 #include <array>
 #include "Common.hpp"
 #include "Solana/Core/Types/Types.hpp"
+#include "Solana/Core/Encoding/Base58.hpp"
+#include "Solana/Core/Encoding/RawJson.hpp"
+#include "Solana/Logger.hpp"
 
 namespace Solana
 {
@@ -56,7 +59,9 @@ namespace Solana
         struct Reply
         {
             std::optional<SwapTx> swapTx;
-            std::optional<json> tx;
+            // The transaction as returned by the node; shares the response body when
+            // parsed through parseReplyView, call tx->parse() for a json DOM
+            std::optional<Encoding::RawJson> tx;
             std::string signature;
             u64 slot;
             i64 blockTime;
@@ -64,10 +69,8 @@ namespace Solana
 
         static Reply parseReply(const json &j)
         {
-            typename Private::TxnDataType<Encoding>::type txn{};
-            const auto d = j["result"];
-            const auto txnData = d["transaction"];
-            const auto txnMeta = d["meta"];
+            const auto &d = j["result"];
+            const auto &txnMeta = d["meta"];
 
             if (txnMeta.is_null())
             {
@@ -84,68 +87,129 @@ namespace Solana
 
             LOG_INFO("Inner instruction sets count: {}", ixns.size());
 
+            std::optional<SwapTx> swapTx;
             for (const auto &ixnSet : ixns)
             {
                 for (const auto &ixn : ixnSet["instructions"])
                 {
-                    // Early return if not Jupiter V6 program or missing expected accounts
-                    if (identify_program(ixn["programId"]) != KnownProgram::JupiterV6 ||
+                    // Skip if not Jupiter V6 program or missing expected accounts
+                    if (identify_program(ixn["programId"].get_ref<const std::string &>()) != KnownProgram::JupiterV6 ||
                         !ixn["accounts"].is_array() ||
-                        identify_account(ixn["accounts"][0]) != KnownAccount::JupiterAggregatorEventAuthority)
+                        identify_account(ixn["accounts"][0].get_ref<const std::string &>()) != KnownAccount::JupiterAggregatorEventAuthority)
                     {
                         continue;
                     }
 
                     LOG_INFO("Found Jupiter instruction with target account");
-                    const std::string &encoded = ixn["data"].get_ref<const std::string &>();
-                    std::optional<std::vector<uint8_t>> buf = Encoding::Base58::DecodeToBytes(encoded);
+                    if ((swapTx = decodeJupiterSwap(ixn["data"].get_ref<const std::string &>())))
+                    {
+                        break;
+                    }
+                }
+                if (swapTx)
+                {
+                    break;
+                }
+            }
+            return Reply{
+                .swapTx = std::move(swapTx),
+                .tx = Encoding::RawJson(d.dump()),
+                .signature = d["transaction"]["signatures"][0].get<std::string>(),
+                .slot = d["slot"].get<u64>(),
+                .blockTime = d["blockTime"].get<i64>()};
+        }
+
+        // Same result as parseReply, read straight from the response body. Reply::tx
+        // keeps a share of the body instead of a copy of the transaction.
+        static Reply parseReplyView(const Encoding::JsonView &j, const ReplyBody &body)
+        {
+            const auto d = j["result"];
+            const auto txnMeta = d["meta"];
+
+            if (txnMeta.isNull())
+            {
+                LOG_ERROR("Transaction meta is null");
+                return {};
+            }
 
-                    if (!buf || buf->size() != 128)
+            const auto ixns = txnMeta["innerInstructions"];
+            if (ixns.isNull())
+            {
+                LOG_ERROR("Transaction inner instructions are null");
+                return {};
+            }
+
+            std::optional<SwapTx> swapTx;
+            for (const auto &ixnSet : ixns.elements())
+            {
+                for (const auto &ixn : ixnSet["instructions"].elements())
+                {
+                    const auto accounts = ixn["accounts"];
+                    if (identify_program(ixn["programId"].get<std::string_view>()) != KnownProgram::JupiterV6 ||
+                        !accounts.isArray() ||
+                        identify_account(accounts[0].get<std::string_view>()) != KnownAccount::JupiterAggregatorEventAuthority)
                     {
                         continue;
                     }
 
-                    constexpr size_t OFFSET = 16;
-                    // Work directly with the buffer
-                    const uint8_t *data = buf->data();
-
-                    std::string amm = Encoding::Base58::Encode(data + OFFSET, data + OFFSET + 32);
-                    std::string inputMint = Encoding::Base58::Encode(data + OFFSET + 32, data + OFFSET + 64);
-                    std::string outputMint = Encoding::Base58::Encode(data + OFFSET + 72, data + OFFSET + 104);
-
-                    uint64_t inputAmount = 0;
-                    uint64_t outputAmount = 0;
-                    std::memcpy(&inputAmount, data + OFFSET + 64, 8);
-                    std::memcpy(&outputAmount, data + OFFSET + 104, 8);
-
-                    LOG_INFO("Decoded Jupiter V6:");
-                    LOG_INFO(" amm: {}", amm);
-                    LOG_INFO(" inputMint: {}", inputMint);
-                    LOG_INFO(" inputAmount: {}", std::to_string(inputAmount));
-                    LOG_INFO(" outputMint: {}", outputMint);
-                    LOG_INFO(" outputAmount: {}", std::to_string(outputAmount));
-                    return Reply{
-                        .swapTx = SwapTx{
-                            .amm = std::move(amm),
-                            .inputMint = std::move(inputMint),
-                            .outputMint = std::move(outputMint),
-                            .inputAmount = inputAmount,
-                            .outputAmount = outputAmount,
-                        },
-                        .tx = d,
-                        .signature = d["transaction"]["signatures"][0].get<std::string>(),
-                        .slot = d["slot"].get<u64>(),
-                        .blockTime = d["blockTime"].get<i64>()};
+                    LOG_INFO("Found Jupiter instruction with target account");
+                    if ((swapTx = decodeJupiterSwap(ixn["data"].get<std::string_view>())))
+                    {
+                        break;
+                    }
+                }
+                if (swapTx)
+                {
+                    break;
                 }
             }
             return Reply{
-                .swapTx = std::nullopt,
-                .tx = d,
+                .swapTx = std::move(swapTx),
+                .tx = Encoding::RawJson(body, d.raw()),
                 .signature = d["transaction"]["signatures"][0].get<std::string>(),
                 .slot = d["slot"].get<u64>(),
                 .blockTime = d["blockTime"].get<i64>()};
         }
 
+        // Jupiter V6 swap event: 16 bytes of discriminators, then amm, input mint,
+        // input amount, output mint and output amount
+        static std::optional<SwapTx> decodeJupiterSwap(std::string_view encoded)
+        {
+            std::optional<std::vector<uint8_t>> buf = Encoding::Base58::DecodeToBytes(encoded);
+
+            if (!buf || buf->size() != 128)
+            {
+                return std::nullopt;
+            }
+
+            constexpr size_t OFFSET = 16;
+            // Work directly with the buffer
+            const uint8_t *data = buf->data();
+
+            std::string amm = Encoding::Base58::Encode(data + OFFSET, data + OFFSET + 32);
+            std::string inputMint = Encoding::Base58::Encode(data + OFFSET + 32, data + OFFSET + 64);
+            std::string outputMint = Encoding::Base58::Encode(data + OFFSET + 72, data + OFFSET + 104);
+
+            uint64_t inputAmount = 0;
+            uint64_t outputAmount = 0;
+            std::memcpy(&inputAmount, data + OFFSET + 64, 8);
+            std::memcpy(&outputAmount, data + OFFSET + 104, 8);
+
+            LOG_INFO("Decoded Jupiter V6:");
+            LOG_INFO(" amm: {}", amm);
+            LOG_INFO(" inputMint: {}", inputMint);
+            LOG_INFO(" inputAmount: {}", std::to_string(inputAmount));
+            LOG_INFO(" outputMint: {}", outputMint);
+            LOG_INFO(" outputAmount: {}", std::to_string(outputAmount));
+            return SwapTx{
+                .outputMint = std::move(outputMint),
+                .inputMint = std::move(inputMint),
+                .amm = std::move(amm),
+                .inputAmount = inputAmount,
+                .outputAmount = outputAmount,
+            };
+        }
+
         // Config params
 
         struct Config
@@ -206,7 +270,7 @@ namespace Solana
             {"signature", r.signature},
             {"slot", r.slot},
             {"blockTime", r.blockTime},
-            {"tx", r.tx.value_or(json(nullptr))},
+            {"tx", r.tx ? r.tx->parse() : json(nullptr)},
             {"swapTx", r.swapTx.has_value() ? json(*r.swapTx) : json(nullptr)}};
     }
 
@@ -7,6 +7,7 @@ namespace Solana
 {
     struct RequestAirdrop : public RpcMethod<RequestAirdrop>
     {
+        static constexpr bool idempotent = false;
 
         // Reply structure
 
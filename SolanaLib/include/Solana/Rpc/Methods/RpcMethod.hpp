@@ -3,6 +3,10 @@
 #include <iostream>
 #include "Solana/Rpc/Methods/Common.hpp"
 #include "Solana/Core/Types/Types.hpp"
+#include "Solana/Core/Encoding/JsonView.hpp"
+#include "Solana/Core/Encoding/RawJson.hpp"
+#include "Solana/Network/RpcError.hpp"
+#include <memory>
 
 using json = nlohmann::json;
 
@@ -15,6 +19,10 @@ namespace Solana
     template <typename Derived>
     struct RpcMethod
     {
+        // Reads can safely be sent twice (hedged to another endpoint); methods with
+        // side effects override this with false
+        static constexpr bool idempotent = true;
+
         json toJson() const
         {
             return static_cast<const Derived *>(this)->toJsonImpl();
@@ -31,22 +39,83 @@ namespace Solana
         }
     };
 
+    // Response body handed over by the transport; replies may keep views into it
+    using ReplyBody = std::shared_ptr<const std::string>;
+
+    // Opt-in fast paths for T::Reply: read the body in place with a JsonView, and
+    // optionally keep (a share of) the body itself so the reply can hold
+    // Encoding::RawJson views instead of copies
+    template <typename T>
+    concept ParsesReplyView = requires(const Encoding::JsonView &view) { T::parseReplyView(view); };
+
+    template <typename T>
+    concept ParsesOwnedReplyView = requires(const Encoding::JsonView &view, const ReplyBody &body) { T::parseReplyView(view, body); };
+
     template <typename T>
     struct RpcReply
     {
         std::string jsonrpc;
-        std::string id;
+        u64 id;
         typename T::Reply result;
 
+        // Methods that define parseReplyView read the body in place instead of
+        // through a json DOM
         static RpcReply<T> parse(std::string_view data)
         {
-            const auto j = json::parse(data);
+            if constexpr (ParsesOwnedReplyView<T>)
+            {
+                return parse(std::make_shared<const std::string>(data));
+            }
+            else if constexpr (ParsesReplyView<T>)
+            {
+                return fromView(Encoding::JsonView(data));
+            }
+            else
+            {
+                return fromJson(json::parse(data));
+            }
+        }
+
+        // Used by HttpClient, which moves the response body in rather than copying it
+        static RpcReply<T> parse(ReplyBody body)
+        {
+            if constexpr (ParsesOwnedReplyView<T>)
+            {
+                return fromView(Encoding::JsonView(*body), body);
+            }
+            else
+            {
+                return parse(std::string_view(*body));
+            }
+        }
+
+        static RpcReply<T> fromView(const Encoding::JsonView &view, const ReplyBody &body = nullptr)
+        {
+            RpcReply reply{};
+            for (const auto &[key, value] : view.members())
+            {
+                if (key == "error")
+                    throw Network::RpcError(std::string(value.raw()));
+                if (key == "jsonrpc")
+                    reply.jsonrpc = value.template get<std::string>();
+                else if (key == "id")
+                    reply.id = value.template get<u64>();
+            }
+            if constexpr (ParsesOwnedReplyView<T>)
+                reply.result = T::parseReplyView(view, body);
+            else
+                reply.result = T::parseReplyView(view);
+            return reply;
+        }
+
+        // Also used for the members of a batch reply array
+        static RpcReply<T> fromJson(const json &j)
+        {
             if (j.contains("error"))
-                throw std::runtime_error(
-                    "request error: " + j["error"].dump());
+                throw Network::RpcError(j["error"].dump());
             return RpcReply{
                 .jsonrpc = j["jsonrpc"],
-                .id = j["id"].get<std::string>(),
+                .id = j["id"].get<u64>(),
                 .result = T::parseReply(j)};
         }
     };
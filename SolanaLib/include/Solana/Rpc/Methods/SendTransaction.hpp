@@ -7,6 +7,7 @@ namespace Solana
 {
     struct SendTransaction : public RpcMethod<SendTransaction>
     {
+        static constexpr bool idempotent = false;
 
         // Reply structure
         using Reply = json;
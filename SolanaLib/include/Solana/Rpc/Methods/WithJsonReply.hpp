@@ -9,6 +9,8 @@ namespace Solana
     {
         using Reply = json;
 
+        static constexpr bool idempotent = T::idempotent;
+
         static Reply parseReply(const json &data)
         {
             return data["result"];
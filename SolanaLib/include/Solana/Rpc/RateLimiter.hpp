@@ -0,0 +1,329 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Solana/Logger.hpp"
+#include "Solana/Network/RequestOptions.hpp"
+
+namespace net = boost::asio;
+
+namespace Solana
+{
+    struct RateLimiterConfig
+    {
+        // Sustained budget in request units per second; 0 disables limiting
+        double unitsPerSecond = 0.0;
+        // Units that may be spent at once after an idle period
+        double burst = 10.0;
+        // Cost of a call in units by method name; anything not listed costs 1.
+        // Defaults follow how providers meter the heavy reads.
+        std::unordered_map<std::string, double> weights = {
+            {"getBlock", 10.0},
+            {"getTransaction", 2.0},
+            {"getProgramAccounts", 10.0},
+            {"getSignaturesForAddress", 2.0},
+        };
+        // Times an idempotent call the provider answered 429 is queued again behind
+        // the pause before its 429 is returned
+        std::size_t retries = 3;
+    };
+
+    struct RateLimiterStats
+    {
+        std::size_t granted = 0;
+        // Calls that had to wait for tokens or a pause, rather than starting at once
+        std::size_t delayed = 0;
+        std::size_t maxQueued = 0;
+        std::size_t pauses = 0;
+        // Queued calls dropped uncharged because they were cancelled or ran out of time
+        std::size_t abandoned = 0;
+        std::chrono::microseconds totalWait{0};
+        std::chrono::microseconds maxWait{0};
+    };
+
+    // Token bucket that paces calls to a provider's quota. Calls that find the
+    // bucket empty queue by priority (then arrival) and are started from a timer as
+    // tokens refill, so no thread sleeps while it waits. A 429 from the provider
+    // pauses the whole bucket for its Retry-After, and Rpc queues idempotent calls
+    // that got one again behind the pause. A queued call whose token is
+    // cancelled or whose deadline passes is dropped without being charged.
+    // acquire() may be called from any thread; the bucket lives on a strand.
+    class RateLimiter
+    {
+    public:
+        using Start = std::function<void()>;
+        // Told why a queued call was dropped: Error::Cancelled or Error::QueueTimeout
+        using Abandon = std::function<void(boost::system::error_code)>;
+
+        RateLimiter(std::shared_ptr<net::io_context> ioc, const RateLimiterConfig &config)
+            : ioc_(std::move(ioc)),
+              strand_(net::make_strand(*ioc_)),
+              timer_(strand_),
+              config_(config),
+              tokens_(std::max(config.burst, 1.0)),
+              refilled_(std::chrono::steady_clock::now())
+        {
+        }
+
+        double weight(const std::string &method) const
+        {
+            const auto it = config_.weights.find(method);
+            return it == config_.weights.end() ? 1.0 : it->second;
+        }
+
+        std::size_t retries() const { return config_.retries; }
+
+        // Runs start once `cost` units are available; higher priorities go first
+        void acquire(double cost, int priority, Start start)
+        {
+            enqueue(Waiter{.priority = priority, .cost = cost, .start = std::move(start)});
+        }
+
+        // Same, queued at options.priority. If options' token is cancelled or its
+        // deadline passes first, the call leaves the queue and abandon runs instead.
+        void acquire(double cost, const Network::RequestOptions &options, Start start, Abandon abandon)
+        {
+            enqueue(Waiter{.priority = options.priority,
+                           .cost = cost,
+                           .start = std::move(start),
+                           .deadline = options.anchored().deadline,
+                           .cancellation = options.cancellation,
+                           .abandon = std::move(abandon)});
+        }
+
+        // Stops granting until `duration` from now, e.g. for a Retry-After
+        void pause(std::chrono::milliseconds duration)
+        {
+            net::dispatch(strand_, [this, duration]()
+                          {
+                pausedUntil_ = std::max(pausedUntil_, std::chrono::steady_clock::now() + duration);
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ++stats_.pauses;
+                }
+                LOG_WARN("Rate limited by the provider, pausing requests for {}ms", duration.count());
+                drain(); });
+        }
+
+        RateLimiterStats stats() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return stats_;
+        }
+
+    private:
+        struct Waiter
+        {
+            int priority = 0;
+            std::uint64_t sequence = 0;
+            double cost = 1.0;
+            std::chrono::steady_clock::time_point queued;
+            Start start;
+            std::optional<std::chrono::steady_clock::time_point> deadline;
+            std::shared_ptr<Network::CancellationToken> cancellation;
+            Abandon abandon;
+            // Takes the waiter out of the queue as soon as the token is cancelled
+            Network::CancellationToken::Registration registration;
+
+            // Max-heap order: higher priority first, then earlier arrival
+            bool operator<(const Waiter &other) const
+            {
+                return priority != other.priority ? priority < other.priority : sequence > other.sequence;
+            }
+        };
+
+        double capacity() const { return std::max(config_.burst, 1.0); }
+
+        void refill(std::chrono::steady_clock::time_point now)
+        {
+            const std::chrono::duration<double> elapsed = now - refilled_;
+            tokens_ = std::min(capacity(), tokens_ + elapsed.count() * config_.unitsPerSecond);
+            refilled_ = now;
+        }
+
+        void enqueue(Waiter waiter)
+        {
+            net::dispatch(strand_, [this, waiter = std::move(waiter)]() mutable
+                          {
+                const auto now = std::chrono::steady_clock::now();
+                refill(now);
+                if (!queue_.empty() || now < pausedUntil_ || tokens_ < std::min(waiter.cost, capacity()))
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ++stats_.delayed;
+                }
+                waiter.sequence = sequence_++;
+                waiter.queued = now;
+                if (waiter.deadline)
+                {
+                    deadlines_.emplace(*waiter.deadline, waiter.sequence);
+                }
+                if (waiter.cancellation)
+                {
+                    // Already cancelled: the callback finds nothing queued yet, and
+                    // drain() drops the waiter instead
+                    waiter.registration = waiter.cancellation->onCancel([this, sequence = waiter.sequence]()
+                                                                        { net::dispatch(strand_, [this, sequence]()
+                                                                                        { cancel(sequence); }); });
+                }
+                queue_.push_back(std::move(waiter));
+                std::push_heap(queue_.begin(), queue_.end());
+                drain(); });
+        }
+
+        void cancel(std::uint64_t sequence)
+        {
+            auto waiter = take(sequence);
+            if (!waiter)
+            {
+                return;
+            }
+            abandon(*waiter, Network::Error::Cancelled);
+            // The front may have changed, and with it when the timer should fire
+            drain();
+        }
+
+        // Removes a waiter from anywhere in the queue
+        std::optional<Waiter> take(std::uint64_t sequence)
+        {
+            const auto it = std::find_if(queue_.begin(), queue_.end(), [sequence](const Waiter &waiter)
+                                         { return waiter.sequence == sequence; });
+            if (it == queue_.end())
+            {
+                return std::nullopt;
+            }
+            auto waiter = std::move(*it);
+            queue_.erase(it);
+            std::make_heap(queue_.begin(), queue_.end());
+            forget(waiter);
+            return waiter;
+        }
+
+        // Drops a waiter leaving the queue from deadlines_
+        void forget(const Waiter &waiter)
+        {
+            if (!waiter.deadline)
+            {
+                return;
+            }
+            const auto [first, last] = deadlines_.equal_range(*waiter.deadline);
+            const auto it = std::find_if(first, last, [&waiter](const auto &entry)
+                                         { return entry.second == waiter.sequence; });
+            if (it != last)
+            {
+                deadlines_.erase(it);
+            }
+        }
+
+        void abandon(Waiter &waiter, Network::Error error)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ++stats_.abandoned;
+            }
+            if (waiter.abandon)
+            {
+                waiter.abandon(error);
+            }
+        }
+
+        // Starts every waiter the bucket can pay for, then arms the timer for the next
+        void drain()
+        {
+            const auto now = std::chrono::steady_clock::now();
+            refill(now);
+            // Calls nobody waits for any more are dropped even while paused, and cost
+            // nothing. Expired ones go wherever they are in the queue, not only once
+            // they reach the front.
+            while (!deadlines_.empty() && deadlines_.begin()->first <= now)
+            {
+                const auto sequence = deadlines_.begin()->second;
+                deadlines_.erase(deadlines_.begin());
+                if (auto dropped = take(sequence))
+                {
+                    abandon(*dropped, Network::Error::QueueTimeout);
+                }
+            }
+            while (!queue_.empty())
+            {
+                // A token cancelled before its callback was registered
+                const auto &front = queue_.front();
+                if (front.cancellation && front.cancellation->cancelled())
+                {
+                    std::pop_heap(queue_.begin(), queue_.end());
+                    auto dropped = std::move(queue_.back());
+                    queue_.pop_back();
+                    forget(dropped);
+                    abandon(dropped, Network::Error::Cancelled);
+                    continue;
+                }
+                // A call heavier than the whole burst goes once the bucket is full and
+                // leaves it in debt, rather than never going at all
+                if (now < pausedUntil_ || tokens_ < std::min(front.cost, capacity()))
+                {
+                    break;
+                }
+                std::pop_heap(queue_.begin(), queue_.end());
+                auto next = std::move(queue_.back());
+                queue_.pop_back();
+                forget(next);
+                tokens_ -= next.cost;
+                const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(now - next.queued);
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ++stats_.granted;
+                    stats_.totalWait += waited;
+                    stats_.maxWait = std::max(stats_.maxWait, waited);
+                }
+                next.start();
+            }
+
+            if (queue_.empty())
+            {
+                return;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stats_.maxQueued = std::max(stats_.maxQueued, queue_.size());
+            }
+            const auto needed = std::min(queue_.front().cost, capacity()) - tokens_;
+            auto wakeAt = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(std::max(needed, 0.0) / config_.unitsPerSecond));
+            wakeAt = std::max(wakeAt, pausedUntil_);
+            if (!deadlines_.empty())
+            {
+                wakeAt = std::min(wakeAt, deadlines_.begin()->first);
+            }
+            timer_.expires_at(wakeAt);
+            timer_.async_wait([this](boost::system::error_code ec)
+                              {
+                if (!ec)
+                    drain(); });
+        }
+
+        // Keeps the io_context (and so the timer's service) alive for the timer's lifetime
+        std::shared_ptr<net::io_context> ioc_;
+        net::strand<net::io_context::executor_type> strand_;
+        net::steady_timer timer_;
+        RateLimiterConfig config_;
+        double tokens_;
+        std::chrono::steady_clock::time_point refilled_;
+        std::chrono::steady_clock::time_point pausedUntil_{};
+        // Binary max-heap of waiters
+        std::vector<Waiter> queue_;
+        // Sequence numbers of the waiters that have a deadline, earliest first
+        std::multimap<std::chrono::steady_clock::time_point, std::uint64_t> deadlines_;
+        std::uint64_t sequence_ = 0;
+        RateLimiterStats stats_;
+        mutable std::mutex mutex_;
+    };
+}
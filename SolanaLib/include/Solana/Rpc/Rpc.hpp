@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include "Solana/Network/EndpointGroup.hpp"
 #include "Solana/Network/HttpClient.hpp"
 #include "Solana/Network/WebSocket.hpp"
 #include "Solana/Rpc/Methods/GetBalance.hpp"
@@ -19,62 +20,400 @@
 #include "Solana/Rpc/Methods/SendTransaction.hpp"
 #include "Solana/Rpc/Methods/RequestAirdrop.hpp"
 #include "Solana/Rpc/Methods/WithJsonReply.hpp"
+#include "Solana/Rpc/BatchScheduler.hpp"
+#include "Solana/Rpc/InFlightTable.hpp"
+#include "Solana/Rpc/RateLimiter.hpp"
+#include "Solana/Rpc/SubscriptionManager.hpp"
+#include "Solana/Rpc/Subscriptions/AccountSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/LogsSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/ProgramSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/SlotSubscribe.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/use_awaitable.hpp>
 #include <thread>
 #include <shared_mutex>
-#include <condition_variable>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
 
 namespace Solana
 {
+    struct RpcConfig
+    {
+        // Requests packed into one JSON-RPC array body; sendBatch splits larger
+        // batches into several POSTs of at most this many calls
+        std::size_t maxBatchSize = 100;
+        // Opt-in micro-batching: concurrent send() calls made within batchWindow of
+        // each other go out as one batch POST, flushed early at maxBatchSize calls
+        bool autoBatch = false;
+        std::chrono::microseconds batchWindow{200};
+        // Idempotent reads are hedged across endpoints when Rpc is given more than one
+        Network::HedgeConfig hedge;
+        // Latency-aware routing and circuit breaking across those endpoints
+        Network::BalancerConfig balancer;
+        // Client-side pacing to the provider's quota; off unless unitsPerSecond is set
+        RateLimiterConfig rateLimit;
+        // Pub/sub endpoint for subscriptions(); every subscription shares this one
+        // socket, which is connected on its own thread when set. Its dispatch may
+        // use at most one worker.
+        std::optional<Network::WebSocketConfig> webSocket;
+    };
+
     class Rpc
     {
     public:
         static Rpc DefaultMainnet();
 
-        explicit Rpc(const std::string &endpoint)
-            : client(endpoint), wsThread(&Rpc::runWs, this)
+        explicit Rpc(const std::string &endpoint,
+                     const Network::HttpClientConfig &config = {},
+                     const RpcConfig &rpcConfig = {})
+            : Rpc(std::vector<std::string>{endpoint}, config, rpcConfig)
+        {
+        }
+
+        // Several providers serving the same cluster: requests are balanced towards
+        // the fastest healthy endpoint, failing ones are circuit-broken, and
+        // idempotent reads (see RpcMethod::idempotent) are hedged to a second
+        // endpoint when the first is slow to answer
+        explicit Rpc(const std::vector<std::string> &endpoints,
+                     const Network::HttpClientConfig &config = {},
+                     const RpcConfig &rpcConfig = {})
+            : client(endpoints, config, rpcConfig.hedge, rpcConfig.balancer),
+              maxBatchSize(std::max<std::size_t>(rpcConfig.maxBatchSize, 1))
         {
+            if (rpcConfig.rateLimit.unitsPerSecond > 0)
+            {
+                limiter = std::make_unique<RateLimiter>(client.context(), rpcConfig.rateLimit);
+                // With several endpoints the group already routes around one that
+                // answers 429; with one, everything has to wait out the Retry-After
+                if (client.size() == 1)
+                {
+                    client.onRateLimited([this](std::chrono::milliseconds pause)
+                                         { limiter->pause(pause); });
+                }
+            }
+            if (rpcConfig.autoBatch)
+            {
+                scheduler = std::make_unique<BatchScheduler>(client.context(), rpcConfig.batchWindow, maxBatchSize,
+                                                             [this](std::vector<PendingCall> &&calls)
+                                                             { postBatch(std::move(calls)); });
+            }
+            if (rpcConfig.webSocket)
+            {
+                startWs(*rpcConfig.webSocket);
+            }
         }
 
         ~Rpc();
 
         Rpc(const Rpc &other) = delete;
 
+        // With RpcConfig::autoBatch the request is coalesced with other concurrent
+        // sends into a batch; the returned future is the same either way.
         template <typename T>
         std::future<RpcReply<T>> send(const T &req)
+        {
+            if (scheduler)
+            {
+                auto [call, future] = makeCall(req);
+                scheduler->add(std::move(call));
+                return std::move(future);
+            }
+            return send(req, Network::RequestOptions{});
+        }
+
+        // Sends with its own deadline, cancellation token or rate-limiter priority.
+        // Always a single POST, bypassing auto-batching, since calls sharing a batch
+        // share its fate. Time spent queued by the rate limiter counts against the
+        // deadline.
+        template <typename T>
+        std::future<RpcReply<T>> send(const T &req, Network::RequestOptions options)
+        {
+            options.idempotent = T::idempotent;
+            options = options.anchored();
+            auto promise = std::make_shared<std::promise<RpcReply<T>>>();
+            auto future = promise->get_future();
+            post<T>(makeRequest(req, nextId()), cost(req.methodName()), std::move(options),
+                    [promise](std::exception_ptr ex, RpcReply<T> reply)
+                    {
+                        if (ex)
+                            promise->set_exception(ex);
+                        else
+                            promise->set_value(std::move(reply));
+                    });
+            return future;
+        }
+
+        // Sends all requests as JSON-RPC batches (one POST per maxBatchSize calls).
+        // Each request gets its own id and future; an error reply for one call only
+        // fails that call's future.
+        template <typename T>
+        std::vector<std::future<RpcReply<T>>> sendBatch(const std::vector<T> &reqs)
+        {
+            std::vector<PendingCall> calls;
+            std::vector<std::future<RpcReply<T>>> futures;
+            calls.reserve(reqs.size());
+            futures.reserve(reqs.size());
+            for (const auto &req : reqs)
+            {
+                auto [call, future] = makeCall(req);
+                calls.push_back(std::move(call));
+                futures.push_back(std::move(future));
+            }
+            postBatch(std::move(calls));
+            return futures;
+        }
+
+        // Mixed-method batch, e.g. sendBatch(GetBalance(a), GetAccountInfo<>(b))
+        template <typename... Ts>
+        std::tuple<std::future<RpcReply<Ts>>...> sendBatch(const Ts &...reqs)
+        {
+            std::vector<PendingCall> calls;
+            calls.reserve(sizeof...(Ts));
+            // Braced initialisation keeps the calls in argument order
+            std::tuple<std::future<RpcReply<Ts>>...> futures{enqueue(reqs, calls)...};
+            postBatch(std::move(calls));
+            return futures;
+        }
+
+        // Non-blocking counterpart of send(). With the default token this is
+        // co_await-able from any coroutine (net::awaitable<RpcReply<T>>) and
+        // rethrows RPC/transport errors; any other completion token works too,
+        // e.g. a callback taking (std::exception_ptr, RpcReply<T>).
+        template <typename T, typename CompletionToken = net::use_awaitable_t<>>
+        auto asyncSend(const T &req, CompletionToken &&token = {})
+        {
+            return asyncSend(req, Network::RequestOptions{}, std::forward<CompletionToken>(token));
+        }
+
+        template <typename T, typename CompletionToken = net::use_awaitable_t<>>
+        auto asyncSend(const T &req, Network::RequestOptions options, CompletionToken &&token = {})
+        {
+            options.idempotent = T::idempotent;
+            return net::async_initiate<CompletionToken, void(std::exception_ptr, RpcReply<T>)>(
+                [this](auto handler, json request, double cost, Network::RequestOptions options)
+                {
+                    // Bound here rather than by the client, so cancelling also takes the
+                    // call out of the rate limiter's queue
+                    auto slot = net::get_associated_cancellation_slot(handler);
+                    if (slot.is_connected())
+                    {
+                        if (!options.cancellation)
+                        {
+                            options.cancellation = std::make_shared<Network::CancellationToken>();
+                        }
+                        slot.assign([cancellation = options.cancellation](net::cancellation_type)
+                                    { cancellation->cancel(); });
+                    }
+                    post<T>(std::move(request), cost, std::move(options),
+                            Network::bindCompletion<RpcReply<T>>(std::move(handler), client.context()->get_executor()));
+                },
+                token, makeRequest(req, nextId()), cost(req.methodName()), options.anchored());
+        }
+
+        // Flush sizes and coalescing delay of the auto-batching scheduler (all zero when it is off)
+        BatchSchedulerStats batchStats() const
+        {
+            return scheduler ? scheduler->stats() : BatchSchedulerStats{};
+        }
+
+        // Queueing under RpcConfig::rateLimit (all zero when it is off)
+        RateLimiterStats rateLimitStats() const
+        {
+            return limiter ? limiter->stats() : RateLimiterStats{};
+        }
+
+        // Per-endpoint latency and hedging counters, in the order the endpoints were given
+        std::vector<Network::EndpointStats> endpointStats() const { return client.stats(); }
+
+        // Subscriptions over RpcConfig::webSocket, e.g.
+        // subscriptions().subscribe(AccountSubscribe(pubkey), [](const AccountSubscribe::Notification &n) { ... }).
+        // Throws std::logic_error when no WebSocket endpoint was configured.
+        SubscriptionManager &subscriptions()
+        {
+            if (!manager)
+            {
+                throw std::logic_error("Rpc has no WebSocket endpoint; set RpcConfig::webSocket");
+            }
+            return *manager;
+        }
+
+        // Calls handler with each slotNotification; resolves to the handle
+        // removeSubscription() takes
+        std::future<u64> onSlot(std::function<void(const SlotSubscribe::Notification &)> handler)
+        {
+            return subscriptions().subscribe(SlotSubscribe(), std::move(handler));
+        }
+
+        std::future<bool> removeSubscription(u64 handle)
+        {
+            return subscriptions().unsubscribe(handle);
+        }
+
+        // Reconnects and p50/p99 time to recover on the subscription socket
+        Network::WebSocketStats webSocketStats() const
+        {
+            return ws ? ws->stats() : Network::WebSocketStats{};
+        }
+
+    private:
+        // Raw batch reply; members are matched back to their calls by id
+        struct BatchReply
+        {
+            json replies;
+
+            static BatchReply parse(std::string_view body)
+            {
+                return BatchReply{.replies = json::parse(body)};
+            }
+        };
+
+        template <typename T>
+        std::pair<PendingCall, std::future<RpcReply<T>>> makeCall(const T &req)
+        {
+            auto promise = std::make_shared<std::promise<RpcReply<T>>>();
+            auto future = promise->get_future();
+            auto call = PendingCall{
+                .request = makeRequest(req, nextId()),
+                .resolve = [promise](std::exception_ptr ex, const json &reply)
+                {
+                    if (ex)
+                    {
+                        promise->set_exception(ex);
+                        return;
+                    }
+                    try
+                    {
+                        promise->set_value(RpcReply<T>::fromJson(reply));
+                    }
+                    catch (...)
+                    {
+                        promise->set_exception(std::current_exception());
+                    }
+                }};
+            return {std::move(call), std::move(future)};
+        }
+
+        template <typename T>
+        std::future<RpcReply<T>> enqueue(const T &req, std::vector<PendingCall> &calls)
+        {
+            auto [call, future] = makeCall(req);
+            calls.push_back(std::move(call));
+            return std::move(future);
+        }
+
+        void postBatch(std::vector<PendingCall> &&calls);
+
+        // Rate-limiter units a call to `method` costs
+        double cost(const std::string &method) const
+        {
+            return limiter ? limiter->weight(method) : 1.0;
+        }
+
+        // Runs start now, or once the rate limiter has budget for `cost`. If the
+        // call is cancelled or its deadline passes while queued, fail gets the error
+        // instead and the call costs nothing.
+        template <typename Start, typename Fail>
+        void throttled(double cost, const Network::RequestOptions &options, Start &&start, Fail &&fail)
+        {
+            if (!limiter)
+            {
+                start();
+                return;
+            }
+            limiter->acquire(cost, options, std::forward<Start>(start),
+                             [fail = std::forward<Fail>(fail)](boost::system::error_code ec)
+                             { fail(std::make_exception_ptr(boost::system::system_error(ec, "rate limiter"))); });
+        }
+
+        // A single call through the rate limiter. With one endpoint a 429 also pauses
+        // the limiter (see the constructor), so an idempotent call that got one is
+        // queued again behind that pause, within its deadline and up to
+        // RateLimiterConfig::retries times; with several, the retry goes to
+        // whichever endpoint is not rate limiting.
+        template <typename T>
+        void post(json request, double cost, Network::RequestOptions options, Network::Completion<RpcReply<T>> done, std::size_t attempt = 0)
+        {
+            auto fail = [done](std::exception_ptr ex)
+            { done(ex, RpcReply<T>{}); };
+            throttled(cost, options,
+                      [this, request = std::move(request), cost, options, done = std::move(done), attempt]()
+                      {
+                          client.asyncPost<RpcReply<T>>(request, options, [this, request, cost, options, done, attempt](std::exception_ptr ex, RpcReply<T> reply)
+                                                        {
+                              if (ex && requeue(ex, options, attempt))
+                              {
+                                  LOG_WARN("Queueing rate-limited {} again (retry {})", request["method"].get<std::string>(), attempt + 1);
+                                  post<T>(request, cost, options, done, attempt + 1);
+                                  return;
+                              }
+                              done(ex, std::move(reply)); });
+                      },
+                      std::move(fail));
+        }
+
+        // Whether a call that failed with ex should go back to the rate limiter
+        bool requeue(std::exception_ptr ex, const Network::RequestOptions &options, std::size_t attempt) const
+        {
+            if (!limiter || !options.idempotent || attempt >= limiter->retries() ||
+                (options.cancellation && options.cancellation->cancelled()) ||
+                (options.deadline && std::chrono::steady_clock::now() >= *options.deadline))
+            {
+                return false;
+            }
+            try
+            {
+                std::rethrow_exception(ex);
+            }
+            catch (const Network::HttpStatusError &e)
+            {
+                return e.rateLimited();
+            }
+            catch (...)
+            {
+                return false;
+            }
+        }
+
+        void resolveBatch(const std::vector<u64> &ids, std::exception_ptr ex, const json &replies);
+
+        // Unique for the lifetime of this Rpc, so replies can be routed by id alone
+        u64 nextId() { return requestCounter.fetch_add(1, std::memory_order_relaxed); }
+
+        template <typename T>
+        static json makeRequest(const T &req, u64 id)
         {
             auto j = json();
 
             j["jsonrpc"] = "2.0";
-            j["id"] = "1";
+            j["id"] = id;
             j["method"] = req.methodName();
             if (req.hasParams())
                 j["params"] = req.toJson();
 
-#if !NDEBUG
-#include <iostream>
-            std::cout << "SENDING: " << j.dump() << "\n";
-#endif
-            std::cout << "SENDING: " << j.dump() << "\n";
-            auto res = client.post<RpcReply<T>>(j);
-            return res;
+            LOG_INFO("SENDING: {}", j.dump());
+            return j;
         }
 
-        // std::future<int> onSlot(MessageHandler &&handler);
-        // std::future<bool> removeSubscription(int subId);
-
-    private:
-        void runWs();
-        // std::future<int> createSubscription(
-        //     const json &message,
-        //     MessageHandler &&handler);
+        void startWs(const Network::WebSocketConfig &config);
 
     private:
-        Network::HttpClient client;
+        // Declared ahead of the client so they outlive it: the client's destructor stops
+        // the IO threads before the timers, queued calls and in-flight batches go away
+        std::unique_ptr<BatchScheduler> scheduler;
+        std::unique_ptr<RateLimiter> limiter;
+        // Batched calls awaiting their member of a reply array
+        InFlightTable<std::function<void(std::exception_ptr, const json &)>> inFlight;
+        Network::EndpointGroup client;
+        std::size_t maxBatchSize;
+        std::atomic<u64> requestCounter = 1;
+        // Subscription socket, only set up with RpcConfig::webSocket
+        std::unique_ptr<net::io_context> wsContext;
+        std::unique_ptr<ssl::context> wsTls;
         std::shared_ptr<Network::WebSocket> ws;
+        std::unique_ptr<SubscriptionManager> manager;
         std::thread wsThread;
-        std::mutex wsMutex;
-        std::condition_variable cv;
-        std::atomic_bool ready = false;
     };
 }
@@ -0,0 +1,482 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "Solana/Core/Encoding/JsonView.hpp"
+#include "Solana/Core/Types/Types.hpp"
+#include "Solana/Logger.hpp"
+#include "Solana/Rpc/Subscriptions/RpcSubscription.hpp"
+
+using json = nlohmann::json;
+
+namespace Solana
+{
+    struct SubscriptionStats
+    {
+        std::size_t active = 0;
+        // Subscribe and unsubscribe requests awaiting their reply
+        std::size_t pending = 0;
+        std::size_t notifications = 0;
+        // Notifications for a subscription id we do not know, e.g. one that arrived
+        // just after its unsubscribe was sent
+        std::size_t unrouted = 0;
+        // Reconnects after which every subscription was sent again
+        std::size_t replays = 0;
+        std::size_t gaps = 0;
+    };
+
+    // Slots a subscription may have missed while its socket was down: everything
+    // after the last notification before the drop and before the first one after
+    // it. Notifications only carry the slot they were produced in, so the range is
+    // an upper bound; backfill it over HTTP (e.g. getSignaturesForAddress or
+    // getAccountInfo with minContextSlot).
+    struct SubscriptionGap
+    {
+        u64 handle = 0;
+        std::string method;
+        u64 firstSlot = 0;
+        u64 lastSlot = 0;
+    };
+
+    // JSON-RPC pub/sub over one WebSocket: sends *Subscribe requests with unique
+    // ids, maps the subscription ids the server returns to handlers, and routes
+    // *Notification messages to them with a single hash lookup. Messages are read
+    // in place with a JsonView, so routing builds no DOM; handlers get a view of
+    // `params.result` that is valid for the duration of the call.
+    //
+    // The manager only formats and routes messages: `send` puts a text frame on the
+    // socket and every frame read from it goes to onMessage(). Callers keep the
+    // handle subscribe() resolves to; it stays valid for the subscription's lifetime,
+    // across reconnects (see replay()). Thread-safe; handlers run on the thread that
+    // calls onMessage().
+    class SubscriptionManager
+    {
+    public:
+        using Send = std::function<void(std::string)>;
+        using Handler = std::function<void(const Encoding::JsonView &result)>;
+        using GapHandler = std::function<void(const SubscriptionGap &gap)>;
+        // The server's answer to a subscribe: error is null once it is confirmed
+        using Confirmed = std::function<void(u64 handle, std::exception_ptr error)>;
+
+        explicit SubscriptionManager(Send send) : send_(std::move(send)) {}
+
+        // e.g. subscribe("logsSubscribe", {{{"mentions", {program}}}, {{"commitment", "confirmed"}}}, handler).
+        // Resolves to the subscription's handle once the server confirms it, or to
+        // the server's error.
+        std::future<u64> subscribe(const std::string &method, json params, Handler handler)
+        {
+            auto promise = std::make_shared<std::promise<u64>>();
+            auto future = promise->get_future();
+            subscribe(method, std::move(params), std::move(handler), [promise](u64 handle, std::exception_ptr error)
+                      {
+                if (error)
+                    promise->set_exception(error);
+                else
+                    promise->set_value(handle); });
+            return future;
+        }
+
+        // Same, but returns the handle at once and reports the server's answer to
+        // confirmed, on the thread that calls onMessage()
+        u64 subscribe(const std::string &method, json params, Handler handler, Confirmed confirmed)
+        {
+            auto entry = std::make_shared<Entry>(Entry{method, std::move(params), std::move(handler), std::move(confirmed)});
+
+            std::string message;
+            u64 handle = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto id = nextId_++;
+                // The first request id doubles as the handle, so handles never collide
+                entry->handle = handle = id;
+                entries_.emplace(id, entry);
+                message = subscribeRequest(id, entry);
+            }
+            send_(std::move(message));
+            return handle;
+        }
+
+        // Typed form, e.g. subscribe(LogsSubscribe(program), [](const LogsSubscribe::Notification &n) { ... }):
+        // each notification is decoded from the frame straight into T::Notification
+        template <typename T>
+        std::future<u64> subscribe(const RpcSubscription<T> &subscription,
+                                   std::function<void(const typename T::Notification &)> handler)
+        {
+            return subscribe(subscription.methodName(),
+                             subscription.hasParams() ? subscription.toJson() : json(nullptr),
+                             [handler = std::move(handler)](const Encoding::JsonView &result)
+                             { handler(T::parseNotification(result)); });
+        }
+
+        // Stops routing to the handler at once; resolves to the server's answer
+        std::future<bool> unsubscribe(u64 handle)
+        {
+            auto promise = std::make_shared<std::promise<bool>>();
+            auto future = promise->get_future();
+
+            std::string message;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto it = entries_.find(handle);
+                if (it == entries_.end())
+                {
+                    promise->set_exception(std::make_exception_ptr(std::invalid_argument("unknown subscription " + std::to_string(handle))));
+                    return future;
+                }
+                auto entry = it->second;
+                entries_.erase(it);
+                if (!entry->subscription)
+                {
+                    // Not confirmed yet; confirm() unsubscribes it when the reply arrives
+                    promise->set_value(true);
+                    return future;
+                }
+                active_.erase(*entry->subscription);
+                message = unsubscribeRequest(*entry, [promise](const Encoding::JsonView *reply)
+                                             {
+                    if (!reply)
+                    {
+                        // The subscription went with the connection
+                        promise->set_value(true);
+                        return;
+                    }
+                    resolve(*promise, *reply, [](const Encoding::JsonView &result)
+                            { return result.get<bool>(); }); });
+            }
+            send_(std::move(message));
+            return future;
+        }
+
+        // Routes one text frame from the socket: a message, or the array of replies
+        // to a batch of requests (see WebSocketConfig::writeBatch)
+        void onMessage(std::string_view message)
+        {
+            try
+            {
+                const Encoding::JsonView view(message);
+                if (view.isArray())
+                {
+                    for (const auto &element : view.elements())
+                    {
+                        route(element);
+                    }
+                    return;
+                }
+                route(view);
+            }
+            catch (const std::exception &e)
+            {
+                LOG_ERROR("Failed to route WebSocket message: {}", e.what());
+            }
+        }
+
+        // Sends every subscription again under a new request id. Call once a
+        // replacement connection is up: the server forgot them along with the old
+        // one. Handles stay the same, and requests still waiting for a reply are
+        // settled (an unsubscribe has nothing left to undo).
+        void replay()
+        {
+            std::vector<std::string> messages;
+            std::unordered_map<u64, Resolve> orphaned;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                orphaned.swap(pending_);
+                active_.clear();
+                messages.reserve(entries_.size());
+                for (const auto &[handle, entry] : entries_)
+                {
+                    entry->subscription.reset();
+                    entry->resumed = true;
+                    messages.push_back(subscribeRequest(nextId_++, entry));
+                }
+                ++stats_.replays;
+            }
+            LOG_INFO("Resubscribing {} subscriptions", messages.size());
+            for (auto &[id, resolve] : orphaned)
+            {
+                resolve(nullptr);
+            }
+            for (auto &message : messages)
+            {
+                send_(std::move(message));
+            }
+        }
+
+        // Called before the first notification after a reconnect when slots may
+        // have been missed
+        void onGap(GapHandler handler)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            gapHandler_ = std::move(handler);
+        }
+
+        // Slot of the newest notification routed to handle, if any carried one
+        std::optional<u64> lastSlot(u64 handle) const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const auto it = entries_.find(handle);
+            if (it == entries_.end() || it->second->lastSlot == 0)
+            {
+                return std::nullopt;
+            }
+            return it->second->lastSlot;
+        }
+
+        std::size_t size() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+
+        SubscriptionStats stats() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto result = stats_;
+            result.active = active_.size();
+            result.pending = pending_.size();
+            return result;
+        }
+
+    private:
+        // Called with the reply, or with nullptr when the connection it was sent on
+        // is gone
+        using Resolve = std::function<void(const Encoding::JsonView *)>;
+
+        struct Entry
+        {
+            std::string method;
+            json params;
+            Handler handler;
+            // Until the first confirmation
+            Confirmed confirmed;
+            u64 handle = 0;
+            // Server-assigned id, once the subscribe is confirmed
+            std::optional<u64> subscription;
+            u64 lastSlot = 0;
+            // Replayed and no notification seen since
+            bool resumed = false;
+        };
+
+        static std::string request(u64 id, const std::string &method, const json &params)
+        {
+            json j{{"jsonrpc", "2.0"}, {"id", id}, {"method", method}};
+            if (!params.is_null())
+            {
+                j["params"] = params;
+            }
+            return j.dump();
+        }
+
+        // Caller holds mutex_
+        std::string subscribeRequest(u64 id, const std::shared_ptr<Entry> &entry)
+        {
+            pending_.emplace(id, [this, entry](const Encoding::JsonView *reply)
+                             {
+                if (reply)
+                    confirm(entry, *reply); });
+            return request(id, entry->method, entry->params);
+        }
+
+        // logsSubscribe -> logsUnsubscribe. Caller holds mutex_.
+        std::string unsubscribeRequest(const Entry &entry, Resolve resolve)
+        {
+            const auto id = nextId_++;
+            pending_.emplace(id, std::move(resolve));
+            auto method = entry.method;
+            const std::string_view suffix = "Subscribe";
+            if (method.ends_with(suffix))
+            {
+                method.replace(method.size() - suffix.size(), suffix.size(), "Unsubscribe");
+            }
+            return request(id, method, json::array({*entry.subscription}));
+        }
+
+        // Sets the promise from a reply's result, or its error
+        template <typename T, typename Read>
+        static void resolve(std::promise<T> &promise, const Encoding::JsonView &reply, Read read)
+        {
+            try
+            {
+                if (const auto error = reply["error"]; !error.isNull())
+                {
+                    throw std::runtime_error("subscription request failed: " + std::string(error.raw()));
+                }
+                promise.set_value(read(reply["result"]));
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        void confirm(const std::shared_ptr<Entry> &entry, const Encoding::JsonView &reply)
+        {
+            std::optional<u64> subscription;
+            try
+            {
+                if (reply["error"].isNull())
+                {
+                    subscription = reply["result"].get<u64>();
+                }
+            }
+            catch (const std::exception &)
+            {
+            }
+
+            std::string message;
+            Confirmed confirmed;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                confirmed = std::move(entry->confirmed);
+                const auto it = entries_.find(entry->handle);
+                const bool wanted = it != entries_.end() && it->second == entry;
+                if (!subscription)
+                {
+                    if (wanted)
+                    {
+                        entries_.erase(it);
+                    }
+                }
+                else if (wanted)
+                {
+                    entry->subscription = subscription;
+                    active_[*subscription] = entry;
+                }
+                else
+                {
+                    // Unsubscribed while the subscribe was in flight
+                    entry->subscription = subscription;
+                    message = unsubscribeRequest(*entry, [](const Encoding::JsonView *) {});
+                }
+            }
+            if (!message.empty())
+            {
+                send_(std::move(message));
+            }
+            if (confirmed)
+            {
+                std::exception_ptr error;
+                if (!subscription)
+                {
+                    const auto answer = reply["error"].isNull() ? reply.raw() : reply["error"].raw();
+                    error = std::make_exception_ptr(std::runtime_error("subscription request failed: " + std::string(answer)));
+                }
+                confirmed(entry->handle, error);
+            }
+            else if (!subscription)
+            {
+                LOG_ERROR("Resubscribing {} failed: {}", entry->method, reply["error"].raw());
+            }
+        }
+
+        void route(const Encoding::JsonView &message)
+        {
+            if (const auto params = message["params"]; params.exists())
+            {
+                notify(params);
+                return;
+            }
+            if (const auto id = message["id"]; !id.isNull())
+            {
+                reply(id.get<u64>(), message);
+            }
+        }
+
+        // context.slot of account, logs, program and signature notifications; slot
+        // of slot notifications
+        static std::optional<u64> slotOf(const Encoding::JsonView &result)
+        {
+            if (!result.isObject())
+            {
+                return std::nullopt;
+            }
+            if (const auto context = result["context"]; context.isObject())
+            {
+                return context["slot"].get<u64>();
+            }
+            if (const auto slot = result["slot"]; slot.exists())
+            {
+                return slot.get<u64>();
+            }
+            return std::nullopt;
+        }
+
+        void notify(const Encoding::JsonView &params)
+        {
+            const auto subscription = params["subscription"].get<u64>();
+            const auto result = params["result"];
+            const auto slot = slotOf(result);
+            std::shared_ptr<Entry> entry;
+            std::optional<SubscriptionGap> gap;
+            GapHandler onGap;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto it = active_.find(subscription);
+                if (it == active_.end())
+                {
+                    ++stats_.unrouted;
+                    return;
+                }
+                ++stats_.notifications;
+                entry = it->second;
+                if (slot)
+                {
+                    if (entry->resumed && entry->lastSlot != 0 && *slot > entry->lastSlot + 1)
+                    {
+                        gap = SubscriptionGap{entry->handle, entry->method, entry->lastSlot + 1, *slot - 1};
+                        ++stats_.gaps;
+                        onGap = gapHandler_;
+                    }
+                    entry->resumed = false;
+                    entry->lastSlot = std::max(entry->lastSlot, *slot);
+                }
+            }
+            if (gap)
+            {
+                LOG_WARN("{} {} may have missed slots {}-{}", gap->method, gap->handle, gap->firstSlot, gap->lastSlot);
+                if (onGap)
+                {
+                    onGap(*gap);
+                }
+            }
+            entry->handler(result);
+        }
+
+        void reply(u64 id, const Encoding::JsonView &view)
+        {
+            Resolve resolve;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto it = pending_.find(id);
+                if (it == pending_.end())
+                {
+                    LOG_WARN("WebSocket reply for unknown request id {}", id);
+                    return;
+                }
+                resolve = std::move(it->second);
+                pending_.erase(it);
+            }
+            resolve(&view);
+        }
+
+        Send send_;
+        // By handle, for unsubscribe
+        std::unordered_map<u64, std::shared_ptr<Entry>> entries_;
+        // By server subscription id, for routing notifications
+        std::unordered_map<u64, std::shared_ptr<Entry>> active_;
+        std::unordered_map<u64, Resolve> pending_;
+        u64 nextId_ = 1;
+        SubscriptionStats stats_;
+        GapHandler gapHandler_;
+        mutable std::mutex mutex_;
+    };
+}
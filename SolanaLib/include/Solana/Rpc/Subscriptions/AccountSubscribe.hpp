@@ -0,0 +1,114 @@
+#pragma once
+
+#include "RpcSubscription.hpp"
+#include <string>
+#include <string_view>
+#include "Solana/Rpc/Methods/Common.hpp"
+#include "Solana/Core/Types/Types.hpp"
+
+namespace Solana
+{
+    // An account as pushed by accountNotification and programNotification
+    struct AccountState
+    {
+        u64 lamports = 0;
+        std::string owner;
+        // base58/base64 text for those encodings, or the raw JSON of a jsonParsed value
+        std::string data;
+        std::string encoding;
+        bool executable = false;
+        u64 rentEpoch = 0;
+        u64 space = 0;
+
+        static AccountState parse(const Encoding::JsonView &value)
+        {
+            AccountState account;
+            for (const auto &[key, v] : value.members())
+            {
+                if (key == "lamports")
+                    account.lamports = v.get<u64>();
+                else if (key == "owner")
+                    account.owner = v.get<std::string>();
+                else if (key == "executable")
+                    account.executable = v.get<bool>();
+                else if (key == "rentEpoch")
+                    account.rentEpoch = v.get<u64>();
+                else if (key == "space")
+                    account.space = v.get<u64>();
+                else if (key == "data")
+                {
+                    if (v.isArray())
+                    {
+                        account.data = v[0].get<std::string>();
+                        account.encoding = v[1].get<std::string>();
+                    }
+                    else if (v.isString())
+                    {
+                        // Legacy binary encoding
+                        account.data = v.get<std::string>();
+                        account.encoding = "base58";
+                    }
+                    else
+                    {
+                        account.data = v.raw();
+                        account.encoding = "jsonParsed";
+                    }
+                }
+            }
+            return account;
+        }
+    };
+
+    struct AccountSubscribe : RpcSubscription<AccountSubscribe>
+    {
+        static constexpr std::string_view notification = "accountNotification";
+
+        struct Notification
+        {
+            u64 slot = 0;
+            AccountState account;
+        };
+
+        static Notification parseNotification(const Encoding::JsonView &result)
+        {
+            Notification n;
+            for (const auto &[key, value] : result.members())
+            {
+                if (key == "context")
+                    n.slot = value["slot"].get<u64>();
+                else if (key == "value" && !value.isNull())
+                    n.account = AccountState::parse(value);
+            }
+            return n;
+        }
+
+        struct Config
+        {
+            Commitment commitment;
+            AccountEncoding encoding;
+        };
+
+        explicit AccountSubscribe(const std::string &address, const Config &config = {})
+            : key(address), config(config) {}
+
+        std::string methodNameImpl() const { return "accountSubscribe"; }
+
+        std::string shardKeyImpl() const { return key; }
+
+        json toJsonImpl() const
+        {
+            auto ob = json::object();
+            config.encoding.addToJson(ob);
+            config.commitment.addToJson(ob);
+            return json::array({key, ob});
+        }
+
+        bool hasParamsImpl() const
+        {
+            return true;
+        }
+
+        std::string key;
+        Config config = {};
+    };
+}
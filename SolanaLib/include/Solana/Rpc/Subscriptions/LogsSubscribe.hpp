@@ -0,0 +1,108 @@
+#pragma once
+
+#include "RpcSubscription.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Solana/Rpc/Methods/Common.hpp"
+#include "Solana/Core/Types/Types.hpp"
+
+namespace Solana
+{
+    enum class LogsFilter
+    {
+        // Every transaction except simple votes
+        All,
+        AllWithVotes,
+        // Transactions that mention LogsSubscribe::address
+        Mentions,
+    };
+
+    struct LogsSubscribe : RpcSubscription<LogsSubscribe>
+    {
+        static constexpr std::string_view notification = "logsNotification";
+
+        struct Notification
+        {
+            u64 slot = 0;
+            std::string signature;
+            // Raw JSON of the transaction error, e.g. {"InstructionError":[0,{"Custom":6001}]};
+            // empty when the transaction succeeded
+            std::string err;
+            std::vector<std::string> logs;
+
+            bool failed() const { return !err.empty(); }
+        };
+
+        static Notification parseNotification(const Encoding::JsonView &result)
+        {
+            Notification n;
+            for (const auto &[key, value] : result.members())
+            {
+                if (key == "context")
+                {
+                    n.slot = value["slot"].get<u64>();
+                }
+                else if (key == "value")
+                {
+                    for (const auto &[field, v] : value.members())
+                    {
+                        if (field == "signature")
+                            n.signature = v.get<std::string>();
+                        else if (field == "err" && !v.isNull())
+                            n.err = v.raw();
+                        else if (field == "logs")
+                            for (const auto &line : v.elements())
+                                n.logs.push_back(line.get<std::string>());
+                    }
+                }
+            }
+            return n;
+        }
+
+        struct Config
+        {
+            Commitment commitment;
+        };
+
+        explicit LogsSubscribe(LogsFilter filter = LogsFilter::All, const Config &config = {})
+            : filter(filter), config(config) {}
+
+        // Transactions mentioning address (a program or account)
+        explicit LogsSubscribe(const std::string &address, const Config &config = {})
+            : filter(LogsFilter::Mentions), address(address), config(config) {}
+
+        std::string methodNameImpl() const { return "logsSubscribe"; }
+
+        std::string shardKeyImpl() const { return filter == LogsFilter::Mentions ? address : methodNameImpl(); }
+
+        json toJsonImpl() const
+        {
+            json f;
+            switch (filter)
+            {
+            case LogsFilter::All:
+                f = "all";
+                break;
+            case LogsFilter::AllWithVotes:
+                f = "allWithVotes";
+                break;
+            case LogsFilter::Mentions:
+                f = {{"mentions", json::array({address})}};
+                break;
+            }
+            auto ob = json::object();
+            config.commitment.addToJson(ob);
+            return json::array({f, ob});
+        }
+
+        bool hasParamsImpl() const
+        {
+            return true;
+        }
+
+        LogsFilter filter;
+        std::string address;
+        Config config = {};
+    };
+}
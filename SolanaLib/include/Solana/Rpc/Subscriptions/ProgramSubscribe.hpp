@@ -0,0 +1,79 @@
+#pragma once
+
+#include "RpcSubscription.hpp"
+#include "AccountSubscribe.hpp"
+#include <string>
+#include <string_view>
+#include "Solana/Rpc/Methods/Common.hpp"
+#include "Solana/Core/Types/Types.hpp"
+
+namespace Solana
+{
+    // Changes to any account owned by a program
+    struct ProgramSubscribe : RpcSubscription<ProgramSubscribe>
+    {
+        static constexpr std::string_view notification = "programNotification";
+
+        struct Notification
+        {
+            u64 slot = 0;
+            std::string pubkey;
+            AccountState account;
+        };
+
+        static Notification parseNotification(const Encoding::JsonView &result)
+        {
+            Notification n;
+            for (const auto &[key, value] : result.members())
+            {
+                if (key == "context")
+                {
+                    n.slot = value["slot"].get<u64>();
+                }
+                else if (key == "value")
+                {
+                    for (const auto &[field, v] : value.members())
+                    {
+                        if (field == "pubkey")
+                            n.pubkey = v.get<std::string>();
+                        else if (field == "account")
+                            n.account = AccountState::parse(v);
+                    }
+                }
+            }
+            return n;
+        }
+
+        struct Config
+        {
+            Commitment commitment;
+            AccountEncoding encoding;
+            // e.g. json::array({{{"dataSize", 165}}}); every filter must match
+            RPCPARAM(json, filters);
+        };
+
+        explicit ProgramSubscribe(const std::string &programId, const Config &config = {})
+            : programId(programId), config(config) {}
+
+        std::string methodNameImpl() const { return "programSubscribe"; }
+
+        std::string shardKeyImpl() const { return programId; }
+
+        json toJsonImpl() const
+        {
+            auto ob = json::object();
+            config.encoding.addToJson(ob);
+            config.commitment.addToJson(ob);
+            config.filters.addToJson(ob);
+            return json::array({programId, ob});
+        }
+
+        bool hasParamsImpl() const
+        {
+            return true;
+        }
+
+        std::string programId;
+        Config config = {};
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <string_view>
+#include "nlohmann/json.hpp"
+#include "Solana/Core/Encoding/JsonView.hpp"
+#include "Solana/Core/Types/Types.hpp"
+#include "Solana/Rpc/Methods/Common.hpp"
+
+using json = nlohmann::json;
+
+namespace Solana
+{
+    template <typename T>
+    concept HasShardKey = requires(const T &subscription) { subscription.shardKeyImpl(); };
+
+    // Pub/sub counterpart of RpcMethod. Derived describes the *Subscribe request
+    // through methodNameImpl, hasParamsImpl and toJsonImpl, names the messages it
+    // is answered with in `notification`, and decodes their `params.result` with
+    //
+    //     static Notification parseNotification(const Encoding::JsonView &result)
+    //
+    // reading the frame in place, so a notification costs its struct and nothing else.
+    template <typename Derived>
+    struct RpcSubscription
+    {
+        json toJson() const
+        {
+            return static_cast<const Derived *>(this)->toJsonImpl();
+        }
+
+        std::string methodName() const
+        {
+            return static_cast<const Derived *>(this)->methodNameImpl();
+        }
+
+        bool hasParams() const
+        {
+            return static_cast<const Derived *>(this)->hasParamsImpl();
+        }
+
+        // The account, program or address the subscription is about, which picks its
+        // socket in a WebSocketPool; the method name when it is about none in particular
+        std::string shardKey() const
+        {
+            if constexpr (HasShardKey<Derived>)
+                return static_cast<const Derived *>(this)->shardKeyImpl();
+            else
+                return methodName();
+        }
+
+        // The subscribe request as a text frame, for a socket not driven by a
+        // SubscriptionManager
+        std::string request(u64 id) const
+        {
+            json j{{"jsonrpc", "2.0"}, {"id", id}, {"method", methodName()}};
+            if (hasParams())
+            {
+                j["params"] = toJson();
+            }
+            return j.dump();
+        }
+
+        // Decodes a whole frame from such a socket: the Notification it carries, or
+        // nullopt for anything else (subscribe replies, other kinds of notification)
+        static auto parseMessage(std::string_view message)
+        {
+            std::optional<typename Derived::Notification> notification;
+            const Encoding::JsonView view(message);
+            if (view["method"].isString() && view["method"].stringView() == Derived::notification)
+            {
+                notification = Derived::parseNotification(view["params"]["result"]);
+            }
+            return notification;
+        }
+    };
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "RpcSubscription.hpp"
+#include <string>
+#include <string_view>
+#include "Solana/Core/Types/Types.hpp"
+
+namespace Solana
+{
+    // Every slot the validator processes
+    struct SlotSubscribe : RpcSubscription<SlotSubscribe>
+    {
+        static constexpr std::string_view notification = "slotNotification";
+
+        struct Notification
+        {
+            u64 slot = 0;
+            u64 parent = 0;
+            u64 root = 0;
+        };
+
+        static Notification parseNotification(const Encoding::JsonView &result)
+        {
+            Notification n;
+            for (const auto &[key, value] : result.members())
+            {
+                if (key == "slot")
+                    n.slot = value.get<u64>();
+                else if (key == "parent")
+                    n.parent = value.get<u64>();
+                else if (key == "root")
+                    n.root = value.get<u64>();
+            }
+            return n;
+        }
+
+        std::string methodNameImpl() const { return "slotSubscribe"; }
+
+        json toJsonImpl() const { return json::array(); }
+
+        bool hasParamsImpl() const
+        {
+            return false;
+        }
+    };
+}
@@ -0,0 +1,507 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "Solana/Core/Types/Types.hpp"
+#include "Solana/Logger.hpp"
+#include "Solana/Network/WebSocket.hpp"
+#include "Solana/Rpc/SubscriptionManager.hpp"
+#include "Solana/Rpc/Subscriptions/RpcSubscription.hpp"
+
+using json = nlohmann::json;
+
+namespace Solana
+{
+    struct WebSocketPoolConfig
+    {
+        // Endpoint and socket settings, the same for every shard. Each shard's
+        // messages must be routed in order, so dispatch.workers may be 0 or 1; add
+        // shards rather than workers to spread handlers over threads.
+        Network::WebSocketConfig webSocket;
+        std::size_t shards = 4;
+        // Points per shard on the hash ring; more of them spread keys more evenly
+        std::size_t virtualNodes = 64;
+        // How long a shard may stay disconnected before its subscriptions move to
+        // the next shards on the ring. They move back once it is connected again.
+        std::chrono::milliseconds failoverAfter{10000};
+    };
+
+    struct WebSocketShardStats
+    {
+        bool connected = false;
+        // Subscriptions on this shard's socket, including ones moved in from a
+        // shard that is down
+        std::size_t subscriptions = 0;
+        Network::WebSocketStats socket;
+    };
+
+    struct WebSocketPoolStats
+    {
+        std::vector<WebSocketShardStats> shards;
+        // Times a shard's subscriptions were moved off it, and back onto it
+        std::size_t failovers = 0;
+        std::size_t restores = 0;
+    };
+
+    // Spreads subscriptions over several sockets to the same provider, for sets
+    // larger than one connection may carry or one read thread can keep up with.
+    // Each shard is a WebSocket with its own SubscriptionManager, io_context and
+    // thread; a subscription's key (the account, program or address it is about)
+    // picks its shard by consistent hash, so handlers for different shards run
+    // concurrently but every handler sees the same interface.
+    //
+    // A dropped shard reconnects and replays its own subscriptions. One that stays
+    // down for failoverAfter hands each of them to the next live shard along the
+    // ring, so the load spreads over the survivors instead of doubling one. Moves
+    // are make-before-break: the new subscription is confirmed before the old one
+    // is removed, so a handler may see a notification twice around a move but never
+    // misses one the provider sent.
+    class WebSocketPool
+    {
+    public:
+        using Handler = SubscriptionManager::Handler;
+        using GapHandler = SubscriptionManager::GapHandler;
+
+        WebSocketPool(ssl::context &ctx, const WebSocketPoolConfig &config)
+            : config_(config)
+        {
+            if (config_.webSocket.dispatch.workers > 1)
+            {
+                throw std::invalid_argument("WebSocketPool routes each shard's messages in order; use at most one dispatch worker");
+            }
+            const auto count = std::max<std::size_t>(config_.shards, 1);
+            const auto points = std::max<std::size_t>(config_.virtualNodes, 1);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto shard = std::make_unique<Shard>();
+                shard->ioc = std::make_unique<net::io_context>();
+                shard->ws = Network::WebSocket::create(*shard->ioc, ctx, config_.webSocket);
+                shard->manager = std::make_unique<SubscriptionManager>([ws = shard->ws](std::string message)
+                                                                       { ws->doWrite(std::move(message)); });
+                shard->ws->onReconnect([this, manager = shard->manager.get()]()
+                                       {
+                    manager->replay();
+                    wake_.notify_all(); });
+                shard->manager->onGap([this, i](const SubscriptionGap &gap)
+                                      { forwardGap(i, gap); });
+                shard->downSince = std::chrono::steady_clock::now();
+                for (std::size_t v = 0; v < points; ++v)
+                {
+                    ring_.emplace_back(hash(std::to_string(i) + '#' + std::to_string(v)), i);
+                }
+                shards_.push_back(std::move(shard));
+            }
+            std::sort(ring_.begin(), ring_.end());
+
+            for (auto &shard : shards_)
+            {
+                shard->thread = std::thread([ws = shard->ws, manager = shard->manager.get()]()
+                                            { ws->start({}, [manager](Network::PooledBuffer &&message)
+                                                        { manager->onMessage(message.view()); }, 0); });
+            }
+            rebalancer_ = std::thread([this]()
+                                      { rebalance(); });
+        }
+
+        WebSocketPool(const WebSocketPool &) = delete;
+        WebSocketPool &operator=(const WebSocketPool &) = delete;
+
+        ~WebSocketPool()
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            rebalancer_.join();
+            for (auto &shard : shards_)
+            {
+                shard->ioc->stop();
+                shard->thread.join();
+            }
+        }
+
+        // e.g. subscribe(pubkey, "accountSubscribe", {pubkey, {{"encoding", "base64"}}}, handler).
+        // Resolves to a handle for unsubscribe() once the server confirms; it stays
+        // valid across reconnects and moves between shards.
+        std::future<u64> subscribe(const std::string &key, const std::string &method, json params, Handler handler)
+        {
+            auto promise = std::make_shared<std::promise<u64>>();
+            auto future = promise->get_future();
+            auto entry = std::make_shared<Entry>(Entry{key, hash(key), method, std::move(params), std::move(handler)});
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            entry->handle = nextHandle_++;
+            entry->home = walk(entry->point, [](std::size_t)
+                               { return true; });
+            entries_.emplace(entry->handle, entry);
+            place(entry, target(*entry), [this, promise, entry](u64, std::exception_ptr error)
+                  {
+                if (!error)
+                {
+                    promise->set_value(entry->handle);
+                    return;
+                }
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    forget(entry);
+                }
+                promise->set_exception(error); });
+            return future;
+        }
+
+        // Typed form, keyed by the subscription's shardKey()
+        template <typename T>
+        std::future<u64> subscribe(const RpcSubscription<T> &subscription,
+                                   std::function<void(const typename T::Notification &)> handler)
+        {
+            return subscribe(subscription.shardKey(), subscription.methodName(),
+                             subscription.hasParams() ? subscription.toJson() : json(nullptr),
+                             [handler = std::move(handler)](const Encoding::JsonView &result)
+                             { handler(T::parseNotification(result)); });
+        }
+
+        std::future<bool> unsubscribe(u64 handle)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const auto it = entries_.find(handle);
+            if (it == entries_.end())
+            {
+                std::promise<bool> promise;
+                promise.set_exception(std::make_exception_ptr(std::invalid_argument("unknown subscription " + std::to_string(handle))));
+                return promise.get_future();
+            }
+            const auto entry = it->second;
+            forget(entry);
+            return shards_[entry->shard]->manager->unsubscribe(entry->local);
+        }
+
+        // Missed slots after any shard reconnects, with pool handles
+        void onGap(GapHandler handler)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            gapHandler_ = std::move(handler);
+        }
+
+        // The shard key belongs to while every shard is up
+        std::size_t shardOf(std::string_view key) const
+        {
+            return walk(hash(key), [](std::size_t)
+                        { return true; });
+        }
+
+        std::size_t size() const
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return entries_.size();
+        }
+
+        WebSocketPoolStats stats() const
+        {
+            WebSocketPoolStats result;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                result.failovers = failovers_;
+                result.restores = restores_;
+            }
+            for (const auto &shard : shards_)
+            {
+                const auto socket = shard->ws->stats();
+                result.shards.push_back(WebSocketShardStats{
+                    .connected = socket.connects > socket.disconnects,
+                    .subscriptions = shard->manager->size(),
+                    .socket = socket});
+            }
+            return result;
+        }
+
+    private:
+        struct Entry
+        {
+            std::string key;
+            u64 point = 0;
+            std::string method;
+            json params;
+            Handler handler;
+            u64 handle = 0;
+            // Where the key belongs, and where it is subscribed right now
+            std::size_t home = 0;
+            std::size_t shard = 0;
+            // The shard's SubscriptionManager handle
+            u64 local = 0;
+        };
+
+        struct Shard
+        {
+            std::unique_ptr<net::io_context> ioc;
+            std::shared_ptr<Network::WebSocket> ws;
+            std::unique_ptr<SubscriptionManager> manager;
+            // Manager handle -> pool handle
+            std::unordered_map<u64, u64> handles;
+            // As last seen by the rebalancer
+            bool connected = false;
+            bool failedOver = false;
+            std::chrono::steady_clock::time_point downSince;
+            std::thread thread;
+        };
+
+        struct Move
+        {
+            std::shared_ptr<Entry> entry;
+            std::size_t to = 0;
+            u64 local = 0;
+            std::future<bool> confirmed;
+        };
+
+        // FNV-1a, then a 64-bit finalizer: FNV alone leaves keys that differ in
+        // their last characters close together on the ring
+        static u64 hash(std::string_view key)
+        {
+            u64 h = 1469598103934665603ull;
+            for (const unsigned char c : key)
+            {
+                h ^= c;
+                h *= 1099511628211ull;
+            }
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9ull;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebull;
+            h ^= h >> 31;
+            return h;
+        }
+
+        // First shard clockwise from point that accept() takes, or the first one
+        // found when it takes none
+        template <typename Accept>
+        std::size_t walk(u64 point, Accept accept) const
+        {
+            const auto first = std::lower_bound(ring_.begin(), ring_.end(), std::pair<u64, std::size_t>(point, 0));
+            auto it = first;
+            for (std::size_t n = 0; n < ring_.size(); ++n, ++it)
+            {
+                if (it == ring_.end())
+                {
+                    it = ring_.begin();
+                }
+                if (accept(it->second))
+                {
+                    return it->second;
+                }
+            }
+            return first == ring_.end() ? ring_.front().second : first->second;
+        }
+
+        // Where entry should live now: its home unless that has failed over.
+        // Caller holds mutex_.
+        std::size_t target(const Entry &entry) const
+        {
+            if (!shards_[entry.home]->failedOver)
+            {
+                return entry.home;
+            }
+            return walk(entry.point, [this](std::size_t shard)
+                        { return !shards_[shard]->failedOver; });
+        }
+
+        // Caller holds mutex_
+        void place(const std::shared_ptr<Entry> &entry, std::size_t shard, SubscriptionManager::Confirmed confirmed)
+        {
+            entry->shard = shard;
+            entry->local = shards_[shard]->manager->subscribe(entry->method, entry->params, entry->handler, std::move(confirmed));
+            shards_[shard]->handles[entry->local] = entry->handle;
+        }
+
+        // Caller holds mutex_
+        void forget(const std::shared_ptr<Entry> &entry)
+        {
+            const auto it = entries_.find(entry->handle);
+            if (it != entries_.end() && it->second == entry)
+            {
+                entries_.erase(it);
+                shards_[entry->shard]->handles.erase(entry->local);
+            }
+        }
+
+        void forwardGap(std::size_t shard, SubscriptionGap gap)
+        {
+            GapHandler handler;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                const auto &handles = shards_[shard]->handles;
+                const auto it = handles.find(gap.handle);
+                if (it == handles.end() || !gapHandler_)
+                {
+                    return;
+                }
+                gap.handle = it->second;
+                handler = gapHandler_;
+            }
+            handler(gap);
+        }
+
+        // Watches the shards' connections and moves subscriptions off shards that
+        // stay down, and back once they recover
+        void rebalance()
+        {
+            const auto tick = std::clamp<std::chrono::milliseconds>(config_.failoverAfter / 4, std::chrono::milliseconds(10), std::chrono::milliseconds(250));
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!stopping_)
+            {
+                wake_.wait_for(lock, tick);
+                if (stopping_)
+                {
+                    return;
+                }
+
+                const auto now = std::chrono::steady_clock::now();
+                std::vector<Move> moves;
+                for (std::size_t i = 0; i < shards_.size(); ++i)
+                {
+                    auto &shard = *shards_[i];
+                    const auto socket = shard.ws->stats();
+                    const bool connected = socket.connects > socket.disconnects;
+                    if (connected != shard.connected)
+                    {
+                        shard.connected = connected;
+                        shard.downSince = now;
+                    }
+
+                    if (!connected && !shard.failedOver && now - shard.downSince >= config_.failoverAfter)
+                    {
+                        shard.failedOver = true;
+                        ++failovers_;
+                        const auto before = moves.size();
+                        for (const auto &[handle, entry] : entries_)
+                        {
+                            if (entry->shard == i)
+                            {
+                                moves.push_back(Move{entry, target(*entry)});
+                            }
+                        }
+                        LOG_WARN("WebSocket shard {} down for {}ms; moving {} subscriptions to other shards", i,
+                                 std::chrono::duration_cast<std::chrono::milliseconds>(now - shard.downSince).count(), moves.size() - before);
+                    }
+                    else if (connected && shard.failedOver)
+                    {
+                        shard.failedOver = false;
+                        ++restores_;
+                        LOG_INFO("WebSocket shard {} is back", i);
+                    }
+                    // Every tick, not only the one that saw the shard recover, so a
+                    // move home that was not confirmed is tried again
+                    if (connected && !shard.failedOver)
+                    {
+                        const auto before = moves.size();
+                        for (const auto &[handle, entry] : entries_)
+                        {
+                            if (entry->home == i && entry->shard != i)
+                            {
+                                moves.push_back(Move{entry, i});
+                            }
+                        }
+                        if (moves.size() > before)
+                        {
+                            LOG_INFO("Moving {} subscriptions home to WebSocket shard {}", moves.size() - before, i);
+                        }
+                    }
+                }
+                if (!moves.empty())
+                {
+                    move(lock, moves);
+                }
+            }
+        }
+
+        // Subscribes each entry on its new shard, waits for the confirmations with
+        // the lock released, then drops the old subscriptions. An entry whose move
+        // fails stays where it was, to be replayed there; a failed move home is
+        // retried on the next tick.
+        void move(std::unique_lock<std::mutex> &lock, std::vector<Move> &moves)
+        {
+            for (auto &move : moves)
+            {
+                if (move.to == move.entry->shard)
+                {
+                    continue;
+                }
+                auto promise = std::make_shared<std::promise<bool>>();
+                move.confirmed = promise->get_future();
+                move.local = shards_[move.to]->manager->subscribe(move.entry->method, move.entry->params, move.entry->handler,
+                                                                  [promise](u64, std::exception_ptr error)
+                                                                  { promise->set_value(!error); });
+            }
+
+            lock.unlock();
+            const auto deadline = std::chrono::steady_clock::now() + confirmTimeout;
+            for (auto &move : moves)
+            {
+                while (move.confirmed.valid() && move.confirmed.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
+                {
+                    if (stopping_ || std::chrono::steady_clock::now() > deadline)
+                    {
+                        break;
+                    }
+                }
+            }
+            lock.lock();
+
+            for (auto &move : moves)
+            {
+                if (!move.confirmed.valid())
+                {
+                    continue;
+                }
+                auto &entry = move.entry;
+                const auto it = entries_.find(entry->handle);
+                const bool wanted = it != entries_.end() && it->second == entry;
+                const bool confirmed = move.confirmed.wait_for(std::chrono::seconds(0)) == std::future_status::ready && move.confirmed.get();
+                if (!wanted || !confirmed)
+                {
+                    // Unsubscribed meanwhile, or the new shard would not take it
+                    shards_[move.to]->manager->unsubscribe(move.local);
+                    if (wanted)
+                    {
+                        LOG_WARN("Could not move subscription {} to WebSocket shard {}", entry->handle, move.to);
+                    }
+                    continue;
+                }
+                auto &from = *shards_[entry->shard];
+                from.handles.erase(entry->local);
+                from.manager->unsubscribe(entry->local);
+                entry->shard = move.to;
+                entry->local = move.local;
+                shards_[move.to]->handles[move.local] = entry->handle;
+            }
+        }
+
+        static constexpr std::chrono::seconds confirmTimeout{10};
+
+        WebSocketPoolConfig config_;
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        // (point, shard), sorted by point
+        std::vector<std::pair<u64, std::size_t>> ring_;
+        std::vector<std::unique_ptr<Shard>> shards_;
+        std::unordered_map<u64, std::shared_ptr<Entry>> entries_;
+        u64 nextHandle_ = 1;
+        std::size_t failovers_ = 0;
+        std::size_t restores_ = 0;
+        GapHandler gapHandler_;
+        std::atomic<bool> stopping_ = false;
+        std::thread rebalancer_;
+    };
+}
@@ -351,13 +351,14 @@ std::string Base58::Encode(const unsigned char *pbegin, const unsigned char *pen
 std::optional<std::string> Base58::Decode(std::string_view input)
 {
     auto psz = input.data();
+    const auto end = input.data() + input.size();
     // Skip leading spaces.
-    while (*psz && std::isspace(*psz))
+    while (psz != end && std::isspace(*psz))
         psz++;
     // Skip and count leading '1's.
     int zeroes = 0;
     int length = 0;
-    while (*psz == '1')
+    while (psz != end && *psz == '1')
     {
         zeroes++;
         psz++;
@@ -367,7 +368,7 @@ std::optional<std::string> Base58::Decode(std::string_view input)
     std::vector<unsigned char> b256(size);
     // Process the characters.
     static_assert(std::size(mapBase58) == 256, "mapBase58.size() should be 256"); // guarantee not out of range
-    while (*psz && !std::isspace(*psz))
+    while (psz != end && !std::isspace(*psz))
     {
         // Decode base58 character
         int carry = mapBase58[(uint8_t)*psz];
@@ -385,9 +386,9 @@ std::optional<std::string> Base58::Decode(std::string_view input)
         psz++;
     }
     // Skip trailing spaces.
-    while (std::isspace(*psz))
+    while (psz != end && std::isspace(*psz))
         psz++;
-    if (*psz != 0)
+    if (psz != end)
         return {};
     // Skip leading zeroes in b256.
     auto it = b256.begin() + (size - length);
@@ -403,13 +404,14 @@ std::optional<std::string> Base58::Decode(std::string_view input)
 std::optional<std::vector<uint8_t>> Base58::DecodeToBytes(std::string_view input)
 {
     auto psz = input.data();
+    const auto end = input.data() + input.size();
     // Skip leading spaces
-    while (*psz && std::isspace(*psz))
+    while (psz != end && std::isspace(*psz))
         psz++;
     // Skip and count leading '1's
     int zeroes = 0;
     int length = 0;
-    while (*psz == '1')
+    while (psz != end && *psz == '1')
     {
         zeroes++;
         psz++;
@@ -421,7 +423,7 @@ std::optional<std::vector<uint8_t>> Base58::DecodeToBytes(std::string_view input
 
     // Process input characters
     static_assert(sizeof(mapBase58) == 256, "mapBase58 size mismatch");
-    while (*psz && !std::isspace(*psz))
+    while (psz != end && !std::isspace(*psz))
     {
         int carry = mapBase58[(uint8_t)*psz];
         if (carry == -1) // invalid char
@@ -441,9 +443,9 @@ std::optional<std::vector<uint8_t>> Base58::DecodeToBytes(std::string_view input
     }
 
     // Skip trailing spaces
-    while (std::isspace(*psz))
+    while (psz != end && std::isspace(*psz))
         psz++;
-    if (*psz != 0)
+    if (psz != end)
         return std::nullopt;
 
     // Skip leading zeroes
@@ -1,4 +1,5 @@
 #include "Solana/Logger.hpp"
+#include <mutex>
 
 namespace Solana
 {
@@ -22,10 +23,9 @@ namespace Solana
 
     std::shared_ptr<spdlog::logger> &Logger::get()
     {
-        if (!logger)
-        {
-            init();
-        }
+        // Threads may log for the first time at once, e.g. the shards of a WebSocketPool
+        static std::once_flag once;
+        std::call_once(once, init);
         return logger;
     }
 
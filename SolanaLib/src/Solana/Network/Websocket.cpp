@@ -1,4 +1,7 @@
 #include "Solana/Network/WebSocket.hpp"
+#include "Solana/Network/DnsCache.hpp"
+#include "Solana/Network/HappyEyeballs.hpp"
+#include "Solana/Network/TlsSessionCache.hpp"
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/ssl.hpp>
@@ -8,9 +11,11 @@
 #include <boost/asio/steady_timer.hpp>
 #include <boost/json.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <memory>
+#include <random>
 
 namespace Solana::Network
 {
@@ -19,17 +24,27 @@ namespace Solana::Network
                                                  const std::string &host, const std::string &port,
                                                  const std::string &api_key)
     {
-        return std::shared_ptr<WebSocket>(new WebSocket(ioc, ctx, host, port, api_key));
+        return create(ioc, ctx, WebSocketConfig{.host = host, .port = port, .apiKey = api_key});
     }
 
-    WebSocket::WebSocket(net::io_context &ioc, ssl::context &ctx, const std::string &host,
-                         const std::string &port, const std::string &api_key)
-        : ioc(ioc), ctx(ctx), host(host), port(port), api_key(api_key),
-          ws(std::make_shared<websocket::stream<beast::ssl_stream<beast::tcp_stream>>>(ioc, ctx)),
-          timer_(ioc),
-          buffer(),
+    std::shared_ptr<WebSocket> WebSocket::create(net::io_context &ioc, ssl::context &ctx,
+                                                 const WebSocketConfig &config)
+    {
+        return std::shared_ptr<WebSocket>(new WebSocket(ioc, ctx, config));
+    }
+
+    WebSocket::WebSocket(net::io_context &ioc, ssl::context &ctx, const WebSocketConfig &config)
+        : ioc(ioc), ctx(ctx), strand_(net::make_strand(ioc)), host(config.host), port(config.port), api_key(config.apiKey),
+          reconnect_(config.reconnect), dispatch_(config.dispatch), compression_(config.compression),
+          writeBatch_(std::max<std::size_t>(config.writeBatch, 1)),
+          ws(std::make_shared<websocket::stream<beast::ssl_stream<beast::tcp_stream>>>(strand_, ctx)),
+          buffers_(std::make_shared<BufferPool>(config.pooledBuffers + (config.dispatch.workers ? config.dispatch.queueCapacity + config.dispatch.workers : 0))),
+          timer_(strand_),
+          backpressureTimer_(strand_),
           cancelled(false)
     {
+        // Lets a reconnect resume the previous TLS session instead of a full handshake
+        TlsSessionCache::enable(ctx);
         std::cout << "WebSocket initialized with host: " << host << ", port: " << port << "\n";
     }
 
@@ -47,29 +62,45 @@ namespace Solana::Network
         std::cerr << what << ": " << ec.message() << "\n";
     }
 
-    void WebSocket::subscribe(net::yield_context yield, const std::vector<std::string> subscription_messages,
-                              std::function<void(beast::flat_buffer &&)> on_msg_callback)
+    void WebSocket::connect()
+    {
+        // A websocket stream cannot be reused once closed
+        ws = std::make_shared<websocket::stream<beast::ssl_stream<beast::tcp_stream>>>(strand_, ctx);
+
+        net::spawn(strand_, [self = shared_from_this()](net::yield_context yield)
+                   { self->subscribe(yield); }, [](std::exception_ptr ex)
+                   {
+                if(ex)
+                {
+                    try
+                    {
+                        std::rethrow_exception(ex);
+                    }
+                    catch(std::exception& e)
+                    {
+                        std::cerr << "Unhandled exception: " << e.what() << "\n";
+                    }
+                } });
+    }
+
+    void WebSocket::subscribe(net::yield_context yield)
     {
         std::cout << "Connecting to WebSocket...\n";
         beast::error_code ec;
 
-        // These objects perform our I/O
-        tcp::resolver resolver(ioc);
-
-        // Look up the domain name
-        auto const results = resolver.async_resolve(host, port, yield[ec]);
+        // Look up the domain name, reusing the addresses HttpClient already resolved
+        auto endpoints = DnsCache::shared()->asyncResolve(strand_, host, port, yield[ec]);
         if (ec)
-            return fail(ec, "resolve");
-
-        // Set a timeout on the operation
-        beast::get_lowest_layer(*ws).expires_after(std::chrono::seconds(30));
+            return retry(ec, "resolve");
 
         std::cout << "Connecting to " << host << ":" << port << "\n";
 
-        // Make the connection on the IP address we get from a lookup
-        auto ep = beast::get_lowest_layer(*ws).async_connect(results, yield[ec]);
+        // Race the returned addresses and keep the first to connect
+        auto const ep = HappyEyeballs::asyncConnect(strand_, std::move(endpoints),
+                                                    std::chrono::steady_clock::now() + std::chrono::seconds(30),
+                                                    beast::get_lowest_layer(*ws).socket(), yield[ec]);
         if (ec)
-            return fail(ec, "connect");
+            return retry(ec, "connect");
 
         // Set SNI Hostname (many hosts need this to handshake successfully)
         if (!SSL_set_tlsext_host_name(
@@ -78,8 +109,9 @@ namespace Solana::Network
         {
             ec = beast::error_code(static_cast<int>(::ERR_get_error()),
                                    net::error::get_ssl_category());
-            return fail(ec, "connect");
+            return retry(ec, "connect");
         }
+        TlsSessionCache::offer(ws->next_layer().native_handle());
 
         // Update the host string. This will provide the value of the
         // Host HTTP header during the WebSocket handshake.
@@ -102,7 +134,8 @@ namespace Solana::Network
         // Perform the SSL handshake
         ws->next_layer().async_handshake(ssl::stream_base::client, yield[ec]);
         if (ec)
-            return fail(ec, "ssl_handshake");
+            return retry(ec, "ssl_handshake");
+        TlsSessionCache::completed(ws->next_layer().native_handle());
 
         // Turn off the timeout on the tcp_stream, because
         // the websocket stream has its own timeout system.
@@ -113,36 +146,131 @@ namespace Solana::Network
             websocket::stream_base::timeout::suggested(
                 beast::role_type::client));
 
+        if (compression_.enabled)
+        {
+            websocket::permessage_deflate deflate;
+            deflate.client_enable = true;
+            deflate.server_max_window_bits = compression_.serverMaxWindowBits;
+            deflate.client_max_window_bits = compression_.clientMaxWindowBits;
+            deflate.server_no_context_takeover = !compression_.contextTakeover;
+            deflate.client_no_context_takeover = !compression_.contextTakeover;
+            deflate.compLevel = compression_.level;
+            deflate.memLevel = compression_.memLevel;
+            ws->set_option(deflate);
+        }
+
         // Perform the websocket handshake
         // Note that we're using the target with the api-key parameter
         std::string target = "/?api-key=" + api_key;
-        ws->async_handshake(host_header, target, yield[ec]);
+        websocket::response_type response;
+        ws->async_handshake(response, host_header, target, yield[ec]);
         if (ec)
-            return fail(ec, "handshake");
+            return retry(ec, "handshake");
+
+        // The server lists the extensions it accepted
+        const bool compressed = response[http::field::sec_websocket_extensions].find("permessage-deflate") != beast::string_view::npos;
+        if (compression_.enabled && !compressed)
+            std::cout << "Server declined permessage-deflate; reading uncompressed frames\n";
+
+        if (cancelled)
+            return;
 
         // Send the subscription message if provided
-        if (!subscription_messages.empty())
+        if (!subscriptionMessages_.empty())
         {
-            for (auto message : subscription_messages)
+            for (const auto &message : subscriptionMessages_)
             {
                 std::cout << "Sending subscription request: " << message << "\n";
                 ws->async_write(net::buffer(message), yield[ec]);
                 if (ec)
-                    return fail(ec, "subscription_write");
+                    return retry(ec, "subscription_write");
+            }
+        }
+
+        attempts_ = 0;
+        ++generation_;
+        writing_ = false;
+        const bool reconnected = std::exchange(connectedBefore_, true);
+        if (reconnected)
+        {
+            // Whatever was queued for the old connection is stale, including what
+            // doWrite() has not moved onto the strand yet: the replay below
+            // re-sends what still matters
+            writeQueue_.clear();
+            {
+                std::lock_guard<std::mutex> lock(outboxMutex_);
+                outbox_.clear();
+            }
+            if (onReconnect_)
+                onReconnect_();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            ++stats_.connects;
+            stats_.compressed = compressed;
+            if (reconnected)
+            {
+                const auto recovery = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - lostAt_);
+                recoveries_.record(recovery);
+                std::cout << "WebSocket reconnected after " << recovery.count() << "ms\n";
             }
         }
 
+        // Anything queued with doWrite() while connecting goes out now
+        open_ = true;
+        flush();
+
         // Start the reading loop
         doRead();
     }
 
+    void WebSocket::retry(beast::error_code ec, char const *what)
+    {
+        fail(ec, what);
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            ++stats_.failedAttempts;
+        }
+        ++attempts_;
+        scheduleReconnect();
+    }
+
+    void WebSocket::scheduleReconnect()
+    {
+        if (cancelled)
+            return;
+        if (maxRetries_ > 0 && attempts_ >= maxRetries_)
+        {
+            std::cerr << "Max retries reached. Exiting.\n";
+            return;
+        }
+
+        // Exponential backoff from the first failed attempt on, capped and jittered
+        // downwards; the first attempt after a drop only waits out initialBackoff
+        const auto exponent = std::min(std::max(attempts_ - 1, 0), 16);
+        const auto ceiling = std::min<std::chrono::milliseconds>(reconnect_.initialBackoff * (1 << exponent), reconnect_.maxBackoff);
+        thread_local std::minstd_rand rng(std::random_device{}());
+        std::uniform_real_distribution<double> jitter(1.0 - std::clamp(reconnect_.jitter, 0.0, 1.0), 1.0);
+        const auto delay = std::chrono::milliseconds(static_cast<long long>(ceiling.count() * jitter(rng)));
+
+        std::cerr << "Reconnecting in " << delay.count() << "ms (attempt " << attempts_ + 1 << ")\n";
+        timer_.expires_after(delay);
+        timer_.async_wait([self = shared_from_this()](beast::error_code ec)
+                          {
+            if (!ec && !self->cancelled)
+                self->connect(); });
+    }
+
     void WebSocket::doRead()
     {
         // Make sure we're not destroyed during this operation
         auto self = shared_from_this();
 
+        // Usually the buffer the previous message was read into, capacity intact
+        message_ = buffers_->acquire();
         ws->async_read(
-            buffer,
+            message_.buffer(),
             [self](beast::error_code ec, std::size_t bytes_transferred)
             {
                 self->onRead(ec, bytes_transferred);
@@ -153,24 +281,42 @@ namespace Solana::Network
     {
         if (ec)
         {
+            open_ = false;
+            if (cancelled)
+                return;
+
             if (ec == websocket::error::closed)
-                std::cout << "WebSocket connection closed normally\n";
+                std::cout << "WebSocket connection closed by the server\n";
             else
                 fail(ec, "read");
+
+            {
+                std::lock_guard<std::mutex> lock(statsMutex_);
+                ++stats_.disconnects;
+            }
+            lostAt_ = std::chrono::steady_clock::now();
+            scheduleReconnect();
             return;
         }
 
         if (!ws->is_open())
             return;
 
-        // Move the buffer to the callback
-        if (onMessage_)
+        if (dispatcher_)
         {
-            onMessage_(std::move(buffer));
+            // The read thread only queues; the dispatcher's workers run the callback
+            handOff(std::chrono::steady_clock::now());
+            return;
         }
 
-        // Reset buffer (allocate new one since moved-from buffer is in unspecified state)
-        buffer = beast::flat_buffer();
+        // Lend the buffer to the callback; it returns to the pool when the lease is
+        // destroyed, here unless the callback kept it
+        if (onMessage_)
+        {
+            auto message = std::move(message_);
+            onMessage_(std::move(message));
+        }
+        message_ = PooledBuffer();
 
         if (!cancelled)
         {
@@ -178,65 +324,182 @@ namespace Solana::Network
         }
     }
 
-    void WebSocket::doWrite(const std::string &message)
+    void WebSocket::handOff(std::chrono::steady_clock::time_point received)
     {
+        if (cancelled)
+            return;
+
+        if (dispatcher_->offer(message_, received))
+        {
+            doRead();
+            return;
+        }
+
+        // Leave the next frames in the socket until a worker makes room
+        backpressureTimer_.expires_after(std::chrono::microseconds(200));
+        backpressureTimer_.async_wait([self = shared_from_this(), received](beast::error_code ec)
+                                      {
+            if (!ec)
+                self->handOff(received); });
+    }
+
+    void WebSocket::doWrite(std::string message)
+    {
+        // A websocket stream allows one write at a time, so writes are queued on
+        // the strand and sent back to back
+        {
+            std::lock_guard<std::mutex> lock(outboxMutex_);
+            outbox_.push_back(std::move(message));
+            if (std::exchange(flushPosted_, true))
+                return;
+        }
+        net::post(strand_, [self = shared_from_this()]()
+                  {
+            {
+                std::lock_guard<std::mutex> lock(self->outboxMutex_);
+                self->flushPosted_ = false;
+                for (auto &queued : self->outbox_)
+                    self->writeQueue_.push_back(std::move(queued));
+                self->outbox_.clear();
+            }
+            self->flush(); });
+    }
+
+    void WebSocket::flush()
+    {
+        if (!open_ || writing_ || writeQueue_.empty())
+            return;
+
+        writing_ = true;
         // Make sure we're not destroyed during this operation
         auto self = shared_from_this();
 
+        const auto count = std::min(writeBatch_, writeQueue_.size());
+        if (count == 1)
+        {
+            frame_ = std::move(writeQueue_.front());
+        }
+        else
+        {
+            // Requests are JSON objects, so a batch is just their text in an array
+            std::size_t size = count + 1;
+            for (std::size_t i = 0; i < count; ++i)
+                size += writeQueue_[i].size();
+            frame_.clear();
+            frame_.reserve(size);
+            frame_ += '[';
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (i)
+                    frame_ += ',';
+                frame_ += writeQueue_[i];
+            }
+            frame_ += ']';
+        }
+        writeQueue_.erase(writeQueue_.begin(), writeQueue_.begin() + count);
+
         ws->async_write(
-            net::buffer(message),
-            [self](beast::error_code ec, std::size_t bytes_transferred)
+            net::buffer(frame_),
+            [self, count, generation = generation_](beast::error_code ec, std::size_t)
             {
+                // The connection this write went out on was replaced meanwhile
+                if (generation != self->generation_)
+                    return;
+                self->writing_ = false;
                 if (ec)
+                {
+                    // The read side notices the drop and reconnects, and whatever
+                    // still matters is replayed then
                     self->fail(ec, "write");
+                    return;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(self->statsMutex_);
+                    self->stats_.messagesWritten += count;
+                    ++self->stats_.framesWritten;
+                }
+                self->flush();
             });
     }
 
+    void WebSocket::onReconnect(std::function<void()> handler)
+    {
+        onReconnect_ = std::move(handler);
+    }
+
+    void WebSocket::stop()
+    {
+        net::post(strand_, [self = shared_from_this()]()
+                  {
+            self->cancelled = true;
+            self->open_ = false;
+            self->timer_.cancel();
+            self->backpressureTimer_.cancel();
+            if (self->ws->is_open())
+            {
+                self->ws->async_close(websocket::close_code::normal, [self](beast::error_code) {});
+            }
+            else
+            {
+                beast::get_lowest_layer(*self->ws).close();
+            } });
+    }
+
+    WebSocketStats WebSocket::stats() const
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        auto result = stats_;
+        result.buffers = buffers_->stats();
+        if (dispatcher_)
+            result.dispatch = dispatcher_->stats();
+        result.recoverP50 = std::chrono::duration_cast<std::chrono::milliseconds>(recoveries_.quantile(0.5));
+        result.recoverP99 = std::chrono::duration_cast<std::chrono::milliseconds>(recoveries_.quantile(0.99));
+        return result;
+    }
+
     void WebSocket::start(const std::vector<std::string> &subscription_messages,
                           std::function<void(beast::flat_buffer &&)> on_msg_callback,
                           int max_retries)
     {
-        int retry_count = 0;
-        while (retry_count < max_retries)
+        start(subscription_messages, [on_msg_callback = std::move(on_msg_callback)](PooledBuffer &&message)
+              { on_msg_callback(std::move(message.buffer())); }, max_retries);
+    }
+
+    void WebSocket::start(const std::vector<std::string> &subscription_messages,
+                          MessageHandler on_msg_callback,
+                          int max_retries)
+    {
+        subscriptionMessages_ = subscription_messages;
+        maxRetries_ = max_retries;
+        if (dispatch_.workers > 0)
+        {
+            std::lock_guard<std::mutex> lock(statsMutex_);
+            dispatcher_ = std::make_unique<MessageDispatcher>(dispatch_, std::move(on_msg_callback));
+        }
+        else
+        {
+            onMessage_ = std::move(on_msg_callback); // Store callback
+        }
+        connect();
+
+        while (true)
         {
             try
             {
-                // Launch the session operation with reconnect logic
-                net::spawn(ioc, [self = shared_from_this(), subscription_messages, on_msg_callback](net::yield_context yield)
-                           { self->subscribe(yield, subscription_messages, on_msg_callback); }, [](std::exception_ptr ex)
-                           {
-                        if(ex)
-                        {
-                            try
-                            {
-                                std::rethrow_exception(ex);
-                            }
-                            catch(std::exception& e)
-                            {
-                                std::cerr << "Unhandled exception: " << e.what() << "\n";
-                            }
-                        } });
-
-                // Run the I/O service. The call will return when
-                // the socket is closed.
-                onMessage_ = std::move(on_msg_callback); // Store callback
+                // Run the I/O service. The call returns once stop() was called or
+                // the retries ran out.
                 ioc.run();
-                break; // Exit loop on success
+                break;
             }
             catch (std::exception &e)
             {
-                std::cerr << "Connection failed: " << e.what() << "\n";
-                ++retry_count;
-                if (retry_count < max_retries)
-                {
-                    std::cerr << "Retrying in 3 seconds... (Attempt " << retry_count << " of " << max_retries << ")\n";
-                    ioc.restart();
-                }
-                else
-                {
-                    std::cerr << "Max retries reached. Exiting.\n";
-                }
+                // A throwing message handler must not take the connection down with it
+                std::cerr << "Unhandled exception: " << e.what() << "\n";
             }
         }
+
+        // Let the workers finish what was already read before returning
+        if (dispatcher_)
+            dispatcher_->stop();
     }
-}
\ No newline at end of file
+}
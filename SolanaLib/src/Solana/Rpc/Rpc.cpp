@@ -1,14 +1,9 @@
 #include "Solana/Rpc/Rpc.hpp"
 #include <chrono>
+#include <stdexcept>
 
 using namespace Solana;
 
-namespace
-{
-    net::io_context ioc = {};
-    std::atomic_int messageCounter = 0;
-}
-
 Rpc Rpc::DefaultMainnet()
 {
     return Rpc("https://api.mainnet-beta.solana.com");
@@ -16,57 +11,105 @@ Rpc Rpc::DefaultMainnet()
 
 Rpc::~Rpc()
 {
-    // ws->shutdown();
-    wsThread.join();
+    if (wsThread.joinable())
+    {
+        wsContext->stop();
+        wsThread.join();
+    }
 }
 
-void Rpc::runWs()
+void Rpc::postBatch(std::vector<PendingCall> &&calls)
 {
-    // net::io_context ioc;
-    // ssl::context ctx{ssl::context::tlsv12_client};
-
-    // ws = std::make_shared<Network::WebSocket>(ioc, ctx, "mainnet.helius-rpc.com", "443", "7b0e15f4-3d3b-4e17-be8d-3ada2a0e9e3d");
-    // auto url = client.getUrl();
-    // url.service = "443";
-    // ws->run(url);
-
-    // if (ioc.stopped())
-    //     ioc.restart();
-    // ready = true;
-    // cv.notify_all();
-
-    // ioc.run();
+    for (std::size_t first = 0; first < calls.size(); first += maxBatchSize)
+    {
+        const auto last = std::min(calls.size(), first + maxBatchSize);
+        auto body = json::array();
+        std::vector<u64> ids;
+        ids.reserve(last - first);
+        // A batch costs the rate limiter what its calls would separately
+        double units = 0;
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const auto id = calls[i].request["id"].get<u64>();
+            inFlight.insert(id, std::move(calls[i].resolve));
+            ids.push_back(id);
+            units += cost(calls[i].request["method"].get<std::string>());
+            body.push_back(std::move(calls[i].request));
+        }
+
+        // Only reached if the batch is dropped from the rate limiter's queue
+        auto fail = [this, ids](std::exception_ptr ex)
+        { resolveBatch(ids, ex, json()); };
+        throttled(units, Network::RequestOptions{}, [this, body = std::move(body), ids = std::move(ids)]() mutable
+                  {
+            LOG_INFO("SENDING batch of {} requests", body.size());
+            client.asyncPost<BatchReply>(body, [this, ids = std::move(ids)](std::exception_ptr ex, BatchReply reply)
+                                         { resolveBatch(ids, ex, reply.replies); }); }, std::move(fail));
+    }
 }
 
-// std::future<bool> Rpc::removeSubscription(int subId)
-// {
-//     auto message = json::object();
-//     message["jsonrpc"] = "2.0";
-//     message["id"] = ++messageCounter;
-//     message["params"] = json::array({subId});
-
-//     return ws->unsubscribe(message);
-// }
-
-// std::future<int> Rpc::createSubscription(
-//     const json &message,
-//     MessageHandler &&handler)
-// {
-
-//     std::unique_lock lock(wsMutex);
-
-//     cv.wait(lock, [this]()
-//             { return ready.load(); });
-
-//     return ws->subscribe(message, std::move(handler));
-// }
-
-// std::future<int> Rpc::onSlot(MessageHandler &&handler)
-// {
-//     auto message = json::object();
-//     message["jsonrpc"] = "2.0";
-//     message["id"] = ++messageCounter;
-//     message["method"] = "slotSubscribe";
+void Rpc::resolveBatch(const std::vector<u64> &ids, std::exception_ptr ex, const json &replies)
+{
+    // A transport failure, or a single error object instead of an array, fails the whole batch
+    if (!ex && !replies.is_array())
+    {
+        ex = std::make_exception_ptr(std::runtime_error("batch error: " + replies.dump()));
+    }
+    if (ex)
+    {
+        for (const auto id : ids)
+        {
+            if (auto resolve = inFlight.take(id))
+            {
+                (*resolve)(ex, nullptr);
+            }
+        }
+        return;
+    }
+
+    // Replies may come back in any order
+    for (const auto &reply : replies)
+    {
+        const auto id = reply.find("id");
+        auto resolve = id != reply.end() && id->is_number_unsigned() ? inFlight.take(id->get<u64>()) : std::nullopt;
+        if (!resolve)
+        {
+            LOG_WARN("Dropping batch reply without a matching request: {}", reply.dump());
+            continue;
+        }
+        (*resolve)(nullptr, reply);
+    }
+
+    // Whatever is still in flight from this batch was left out of the reply
+    for (const auto id : ids)
+    {
+        if (auto resolve = inFlight.take(id))
+        {
+            (*resolve)(std::make_exception_ptr(std::runtime_error("no reply for request id " + std::to_string(id))), nullptr);
+        }
+    }
+}
 
-//     return createSubscription(message, std::move(handler));
-// }
\ No newline at end of file
+void Rpc::startWs(const Network::WebSocketConfig &config)
+{
+    if (config.dispatch.workers > 1)
+    {
+        throw std::invalid_argument("subscriptions need their messages in order; use at most one dispatch worker");
+    }
+    wsContext = std::make_unique<net::io_context>();
+    wsTls = std::make_unique<ssl::context>(ssl::context::tlsv12_client);
+    wsTls->set_default_verify_paths();
+    wsTls->set_verify_mode(ssl::verify_peer);
+    ws = Network::WebSocket::create(*wsContext, *wsTls, config);
+    // Requests sent before the first connection wait in the socket's write queue.
+    // A reconnect drops whatever is still queued, and replay() sends it again.
+    manager = std::make_unique<SubscriptionManager>([ws = ws](std::string message)
+                                                    { ws->doWrite(std::move(message)); });
+    // The server forgets subscriptions with the connection they were made on
+    ws->onReconnect([this]()
+                    { manager->replay(); });
+    // Reconnects until the Rpc is destroyed
+    wsThread = std::thread([this]()
+                           { ws->start({}, [this](Network::PooledBuffer &&message)
+                                       { manager->onMessage(message.view()); }, 0); });
+}
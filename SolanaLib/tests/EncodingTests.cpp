@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "Solana/Core/Encoding/Base58.hpp"
 #include "Solana/Core/Encoding/Layout.hpp"
+#include "Solana/Core/Encoding/JsonView.hpp"
 #include <string_view>
 #include "Solana/Core/Types/Types.hpp"
 #include "Solana/Core/Transaction/TransactionBuilder.hpp"
@@ -282,4 +283,48 @@ TEST(CLASS, TxnMessageSerializationTest) {
         actual.size());
 
     EXPECT_EQ(expectedTxn, actual.toString());
-}
\ No newline at end of file
+}
+
+TEST(JsonViewTest, ReadsNestedValuesInPlace) {
+    const std::string text = R"( {"slot": 42, "meta": {"err": null, "fee": -5}, "keys": ["a", "b\"c"], "ok": true} )";
+    const JsonView view(text);
+
+    EXPECT_EQ(view["slot"].get<u64>(), 42u);
+    EXPECT_TRUE(view["meta"]["err"].isNull());
+    EXPECT_EQ(view["meta"]["fee"].get<i64>(), -5);
+    EXPECT_EQ(view["keys"][1].get<std::string>(), "b\"c");
+    EXPECT_EQ(view["keys"][1].get<std::string_view>(), "b\\\"c");
+    EXPECT_TRUE(view["ok"].get<bool>());
+    EXPECT_EQ(view["meta"].raw(), R"({"err": null, "fee": -5})");
+
+    // String views point into the original text rather than owning a copy
+    EXPECT_EQ(view["keys"][0].get<std::string_view>().data(), text.data() + text.find("\"a\"") + 1);
+}
+
+TEST(JsonViewTest, MissingValuesReadAsNull) {
+    const JsonView view(R"({"a": [], "b": {}})");
+
+    EXPECT_FALSE(view["nope"].exists());
+    EXPECT_TRUE(view["nope"].isNull());
+    EXPECT_FALSE(view["a"][0].exists());
+    EXPECT_EQ(view.value<i64>("nope", 7), 7);
+    EXPECT_TRUE(view["a"].elements().begin() == view["a"].elements().end());
+    EXPECT_TRUE(view["b"].members().begin() == view["b"].members().end());
+}
+
+TEST(JsonViewTest, IteratesMembersInOrder) {
+    const JsonView view(R"({"x": {"skip": [1, {"}": "]"}]}, "y": 2, "z": "\u00e9\ud83d\ude00"})");
+
+    std::vector<std::string_view> keys;
+    for (const auto &[key, value] : view.members()) {
+        keys.push_back(key);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string_view>{"x", "y", "z"}));
+    EXPECT_EQ(view["z"].get<std::string>(), "\xc3\xa9\xf0\x9f\x98\x80");
+}
+
+TEST(JsonViewTest, ThrowsOnMalformedInput) {
+    EXPECT_THROW(JsonView(R"({"a": [1, 2)")["b"], std::runtime_error);
+    EXPECT_THROW(JsonView(R"({"a": "x)")["a"].raw(), std::runtime_error);
+    EXPECT_THROW(JsonView(R"({"a": "x"})")["a"].get<u64>(), std::runtime_error);
+}
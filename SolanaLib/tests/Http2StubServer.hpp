@@ -0,0 +1,293 @@
+#pragma once
+#if SOLANA_HAS_HTTP2
+#include "StubServer.hpp"
+#include <nghttp2/nghttp2.h>
+#include <cstring>
+#include <map>
+
+namespace Solana::Testing
+{
+    struct Http2StubServerConfig
+    {
+        std::size_t threads = 1;
+        // Select h2 when the client offers it; false completes the TLS handshake
+        // without ALPN, as a server that only speaks HTTP/1.1 would
+        bool alpn = true;
+        // Holds each reply back for a time picked from its request body, so streams
+        // on one connection can complete out of order
+        std::function<std::chrono::microseconds(const std::string &body)> delay;
+    };
+
+    // Local TLS server that negotiates h2 via ALPN and answers every stream with
+    // the handler's reply, mirroring StubServer for the HTTP/2 transport.
+    class Http2StubServer
+    {
+    public:
+        using Handler = StubServer::Handler;
+
+        explicit Http2StubServer(Handler handler, Http2StubServerConfig config = {})
+            : handler_(std::move(handler)),
+              config_(std::move(config)),
+              ctx_(ssl::context::tls_server),
+              acceptor_(ioc_, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0))
+        {
+            ctx_.use_certificate_chain_file(dataPath("cert.pem"));
+            ctx_.use_private_key_file(dataPath("key.pem"), ssl::context::pem);
+            if (config_.alpn)
+            {
+                SSL_CTX_set_alpn_select_cb(ctx_.native_handle(), &Http2StubServer::selectH2, nullptr);
+            }
+
+            net::spawn(
+                acceptor_.get_executor(),
+                [this](net::yield_context yield)
+                { accept(yield); },
+                net::detached);
+
+            for (std::size_t i = 0; i < std::max<std::size_t>(config_.threads, 1); ++i)
+            {
+                threads_.emplace_back([this]()
+                                      { ioc_.run(); });
+            }
+        }
+
+        ~Http2StubServer()
+        {
+            ioc_.stop();
+            for (auto &t : threads_)
+            {
+                t.join();
+            }
+        }
+
+        std::string url() const { return "https://127.0.0.1:" + std::to_string(acceptor_.local_endpoint().port()) + "/"; }
+
+        std::size_t connections() const { return connections_; }
+
+        std::size_t requests() const { return requests_; }
+
+    private:
+        // Shared by the reading and writing coroutines and by timers holding replies
+        // back; all of them run on the connection's strand
+        struct Session : std::enable_shared_from_this<Session>
+        {
+            Session(Http2StubServer *server, tcp::socket socket, ssl::context &ctx)
+                : server(server), stream(std::move(socket), ctx), wake(stream.get_executor())
+            {
+            }
+
+            ~Session()
+            {
+                if (session)
+                {
+                    nghttp2_session_del(session);
+                }
+            }
+
+            Http2StubServer *server;
+            beast::ssl_stream<beast::tcp_stream> stream;
+            // Cancelled whenever nghttp2 may have frames to send
+            net::steady_timer wake;
+            nghttp2_session *session = nullptr;
+            bool closed = false;
+            std::map<int32_t, std::string> requests;
+            std::map<int32_t, std::pair<std::string, std::size_t>> responses;
+        };
+
+        static int selectH2(SSL *, const unsigned char **out, unsigned char *outlen, const unsigned char *in, unsigned int inlen, void *)
+        {
+            for (unsigned int i = 0; i < inlen; i += in[i] + 1)
+            {
+                if (in[i] == 2 && std::memcmp(in + i + 1, "h2", 2) == 0)
+                {
+                    *out = in + i + 1;
+                    *outlen = 2;
+                    return SSL_TLSEXT_ERR_OK;
+                }
+            }
+            return SSL_TLSEXT_ERR_NOACK;
+        }
+
+        static int onBeginHeaders(nghttp2_session *, const nghttp2_frame *frame, void *user)
+        {
+            static_cast<Session *>(user)->requests[frame->hd.stream_id];
+            return 0;
+        }
+
+        static int onDataChunk(nghttp2_session *, uint8_t, int32_t id, const uint8_t *data, size_t len, void *user)
+        {
+            static_cast<Session *>(user)->requests[id].append(reinterpret_cast<const char *>(data), len);
+            return 0;
+        }
+
+        static ssize_t readResponse(nghttp2_session *, int32_t id, uint8_t *buf, size_t length, uint32_t *flags, nghttp2_data_source *, void *user)
+        {
+            auto &[body, sent] = static_cast<Session *>(user)->responses[id];
+            const auto n = std::min(length, body.size() - sent);
+            std::memcpy(buf, body.data() + sent, n);
+            sent += n;
+            if (sent == body.size())
+            {
+                *flags |= NGHTTP2_DATA_FLAG_EOF;
+            }
+            return static_cast<ssize_t>(n);
+        }
+
+        static int onFrameRecv(nghttp2_session *, const nghttp2_frame *frame, void *user)
+        {
+            auto *s = static_cast<Session *>(user);
+            if ((frame->hd.type != NGHTTP2_HEADERS && frame->hd.type != NGHTTP2_DATA) ||
+                !(frame->hd.flags & NGHTTP2_FLAG_END_STREAM))
+            {
+                return 0;
+            }
+            const auto id = frame->hd.stream_id;
+            ++s->server->requests_;
+            auto body = s->server->handler_(s->requests[id]);
+            const auto &delay = s->server->config_.delay;
+            const auto wait = delay ? delay(s->requests[id]) : std::chrono::microseconds(0);
+            s->requests.erase(id);
+            if (wait.count() <= 0)
+            {
+                respond(*s, id, std::move(body));
+                return 0;
+            }
+
+            auto timer = std::make_shared<net::steady_timer>(s->stream.get_executor(), wait);
+            timer->async_wait([session = s->shared_from_this(), timer, id, body = std::move(body)](beast::error_code) mutable
+                              {
+                if (session->closed)
+                    return;
+                respond(*session, id, std::move(body));
+                session->wake.cancel(); });
+            return 0;
+        }
+
+        static void respond(Session &s, int32_t id, std::string body)
+        {
+            s.responses[id] = {std::move(body), 0};
+
+            static const std::string status = ":status", ok = "200", type = "content-type", json = "application/json";
+            const nghttp2_nv nva[] = {
+                {(uint8_t *)status.data(), (uint8_t *)ok.data(), status.size(), ok.size(), NGHTTP2_NV_FLAG_NONE},
+                {(uint8_t *)type.data(), (uint8_t *)json.data(), type.size(), json.size(), NGHTTP2_NV_FLAG_NONE},
+            };
+            nghttp2_data_provider provider{};
+            provider.read_callback = &Http2StubServer::readResponse;
+            nghttp2_submit_response(s.session, id, nva, std::size(nva), &provider);
+        }
+
+        static int onStreamClose(nghttp2_session *, int32_t id, uint32_t, void *user)
+        {
+            static_cast<Session *>(user)->responses.erase(id);
+            return 0;
+        }
+
+        void accept(net::yield_context yield)
+        {
+            for (;;)
+            {
+                beast::error_code ec;
+                tcp::socket socket(net::make_strand(ioc_));
+                acceptor_.async_accept(socket, yield[ec]);
+                if (ec)
+                {
+                    return;
+                }
+                ++connections_;
+                auto executor = socket.get_executor();
+                net::spawn(
+                    executor,
+                    [this, socket = std::move(socket)](net::yield_context yield) mutable
+                    { session(std::move(socket), yield); },
+                    net::detached);
+            }
+        }
+
+        void session(tcp::socket socket, net::yield_context yield)
+        {
+            beast::error_code ec;
+            auto s = std::make_shared<Session>(this, std::move(socket), ctx_);
+            s->stream.async_handshake(ssl::stream_base::server, yield[ec]);
+            if (ec || !config_.alpn)
+            {
+                return;
+            }
+
+            nghttp2_session_callbacks *callbacks;
+            nghttp2_session_callbacks_new(&callbacks);
+            nghttp2_session_callbacks_set_on_begin_headers_callback(callbacks, &Http2StubServer::onBeginHeaders);
+            nghttp2_session_callbacks_set_on_data_chunk_recv_callback(callbacks, &Http2StubServer::onDataChunk);
+            nghttp2_session_callbacks_set_on_frame_recv_callback(callbacks, &Http2StubServer::onFrameRecv);
+            nghttp2_session_callbacks_set_on_stream_close_callback(callbacks, &Http2StubServer::onStreamClose);
+            nghttp2_session_server_new(&s->session, callbacks, s.get());
+            nghttp2_session_callbacks_del(callbacks);
+
+            const nghttp2_settings_entry settings[] = {{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, 1000}};
+            nghttp2_submit_settings(s->session, NGHTTP2_FLAG_NONE, settings, std::size(settings));
+
+            // Delayed replies are submitted between reads, so writing has a coroutine of its own
+            net::spawn(
+                s->stream.get_executor(),
+                [s](net::yield_context yield)
+                { write(*s, yield); },
+                net::detached);
+
+            std::array<char, 64 * 1024> in;
+            while (!s->closed)
+            {
+                const auto n = s->stream.async_read_some(net::buffer(in), yield[ec]);
+                if (ec || nghttp2_session_mem_recv(s->session, reinterpret_cast<const uint8_t *>(in.data()), n) < 0)
+                {
+                    break;
+                }
+                s->wake.cancel();
+            }
+            s->closed = true;
+            s->wake.cancel();
+        }
+
+        static void write(Session &s, net::yield_context yield)
+        {
+            beast::error_code ec;
+            std::string out;
+            while (!s.closed)
+            {
+                out.clear();
+                const uint8_t *data = nullptr;
+                for (ssize_t n; (n = nghttp2_session_mem_send(s.session, &data)) > 0;)
+                {
+                    out.append(reinterpret_cast<const char *>(data), n);
+                }
+                if (!out.empty())
+                {
+                    net::async_write(s.stream, net::buffer(out), yield[ec]);
+                    if (ec)
+                    {
+                        break;
+                    }
+                    continue;
+                }
+                if (!nghttp2_session_want_read(s.session) && !nghttp2_session_want_write(s.session))
+                {
+                    break;
+                }
+                s.wake.expires_at(net::steady_timer::time_point::max());
+                s.wake.async_wait(yield[ec]);
+            }
+            // Ends the read as well
+            s.closed = true;
+            beast::get_lowest_layer(s.stream).close();
+        }
+
+        Handler handler_;
+        Http2StubServerConfig config_;
+        net::io_context ioc_;
+        ssl::context ctx_;
+        tcp::acceptor acceptor_;
+        std::vector<std::thread> threads_;
+        std::atomic<std::size_t> connections_ = 0;
+        std::atomic<std::size_t> requests_ = 0;
+    };
+}
+#endif
@@ -0,0 +1,684 @@
+#include <gtest/gtest.h>
+#include "Solana/Network/EndpointGroup.hpp"
+#include "Solana/Network/HttpClient.hpp"
+#include "StubServer.hpp"
+#include "Http2StubServer.hpp"
+#include "WebSocketStubServer.hpp"
+#include "Solana/Network/WebSocket.hpp"
+#include "Solana/Rpc/InFlightTable.hpp"
+#include "Solana/Rpc/SubscriptionManager.hpp"
+#include "Solana/Rpc/Methods/GetTransaction.hpp"
+#include <ctime>
+#include <fstream>
+#include <malloc.h>
+#include <random>
+
+using namespace Solana::Network;
+using Solana::Testing::StubServer;
+using json = nlohmann::json;
+
+namespace
+{
+    // Process-wide heap accounting for the backfill benchmark. Every allocation
+    // (including the stub server's) is counted, so only deltas around one run mean anything.
+    std::atomic<std::size_t> allocations = 0;
+    std::atomic<std::size_t> liveBytes = 0;
+    std::atomic<std::size_t> peakBytes = 0;
+    // Allocations made by the calling thread, for measuring one IO thread in isolation
+    thread_local std::size_t threadAllocations = 0;
+}
+
+void *operator new(std::size_t size)
+{
+    void *p = std::malloc(size ? size : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    ++allocations;
+    ++threadAllocations;
+    const auto live = liveBytes += malloc_usable_size(p);
+    auto peak = peakBytes.load();
+    while (live > peak && !peakBytes.compare_exchange_weak(peak, live))
+    {
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p)
+    {
+        liveBytes -= malloc_usable_size(p);
+        std::free(p);
+    }
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+namespace
+{
+    // Reply type that pays the same JSON parsing cost an RpcReply would
+    struct ParsedReply
+    {
+        std::size_t fields = 0;
+
+        static ParsedReply parse(std::string_view body)
+        {
+            const auto j = json::parse(body);
+            return ParsedReply{.fields = j["result"].size()};
+        }
+    };
+
+    // A captured getTransaction payload, so both sides move realistic bodies
+    std::string transactionReply()
+    {
+        return Solana::Testing::capturedTransactionReplies().front();
+    }
+
+    // Stamped when the reply is parsed, so latency excludes the time spent in future::get
+    struct TimedReply
+    {
+        std::chrono::steady_clock::time_point received;
+
+        static TimedReply parse(std::string_view)
+        {
+            return TimedReply{.received = std::chrono::steady_clock::now()};
+        }
+    };
+
+    // getTransaction reply parsed the way it was before replies could keep the body:
+    // a full DOM, then the result subtree copied out into the reply
+    struct DomTransactionReply
+    {
+        json tx;
+        Solana::u64 slot = 0;
+
+        static DomTransactionReply parse(std::string_view body)
+        {
+            const auto j = json::parse(body);
+            const auto d = j["result"];
+            return DomTransactionReply{.tx = d, .slot = d["slot"].get<Solana::u64>()};
+        }
+    };
+
+    struct HeapUsage
+    {
+        std::size_t allocations;
+        std::size_t peakBytes;
+    };
+
+    // Fetches `total` transactions and keeps every reply, as a backfill that writes
+    // them out at the end would
+    template <typename Reply>
+    HeapUsage backfillHeapUsage(HttpClient &client, std::size_t total, std::size_t concurrency)
+    {
+        const auto body = json{{"jsonrpc", "2.0"}, {"id", 1}, {"method", "getTransaction"}};
+        std::vector<Reply> kept;
+        kept.reserve(total);
+
+        const auto baseBytes = liveBytes.load();
+        const auto baseAllocations = allocations.load();
+        peakBytes = baseBytes;
+        for (std::size_t sent = 0; sent < total; sent += concurrency)
+        {
+            std::vector<std::future<Reply>> wave;
+            for (std::size_t i = 0; i < concurrency && sent + i < total; ++i)
+            {
+                wave.push_back(client.post<Reply>(body));
+            }
+            for (auto &f : wave)
+            {
+                kept.push_back(f.get());
+            }
+        }
+        return {allocations - baseAllocations, peakBytes - baseBytes};
+    }
+
+    struct Percentiles
+    {
+        double p50;
+        double p99;
+    };
+
+    // Sends `total` requests in waves of `concurrency`; works with HttpClient and EndpointGroup
+    template <typename Client>
+    Percentiles latencyAtConcurrency(Client &client, std::size_t total, std::size_t concurrency, const RequestOptions &options = {})
+    {
+        const auto body = json{{"jsonrpc", "2.0"}, {"id", "1"}, {"method", "getSlot"}};
+        std::vector<double> micros;
+        micros.reserve(total);
+        for (std::size_t first = 0; first < total; first += concurrency)
+        {
+            const auto wave = std::min(concurrency, total - first);
+            std::vector<std::chrono::steady_clock::time_point> sent(wave);
+            std::vector<std::future<TimedReply>> replies;
+            replies.reserve(wave);
+            for (std::size_t i = 0; i < wave; ++i)
+            {
+                sent[i] = std::chrono::steady_clock::now();
+                replies.push_back(client.template post<TimedReply>(body, options));
+            }
+            for (std::size_t i = 0; i < wave; ++i)
+            {
+                const auto received = replies[i].get().received;
+                micros.push_back(std::chrono::duration<double, std::micro>(received - sent[i]).count());
+            }
+        }
+        std::sort(micros.begin(), micros.end());
+        return {micros[micros.size() / 2], micros[micros.size() * 99 / 100]};
+    }
+
+    // Opens `total` connections one after another, each through resolve, connect and
+    // the TLS handshake, and closes them again
+    Percentiles handshakeLatency(const StubServer &server, std::size_t total, bool resume)
+    {
+        net::io_context ioc;
+        auto guard = net::make_work_guard(ioc);
+        std::thread runner([&ioc]()
+                           { ioc.run(); });
+        ssl::context ctx(ssl::context::tlsv12_client);
+        if (resume)
+        {
+            TlsSessionCache::enable(ctx);
+        }
+
+        std::vector<double> micros;
+        micros.reserve(total);
+        for (std::size_t i = 0; i < total; ++i)
+        {
+            Connector::Stream stream(net::make_strand(ioc), ctx);
+            std::promise<beast::error_code> connected;
+            const auto start = std::chrono::steady_clock::now();
+            net::dispatch(stream.get_executor(), [&]()
+                          { Connector::establish(stream, "127.0.0.1", std::to_string(server.port()),
+                                                 [&connected](beast::error_code ec, const char *)
+                                                 { connected.set_value(ec); }); });
+            EXPECT_FALSE(connected.get_future().get());
+            micros.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        guard.reset();
+        runner.join();
+        std::sort(micros.begin(), micros.end());
+        return {micros[micros.size() / 2], micros[micros.size() * 99 / 100]};
+    }
+
+    // A provider that answers in 2ms but stalls for 100ms on one request in 20
+    std::function<std::chrono::microseconds()> stallingLatency(unsigned seed)
+    {
+        auto rng = std::make_shared<std::mt19937>(seed);
+        auto mutex = std::make_shared<std::mutex>();
+        return [rng, mutex]()
+        {
+            std::unique_lock<std::mutex> lock(*mutex);
+            return std::chrono::microseconds(std::uniform_int_distribution<int>(0, 19)(*rng) == 0 ? 100000 : 2000);
+        };
+    }
+
+    // Streams `messages` from a local WebSocket server and returns the allocations
+    // the client's IO thread made per message; `copy` reads each one into a
+    // std::string first, as handlers did before they got a view of the buffer
+    double webSocketAllocationsPerMessage(const std::vector<std::string> &messages, std::size_t pooledBuffers, bool copy)
+    {
+        Solana::Testing::WebSocketStubServer server;
+        net::io_context ioc;
+        ssl::context ctx(ssl::context::tlsv12_client);
+        auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .pooledBuffers = pooledBuffers});
+
+        std::size_t received = 0;
+        std::size_t bytes = 0;
+        std::size_t before = 0;
+        std::size_t after = 0;
+        const std::string subscribe = R"({"jsonrpc":"2.0","id":1,"method":"logsSubscribe","params":["all"]})";
+        std::thread reader([&]()
+                           { ws->start({subscribe}, [&](PooledBuffer &&message)
+                                       {
+                if (copy)
+                {
+                    const std::string text(message.view());
+                    bytes += text.size();
+                }
+                else
+                {
+                    bytes += message.view().size();
+                }
+                // The first message is the subscribe reply; count from there
+                if (received++ == 0)
+                    before = threadAllocations;
+                if (received == messages.size() + 1)
+                {
+                    after = threadAllocations;
+                    ws->stop();
+                } }, 1); });
+
+        while (server.subscribeRequests() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        server.broadcast(messages);
+        reader.join();
+        EXPECT_EQ(received, messages.size() + 1);
+        EXPECT_GT(bytes, 0u);
+        return static_cast<double>(after - before) / messages.size();
+    }
+
+    struct DeflateReplay
+    {
+        // Bytes on the wire (after compression and TLS) per byte of message text
+        double wireRatio = 0;
+        // CPU time of the client's read thread per message, inflate included
+        double cpuMicrosPerMessage = 0;
+        bool compressed = false;
+    };
+
+    std::chrono::nanoseconds threadCpuTime()
+    {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    }
+
+    // Streams `messages` from a local server that accepts permessage-deflate to a
+    // client configured with `compression`
+    DeflateReplay replayWithCompression(const std::vector<std::string> &messages, const CompressionConfig &compression)
+    {
+        websocket::permessage_deflate deflate;
+        deflate.server_enable = true;
+        Solana::Testing::WebSocketStubServer server(deflate);
+        net::io_context ioc;
+        ssl::context ctx(ssl::context::tlsv12_client);
+        auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .compression = compression});
+
+        std::size_t received = 0;
+        std::size_t payload = 0;
+        std::chrono::nanoseconds cpuStart{0};
+        std::chrono::nanoseconds cpuEnd{0};
+        const std::string subscribe = R"({"jsonrpc":"2.0","id":1,"method":"logsSubscribe","params":["all"]})";
+        std::thread reader([&]()
+                           { ws->start({subscribe}, [&](PooledBuffer &&message)
+                                       {
+                // The first message is the subscribe reply; count from there
+                if (received++ == 0)
+                {
+                    cpuStart = threadCpuTime();
+                    return;
+                }
+                payload += message.size();
+                if (received == messages.size() + 1)
+                {
+                    cpuEnd = threadCpuTime();
+                    ws->stop();
+                } }, 1); });
+
+        while (server.subscribeRequests() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // Let the subscribe reply go out before counting
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const auto wireBefore = server.bytesWritten();
+        server.broadcast(messages);
+        reader.join();
+        EXPECT_EQ(received, messages.size() + 1);
+        return DeflateReplay{
+            .wireRatio = static_cast<double>(server.bytesWritten() - wireBefore) / payload,
+            .cpuMicrosPerMessage = std::chrono::duration<double, std::micro>(cpuEnd - cpuStart).count() / messages.size(),
+            .compressed = ws->stats().compressed};
+    }
+
+    struct SubscribeRun
+    {
+        double perSecond = 0;
+        std::size_t frames = 0;
+    };
+
+    // Issues `count` accountSubscribes back to back through a SubscriptionManager
+    // and times them until every one is confirmed
+    SubscribeRun subscribeThroughWebSocket(std::size_t count, std::size_t writeBatch)
+    {
+        Solana::Testing::WebSocketStubServer server;
+        net::io_context ioc;
+        ssl::context ctx(ssl::context::tlsv12_client);
+        auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .writeBatch = writeBatch});
+        Solana::SubscriptionManager manager([&ws](std::string message)
+                                            { ws->doWrite(std::move(message)); });
+        std::thread reader([&]()
+                           { ws->start({}, [&manager](PooledBuffer &&message)
+                                       { manager.onMessage(message.view()); }, 1); });
+        while (ws->stats().connects == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<Solana::u64>> handles;
+        handles.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            handles.push_back(manager.subscribe("accountSubscribe", json::array({"account" + std::to_string(i)}),
+                                                [](const Solana::Encoding::JsonView &) {}));
+        }
+        for (auto &handle : handles)
+        {
+            handle.get();
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        ws->stop();
+        reader.join();
+        EXPECT_EQ(server.subscribeRequests(), count);
+        return SubscribeRun{.perSecond = count / elapsed.count(), .frames = server.framesReceived()};
+    }
+
+    double requestsPerSecond(HttpClient &client, std::size_t total, std::size_t concurrency)
+    {
+        const auto body = json{{"jsonrpc", "2.0"}, {"id", "1"}, {"method", "getTransaction"}};
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t sent = 0; sent < total; sent += concurrency)
+        {
+            std::vector<std::future<ParsedReply>> wave;
+            for (std::size_t i = 0; i < concurrency && sent + i < total; ++i)
+            {
+                wave.push_back(client.post<ParsedReply>(body));
+            }
+            for (auto &f : wave)
+            {
+                EXPECT_GT(f.get().fields, 0u);
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return total / elapsed.count();
+    }
+}
+
+class NetworkBenchmark : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        Solana::Logger::get()->set_level(spdlog::level::warn);
+    }
+
+    void TearDown() override
+    {
+        Solana::Logger::get()->set_level(spdlog::level::debug);
+    }
+};
+
+// Fan out getTransaction-sized replies through 1..N IO threads against a local TLS stub
+TEST_F(NetworkBenchmark, HttpClientThroughputScalesWithThreads)
+{
+    const auto reply = transactionReply();
+    StubServer server([&reply](const std::string &)
+                      { return reply; },
+                      {.threads = 4});
+
+    const std::size_t maxThreads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+    for (std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        HttpClient client(Url(server.url()), {.threads = threads});
+        requestsPerSecond(client, 64, 64); // warm the connection pool
+        const auto rps = requestsPerSecond(client, 2000, 64);
+        std::cout << "[ BENCH    ] HttpClient threads=" << threads << " " << static_cast<long>(rps) << " req/s\n";
+        RecordProperty("rps_threads_" + std::to_string(threads), static_cast<int>(rps));
+    }
+}
+
+#if SOLANA_HAS_HTTP2
+// 1k concurrent JSON-RPC calls: HTTP/2 streams on one connection vs the pooled HTTP/1.1 path
+TEST_F(NetworkBenchmark, Http2LatencyAgainstHttp1)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"jsonrpc":"2.0","id":"1","result":1234})"); };
+    Solana::Testing::StubServer http1Server(reply, {.threads = 4});
+    Solana::Testing::Http2StubServer http2Server(reply, {.threads = 4});
+
+    HttpClient http1(Url(http1Server.url()), {.threads = 4});
+    HttpClient http2(Url(http2Server.url()), {.threads = 4, .http2Connections = 1});
+
+    const auto h1 = latencyAtConcurrency(http1, 1000, 1000);
+    const auto h2 = latencyAtConcurrency(http2, 1000, 1000);
+    std::cout << "[ BENCH    ] HTTP/1.1 p50=" << h1.p50 << "us p99=" << h1.p99 << "us over " << http1Server.connections() << " connections\n";
+    std::cout << "[ BENCH    ] HTTP/2   p50=" << h2.p50 << "us p99=" << h2.p99 << "us over " << http2Server.connections() << " connections\n";
+
+    EXPECT_EQ(http2Server.connections(), 1u);
+    EXPECT_EQ(http2Server.requests(), 1000u);
+    RecordProperty("http1_p99_us", static_cast<int>(h1.p99));
+    RecordProperty("http2_p99_us", static_cast<int>(h2.p99));
+}
+#endif
+
+// Two providers with the same heavy tail: one endpoint alone vs hedging idempotent
+// reads to the other after the primary's recent p95
+TEST_F(NetworkBenchmark, HedgingCutsTailLatency)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"jsonrpc":"2.0","id":"1","result":1234})"); };
+    StubServer first(reply, {.threads = 2, .latency = stallingLatency(1)});
+    StubServer second(reply, {.threads = 2, .latency = stallingLatency(2)});
+
+    EndpointGroup single({first.url()});
+    EndpointGroup hedged({first.url(), second.url()});
+    const RequestOptions read{.idempotent = true};
+    latencyAtConcurrency(single, 64, 8, read); // warm connections and latency history
+    latencyAtConcurrency(hedged, 64, 8, read);
+
+    const auto alone = latencyAtConcurrency(single, 800, 8, read);
+    const auto racing = latencyAtConcurrency(hedged, 800, 8, read);
+
+    std::size_t requests = 0;
+    std::size_t hedges = 0;
+    for (const auto &endpoint : hedged.stats())
+    {
+        requests += endpoint.requests;
+        hedges += endpoint.hedges;
+    }
+    std::cout << "[ BENCH    ] single endpoint p50=" << alone.p50 << "us p99=" << alone.p99 << "us\n";
+    std::cout << "[ BENCH    ] hedged x2       p50=" << racing.p50 << "us p99=" << racing.p99 << "us, "
+              << 100.0 * hedges / (requests - hedges) << "% extra requests\n";
+    RecordProperty("single_p99_us", static_cast<int>(alone.p99));
+    RecordProperty("hedged_p99_us", static_cast<int>(racing.p99));
+    EXPECT_LT(racing.p99, alone.p99);
+}
+
+// Cold connections to a local OpenSSL server: full handshakes against resumed sessions
+TEST_F(NetworkBenchmark, TlsResumptionCutsHandshakeTime)
+{
+    StubServer server([](const std::string &)
+                      { return std::string(R"({"jsonrpc":"2.0","id":"1","result":1234})"); },
+                      {.threads = 2});
+
+    const auto full = handshakeLatency(server, 200, false);
+    const auto resumed = handshakeLatency(server, 200, true);
+    std::cout << "[ BENCH    ] full handshake    p50=" << full.p50 << "us p99=" << full.p99 << "us\n";
+    std::cout << "[ BENCH    ] resumed handshake p50=" << resumed.p50 << "us p99=" << resumed.p99 << "us\n";
+    RecordProperty("tls_full_p50_us", static_cast<int>(full.p50));
+    RecordProperty("tls_resumed_p50_us", static_cast<int>(resumed.p50));
+    EXPECT_LT(resumed.p50, full.p50);
+}
+
+// Routing one reply (insert a new id, take the oldest) with 100 to 10k requests outstanding
+TEST_F(NetworkBenchmark, InFlightTableLookupStaysFlat)
+{
+    using Resolve = std::function<void(std::exception_ptr, const json &)>;
+    constexpr std::size_t rounds = 200000;
+
+    std::vector<double> nanos;
+    for (const std::size_t outstanding : {100u, 1000u, 10000u})
+    {
+        Solana::InFlightTable<Resolve> table;
+        std::uint64_t next = 0;
+        for (; next < outstanding; ++next)
+        {
+            table.insert(next, Resolve{});
+        }
+
+        std::size_t routed = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < rounds; ++i, ++next)
+        {
+            table.insert(next, Resolve{});
+            routed += table.take(next - outstanding).has_value();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        EXPECT_EQ(routed, rounds);
+        EXPECT_EQ(table.size(), outstanding);
+        nanos.push_back(elapsed.count() / rounds);
+        std::cout << "[ BENCH    ] InFlightTable outstanding=" << outstanding << " " << nanos.back() << "ns per reply\n";
+        RecordProperty("inflight_ns_" + std::to_string(outstanding), static_cast<int>(nanos.back()));
+    }
+
+    // Hash lookups: 100x more outstanding requests must not mean a proportionally slower route
+    EXPECT_LT(nanos.back(), nanos.front() * 4);
+}
+
+// getTransaction replies from messages.json: full json DOM (RpcReply::fromJson) vs the
+// in-place JsonView path that GetTransaction opts into through parseReplyView
+TEST_F(NetworkBenchmark, TransactionReplyParseViewAgainstDom)
+{
+    using Tx = Solana::GetTransaction<>;
+    const auto replies = Solana::Testing::capturedTransactionReplies();
+    ASSERT_FALSE(replies.empty());
+    std::size_t bytes = 0;
+    for (const auto &reply : replies)
+    {
+        bytes += reply.size();
+    }
+
+    const auto megabytesPerSecond = [&](auto &&parse)
+    {
+        constexpr int rounds = 20;
+        std::size_t slots = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; ++i)
+        {
+            for (const auto &reply : replies)
+            {
+                slots += parse(reply).result.slot;
+            }
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_GT(slots, 0u);
+        return rounds * bytes / elapsed.count() / 1e6;
+    };
+
+    const auto dom = megabytesPerSecond([](const std::string &reply)
+                                        { return Solana::RpcReply<Tx>::fromJson(json::parse(reply)); });
+    const auto view = megabytesPerSecond([](const std::string &reply)
+                                         { return Solana::RpcReply<Tx>::parse(reply); });
+    std::cout << "[ BENCH    ] getTransaction parse over " << replies.size() << " replies: DOM " << dom << " MB/s, JsonView " << view << " MB/s\n";
+    RecordProperty("parse_dom_mbps", static_cast<int>(dom));
+    RecordProperty("parse_view_mbps", static_cast<int>(view));
+    EXPECT_GT(view, dom);
+}
+
+// 1000-transaction backfill with every reply kept: DOM replies that copy the
+// transaction out vs RpcReply<GetTransaction>, whose tx is a RawJson view sharing
+// the moved-in response body
+TEST_F(NetworkBenchmark, TransactionBackfillHeapUsage)
+{
+    const auto replies = Solana::Testing::capturedTransactionReplies();
+    std::atomic<std::size_t> next = 0;
+    StubServer server([&](const std::string &)
+                      { return replies[next++ % replies.size()]; },
+                      {.threads = 2});
+    HttpClient client(Url(server.url()), {.threads = 2});
+    backfillHeapUsage<DomTransactionReply>(client, 16, 16); // warm the connection pool
+
+    // Only operator new deltas are compared: peak RSS is a high-water mark for the
+    // whole process, so whichever variant ran second would inherit the first's
+    const auto owned = backfillHeapUsage<Solana::RpcReply<Solana::GetTransaction<>>>(client, 1000, 16);
+    const auto dom = backfillHeapUsage<DomTransactionReply>(client, 1000, 16);
+
+    std::cout << "[ BENCH    ] backfill x1000 DOM copies:  " << dom.allocations << " allocations, peak heap "
+              << dom.peakBytes / (1024 * 1024) << " MiB\n";
+    std::cout << "[ BENCH    ] backfill x1000 owned body: " << owned.allocations << " allocations, peak heap "
+              << owned.peakBytes / (1024 * 1024) << " MiB\n";
+    RecordProperty("backfill_dom_allocations", static_cast<int>(dom.allocations));
+    RecordProperty("backfill_owned_allocations", static_cast<int>(owned.allocations));
+    RecordProperty("backfill_dom_peak_kib", static_cast<int>(dom.peakBytes / 1024));
+    RecordProperty("backfill_owned_peak_kib", static_cast<int>(owned.peakBytes / 1024));
+    EXPECT_LT(owned.allocations, dom.allocations);
+    EXPECT_LT(owned.peakBytes, dom.peakBytes);
+}
+
+// logsSubscribe traffic replayed from parsed_logs.json: a fresh read buffer per
+// message copied into a string, as WebSocket and main.cpp used to, against
+// recycled buffers read in place
+TEST_F(NetworkBenchmark, WebSocketPooledBuffersCutAllocations)
+{
+    const auto captured = Solana::Testing::capturedLogNotifications();
+    ASSERT_FALSE(captured.empty());
+    std::vector<std::string> messages;
+    while (messages.size() < 5000)
+    {
+        messages.insert(messages.end(), captured.begin(), captured.end());
+    }
+
+    const auto fresh = webSocketAllocationsPerMessage(messages, 0, true);
+    const auto pooled = webSocketAllocationsPerMessage(messages, 8, false);
+    std::cout << "[ BENCH    ] " << messages.size() << " log notifications: fresh buffer + copy " << fresh
+              << " allocations/message, pooled view " << pooled << " allocations/message\n";
+    RecordProperty("ws_fresh_allocs_per_msg_x100", static_cast<int>(fresh * 100));
+    RecordProperty("ws_pooled_allocs_per_msg_x100", static_cast<int>(pooled * 100));
+    EXPECT_LT(pooled, 0.1);
+    EXPECT_GT(fresh, 1.0);
+}
+
+// logsSubscribe traffic replayed from parsed_logs.json with and without
+// permessage-deflate: wire bytes per byte of JSON against the client CPU spent
+// reading, for the window and context-takeover settings worth choosing between
+TEST_F(NetworkBenchmark, WebSocketDeflateBandwidthAgainstCpu)
+{
+    const auto captured = Solana::Testing::capturedLogNotifications();
+    ASSERT_FALSE(captured.empty());
+    std::vector<std::string> messages;
+    while (messages.size() < 5000)
+    {
+        messages.insert(messages.end(), captured.begin(), captured.end());
+    }
+
+    const std::vector<std::pair<std::string, CompressionConfig>> configs{
+        {"uncompressed", {}},
+        {"deflate 15 bits", {.enabled = true}},
+        {"deflate 9 bits", {.enabled = true, .serverMaxWindowBits = 9, .clientMaxWindowBits = 9}},
+        {"deflate per message", {.enabled = true, .contextTakeover = false}},
+    };
+    std::vector<DeflateReplay> results;
+    for (const auto &[name, compression] : configs)
+    {
+        results.push_back(replayWithCompression(messages, compression));
+        const auto &result = results.back();
+        std::cout << "[ BENCH    ] " << messages.size() << " log notifications, " << name << ": "
+                  << result.wireRatio << " wire bytes per byte, " << result.cpuMicrosPerMessage << " us CPU/message\n";
+        EXPECT_EQ(result.compressed, compression.enabled);
+    }
+    RecordProperty("ws_plain_wire_ratio_x1000", static_cast<int>(results[0].wireRatio * 1000));
+    RecordProperty("ws_deflate_wire_ratio_x1000", static_cast<int>(results[1].wireRatio * 1000));
+    RecordProperty("ws_plain_cpu_ns_per_msg", static_cast<int>(results[0].cpuMicrosPerMessage * 1000));
+    RecordProperty("ws_deflate_cpu_ns_per_msg", static_cast<int>(results[1].cpuMicrosPerMessage * 1000));
+    // Log lines repeat heavily within a notification; most of the gain needs a
+    // window wide enough to reach back across one
+    EXPECT_LT(results[1].wireRatio, results[0].wireRatio / 3);
+    EXPECT_LT(results[1].wireRatio, results[2].wireRatio);
+}
+
+// Subscribing to thousands of accounts at once: one frame per request against
+// the write queue coalescing what piles up behind each write into a batch
+TEST_F(NetworkBenchmark, WebSocketBatchedSubscribeThroughput)
+{
+    constexpr std::size_t count = 5000;
+    const auto single = subscribeThroughWebSocket(count, 1);
+    const auto batched = subscribeThroughWebSocket(count, 100);
+    std::cout << "[ BENCH    ] " << count << " accountSubscribes: one per frame " << single.perSecond << "/s in "
+              << single.frames << " frames, batched " << batched.perSecond << "/s in " << batched.frames << " frames\n";
+    RecordProperty("ws_subscribes_per_sec_single", static_cast<int>(single.perSecond));
+    RecordProperty("ws_subscribes_per_sec_batched", static_cast<int>(batched.perSecond));
+    EXPECT_EQ(single.frames, count);
+    EXPECT_LT(batched.frames, count / 10);
+    EXPECT_GT(batched.perSecond, single.perSecond);
+}
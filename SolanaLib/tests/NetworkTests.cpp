@@ -1,6 +1,19 @@
 #include <gtest/gtest.h>
+#include "Solana/Network/BoundedQueue.hpp"
+#include "Solana/Network/DnsCache.hpp"
+#include "Solana/Network/EndpointGroup.hpp"
+#include "Solana/Network/HappyEyeballs.hpp"
 #include "Solana/Network/HttpClient.hpp"
 #include "Solana/Network/WebSocket.hpp"
+#include "Solana/Rpc/SubscriptionManager.hpp"
+#include "Solana/Rpc/WebSocketPool.hpp"
+#include "StubServer.hpp"
+#include "Http2StubServer.hpp"
+#include "WebSocketStubServer.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <set>
 
 using namespace Solana::Network;
 using json = nlohmann::json;
@@ -90,6 +103,1143 @@ TEST_F(HttpClientTest, ConnectsToValidSite)
     }
 }
 
+class ConnectionPoolTest : public ::testing::Test
+{
+protected:
+    static std::string reply(const std::string &)
+    {
+        return R"({"jsonrpc":"2.0","id":"1","result":"ok"})";
+    }
+
+    // Streams go back to the pool just after the reply is delivered
+    static ConnectionPoolStats settledStats(const HttpClient &client)
+    {
+        for (int i = 0; i < 100 && client.poolStats().inUse > 0; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return client.poolStats();
+    }
+
+    json payload = json{{"jsonrpc", "2.0"}, {"id", "1"}, {"method", "getSlot"}};
+};
+
+TEST_F(ConnectionPoolTest, ReusesKeepAliveConnections)
+{
+    Solana::Testing::StubServer server(reply);
+    HttpClient client(Url(server.url()));
+
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+        settledStats(client);
+    }
+
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 4u);
+    EXPECT_EQ(stats.idle, 1u);
+    EXPECT_EQ(server.connections(), 1u);
+}
+
+TEST_F(ConnectionPoolTest, DropsConnectionsWithoutKeepAlive)
+{
+    Solana::Testing::StubServer server(reply, {.keepAlive = false});
+    HttpClient client(Url(server.url()));
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+        settledStats(client);
+    }
+
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.idle, 0u);
+    EXPECT_EQ(server.connections(), 3u);
+}
+
+TEST_F(ConnectionPoolTest, DiscardsConnectionsClosedByServer)
+{
+    Solana::Testing::StubServer server(reply, {.closeAfterReply = true});
+    HttpClient client(Url(server.url()));
+
+    EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+    settledStats(client);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50)); // let the FIN arrive
+
+    EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_GE(stats.evictions, 1u);
+}
+
+TEST_F(ConnectionPoolTest, CapsIdleConnectionsPerHost)
+{
+    Solana::Testing::StubServer server(reply);
+    HttpClient client(Url(server.url()), {.pool = {.maxIdlePerHost = 2}});
+
+    std::vector<std::future<TestResponse>> replies;
+    for (int i = 0; i < 8; ++i)
+    {
+        replies.push_back(client.post<TestResponse>(payload));
+    }
+    for (auto &f : replies)
+    {
+        EXPECT_EQ(f.get().result, "ok");
+    }
+
+    const auto stats = settledStats(client);
+    EXPECT_LE(stats.idle, 2u);
+    EXPECT_EQ(stats.inUse, 0u);
+    EXPECT_EQ(stats.idle + stats.evictions, stats.misses);
+}
+
+TEST_F(ConnectionPoolTest, ExpiresIdleConnections)
+{
+    Solana::Testing::StubServer server(reply);
+    HttpClient client(Url(server.url()), {.pool = {.idleTimeout = std::chrono::milliseconds(20)}});
+
+    EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+    settledStats(client);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(server.connections(), 2u);
+}
+
+TEST_F(ConnectionPoolTest, ResumesTlsSessionsOnNewConnections)
+{
+    Solana::Testing::StubServer server(reply, {.keepAlive = false});
+    HttpClient client(Url(server.url()));
+
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+        settledStats(client);
+    }
+
+    const auto tls = client.tlsStats();
+    EXPECT_EQ(server.connections(), 4u);
+    EXPECT_EQ(tls.fullHandshakes, 1u);
+    EXPECT_EQ(tls.resumed, 3u);
+}
+
+TEST_F(ConnectionPoolTest, WarmsConnectionsAheadOfRequests)
+{
+    Solana::Testing::StubServer server(reply);
+    HttpClient client(Url(server.url()));
+
+    EXPECT_EQ(client.warmup(3).get(), 3u);
+    EXPECT_EQ(settledStats(client).idle, 3u);
+
+    EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(server.connections(), 3u);
+}
+
+// A single IO thread must keep running while requests wait for the per-host limit
+TEST_F(ConnectionPoolTest, QueuesRequestsAtTheConnectionLimit)
+{
+    Solana::Testing::StubServer server(reply, {.delay = std::chrono::milliseconds(20)});
+    HttpClient client(Url(server.url()), {.threads = 1, .pool = {.maxTotalPerHost = 2}});
+
+    std::vector<std::future<TestResponse>> replies;
+    for (int i = 0; i < 6; ++i)
+    {
+        replies.push_back(client.post<TestResponse>(payload));
+    }
+    for (auto &f : replies)
+    {
+        ASSERT_EQ(f.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+        EXPECT_EQ(f.get().result, "ok");
+    }
+
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.waited, 4u);
+    EXPECT_EQ(stats.abandoned, 0u);
+    EXPECT_LE(server.connections(), 2u);
+}
+
+TEST_F(ConnectionPoolTest, QueuedRequestsHonourDeadlinesAndCancellation)
+{
+    Solana::Testing::StubServer server(reply, {.delay = std::chrono::milliseconds(300)});
+    HttpClient client(Url(server.url()), {.threads = 1, .pool = {.maxTotalPerHost = 1}});
+
+    auto busy = client.post<TestResponse>(payload);
+    auto late = client.post<TestResponse>(payload, {.timeout = std::chrono::milliseconds(50)});
+    auto token = std::make_shared<CancellationToken>();
+    auto cancelled = client.post<TestResponse>(payload, {.cancellation = token});
+    token->cancel();
+
+    const auto code = [](std::future<TestResponse> &f)
+    {
+        try
+        {
+            f.get();
+        }
+        catch (const boost::system::system_error &e)
+        {
+            return e.code();
+        }
+        return boost::system::error_code{};
+    };
+    EXPECT_EQ(code(cancelled), Error::Cancelled);
+    EXPECT_EQ(code(late), Error::QueueTimeout);
+    EXPECT_EQ(busy.get().result, "ok");
+
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.waited, 2u);
+    EXPECT_EQ(stats.abandoned, 2u);
+    EXPECT_EQ(server.connections(), 1u);
+}
+
+TEST_F(ConnectionPoolTest, ReplacesIdleConnectionsClosedByServer)
+{
+    Solana::Testing::StubServer server(reply, {.closeAfterReply = true});
+    HttpClient client(Url(server.url()), {.pool = {.maintenanceInterval = std::chrono::milliseconds(20), .minIdlePerHost = 1}});
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(client.post<TestResponse>(payload).get().result, "ok");
+        // Long enough for the FIN to arrive and the next maintenance pass to reconnect
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    const auto stats = settledStats(client);
+    EXPECT_EQ(stats.deadOnPickup, 0u);
+    EXPECT_GE(stats.hits, 2u);
+    EXPECT_GE(stats.deadOnProbe, 3u);
+    EXPECT_GE(stats.replenished, 3u);
+    EXPECT_EQ(stats.idle, 1u);
+}
+
+// Each reply echoes the request id, so any FIFO mismatch shows up as a wrong result
+TEST(HttpPipeliningTest, MatchesResponsesInOrderOverFewConnections)
+{
+    Solana::Testing::StubServer server([](const std::string &body)
+                                       { return json{{"result", json::parse(body)["id"].get<std::string>()}}.dump(); });
+    HttpClient client(Url(server.url()), {.pipelineConnections = 2, .pipelineDepth = 8});
+
+    std::vector<std::future<TestResponse>> replies;
+    for (int i = 0; i < 50; ++i)
+    {
+        replies.push_back(client.post<TestResponse>(json{{"jsonrpc", "2.0"}, {"id", std::to_string(i)}, {"method", "getSlot"}}));
+    }
+    for (int i = 0; i < 50; ++i)
+    {
+        EXPECT_EQ(replies[i].get().result, std::to_string(i));
+    }
+
+    EXPECT_LE(server.connections(), 2u);
+    EXPECT_EQ(server.requests(), 50u);
+}
+
+TEST(HttpPipeliningTest, ReconnectsAfterServerCloses)
+{
+    Solana::Testing::StubServer server([](const std::string &)
+                                       { return R"({"result":"ok"})"; },
+                                       {.keepAlive = false});
+    HttpClient client(Url(server.url()), {.pipelineConnections = 1, .pipelineDepth = 1});
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(client.post<TestResponse>(json{{"id", "1"}}).get().result, "ok");
+    }
+    EXPECT_EQ(server.connections(), 3u);
+}
+
+// The server advertises keep-alive but closes the stream once it has answered
+TEST(HttpPipeliningTest, ResendsOverAStreamClosedWhileIdle)
+{
+    Solana::Testing::StubServer server([](const std::string &)
+                                       { return R"({"result":"ok"})"; },
+                                       {.closeAfterReply = true});
+    HttpClient client(Url(server.url()), {.pipelineConnections = 1, .pipelineDepth = 4});
+
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(client.post<TestResponse>(json{{"id", "1"}}).get().result, "ok");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_EQ(server.connections(), 3u);
+    EXPECT_EQ(server.requests(), 3u);
+}
+
+net::awaitable<void> postSequentially(HttpClient &client, std::vector<std::string> &results)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        const auto body = json{{"id", std::to_string(i)}};
+        auto reply = co_await client.asyncPost<TestResponse>(body, net::use_awaitable);
+        results.push_back(reply.result);
+    }
+}
+
+TEST(HttpClientAsyncTest, AwaitsRepliesWithoutBlocking)
+{
+    Solana::Testing::StubServer server([](const std::string &body)
+                                       { return json{{"result", json::parse(body)["id"].get<std::string>()}}.dump(); });
+    HttpClient client(Url(server.url()));
+    net::io_context ioc;
+
+    std::vector<std::string> results;
+    net::co_spawn(ioc, postSequentially(client, results), net::detached);
+    ioc.run();
+
+    EXPECT_EQ(results, (std::vector<std::string>{"0", "1", "2"}));
+}
+
+TEST(HttpClientAsyncTest, DeliversParseErrorsToTheHandler)
+{
+    Solana::Testing::StubServer server([](const std::string &)
+                                       { return "not json"; });
+    HttpClient client(Url(server.url()));
+    net::io_context ioc;
+
+    std::exception_ptr error;
+    client.asyncPost<TestResponse>(json{{"id", "1"}}, net::bind_executor(ioc, [&](std::exception_ptr ex, TestResponse)
+                                                                          { error = ex; }));
+    ioc.run();
+
+    EXPECT_TRUE(error);
+}
+
+// Returns the Network::Error code the request failed with, or {} if it succeeded
+template <typename Future>
+boost::system::error_code failureCode(Future &&reply)
+{
+    try
+    {
+        reply.get();
+    }
+    catch (const boost::system::system_error &e)
+    {
+        return e.code();
+    }
+    return {};
+}
+
+TEST(HttpClientDeadlineTest, FailsSlowRepliesWithReadTimeout)
+{
+    Solana::Testing::StubServer server([](const std::string &)
+                                       { return R"({"result":"ok"})"; },
+                                       {.delay = std::chrono::milliseconds(500)});
+    HttpClient client(Url(server.url()));
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto code = failureCode(client.post<TestResponse>(json{{"id", "1"}}, {.timeout = std::chrono::milliseconds(50)}));
+
+    EXPECT_EQ(code, Error::ReadTimeout);
+    EXPECT_TRUE(isTimeout(code));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(400));
+}
+
+TEST(HttpClientDeadlineTest, CancelsInFlightRequests)
+{
+    Solana::Testing::StubServer server([](const std::string &)
+                                       { return R"({"result":"ok"})"; },
+                                       {.delay = std::chrono::milliseconds(500)});
+    HttpClient client(Url(server.url()));
+
+    auto cancellation = std::make_shared<CancellationToken>();
+    auto reply = client.post<TestResponse>(json{{"id", "1"}}, {.cancellation = cancellation});
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    cancellation->cancel();
+
+    EXPECT_EQ(failureCode(reply), Error::Cancelled);
+}
+
+// A token shared by many requests only keeps callbacks for those still registered
+TEST(CancellationTokenTest, RegistrationsRemoveTheirCallbacks)
+{
+    CancellationToken token;
+    auto kept = std::make_shared<int>(0);
+    auto dropped = std::make_shared<int>(0);
+    auto keep = token.onCancel([kept]()
+                               { ++*kept; });
+    {
+        auto registration = token.onCancel([dropped]()
+                                           { ++*dropped; });
+        EXPECT_EQ(dropped.use_count(), 2);
+    }
+    EXPECT_EQ(dropped.use_count(), 1);
+
+    token.cancel();
+    EXPECT_EQ(*kept, 1);
+    EXPECT_EQ(*dropped, 0);
+
+    // Already cancelled: runs at once and registers nothing
+    auto late = token.onCancel([kept]()
+                               { ++*kept; });
+    EXPECT_EQ(*kept, 2);
+    EXPECT_EQ(kept.use_count(), 1);
+}
+
+TEST(HttpClientDeadlineTest, AppliesDeadlinesToPipelinedRequests)
+{
+    Solana::Testing::StubServer server([](const std::string &)
+                                       { return R"({"result":"ok"})"; },
+                                       {.delay = std::chrono::milliseconds(500)});
+    HttpClient client(Url(server.url()), {.pipelineConnections = 1});
+
+    const auto code = failureCode(client.post<TestResponse>(json{{"id", "1"}}, {.timeout = std::chrono::milliseconds(50)}));
+
+    EXPECT_EQ(code, Error::ReadTimeout);
+}
+
+#if SOLANA_HAS_HTTP2
+// Replies echo the request id and are held back longer the earlier the request,
+// so streams finish in the reverse of the order they were opened
+TEST(Http2Test, MatchesStreamsThatCompleteOutOfOrder)
+{
+    constexpr int count = 20;
+    const auto id = [](const std::string &body)
+    { return std::stoi(json::parse(body)["id"].get<std::string>()); };
+    Solana::Testing::Http2StubServer server([&](const std::string &body)
+                                            { return json{{"result", std::to_string(id(body))}}.dump(); },
+                                            {.delay = [&](const std::string &body)
+                                             { return std::chrono::microseconds(std::chrono::milliseconds(10 * (count - id(body)))); }});
+    std::mutex mutex;
+    std::vector<std::pair<int, std::string>> completed;
+    std::promise<void> all;
+    HttpClient client(Url(server.url()), {.http2Connections = 1});
+
+    for (int i = 0; i < count; ++i)
+    {
+        client.asyncPost<TestResponse>(json{{"id", std::to_string(i)}}, [&, i](std::exception_ptr ex, TestResponse reply)
+                                       {
+            std::lock_guard<std::mutex> lock(mutex);
+            completed.emplace_back(i, ex ? "failed" : reply.result);
+            if (completed.size() == count)
+                all.set_value(); });
+    }
+    ASSERT_EQ(all.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(completed[i].first, count - 1 - i);
+        EXPECT_EQ(completed[i].second, std::to_string(completed[i].first));
+    }
+    EXPECT_EQ(server.connections(), 1u);
+}
+
+TEST(Http2Test, FailsWhenTheServerDoesNotNegotiateH2)
+{
+    Solana::Testing::Http2StubServer server([](const std::string &)
+                                            { return R"({"result":"ok"})"; },
+                                            {.alpn = false});
+    HttpClient client(Url(server.url()), {.http2Connections = 1});
+
+    EXPECT_EQ(client.warmup(1).get(), 0u);
+    EXPECT_EQ(failureCode(client.post<TestResponse>(json{{"id", "1"}})),
+              boost::system::errc::make_error_code(boost::system::errc::protocol_not_supported));
+    EXPECT_EQ(server.requests(), 0u);
+}
+
+// A stream that runs out of time fails alone: the others on the connection finish,
+// its late reply is dropped, and the connection stays in use
+TEST(Http2Test, DeadlineOnOneStreamLeavesTheOthersRunning)
+{
+    Solana::Testing::Http2StubServer server([](const std::string &body)
+                                            { return json{{"result", json::parse(body)["id"]}}.dump(); },
+                                            {.delay = [](const std::string &body)
+                                             { return std::chrono::microseconds(json::parse(body)["id"] == "slow" ? std::chrono::milliseconds(300) : std::chrono::milliseconds(100)); }});
+    HttpClient client(Url(server.url()), {.http2Connections = 1});
+
+    auto slow = client.post<TestResponse>(json{{"id", "slow"}}, {.timeout = std::chrono::milliseconds(50)});
+    std::vector<std::future<TestResponse>> others;
+    for (int i = 0; i < 5; ++i)
+    {
+        others.push_back(client.post<TestResponse>(json{{"id", std::to_string(i)}}));
+    }
+
+    EXPECT_EQ(failureCode(slow), Error::ReadTimeout);
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(others[i].get().result, std::to_string(i));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(client.post<TestResponse>(json{{"id", "after"}}).get().result, "after");
+    EXPECT_EQ(server.connections(), 1u);
+    EXPECT_EQ(server.requests(), 7u);
+}
+#endif
+
+TEST(EndpointGroupTest, HedgesSlowRequestsToTheNextEndpoint)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"result":"ok"})"); };
+    Solana::Testing::StubServer slow(reply, {.delay = std::chrono::milliseconds(300)});
+    Solana::Testing::StubServer fast(reply);
+    // Neither endpoint has been measured yet, so the first one listed goes first
+    EndpointGroup group({slow.url(), fast.url()}, {}, {.initialDelay = std::chrono::milliseconds(20)});
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(group.post<TestResponse>(json{{"id", "1"}}, {.idempotent = true}).get().result, "ok");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+
+    const auto stats = group.stats();
+    EXPECT_EQ(stats[0].requests, 1u);
+    EXPECT_EQ(stats[1].hedges, 1u);
+    EXPECT_EQ(stats[1].hedgeWins, 1u);
+
+    // The loser's time until cancellation counts against it, so the fast endpoint now leads
+    EXPECT_EQ(group.post<TestResponse>(json{{"id", "2"}}, {.idempotent = true}).get().result, "ok");
+    EXPECT_EQ(group.stats()[1].requests, 2u);
+}
+
+// A hedge cancelled moments after it was sent only bounds its endpoint's latency
+// from below, so it must not make that endpoint look fast
+TEST(EndpointGroupTest, HedgeLosersDoNotLowerLatencyEstimates)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"result":"ok"})"); };
+    Solana::Testing::StubServer quick(reply, {.delay = std::chrono::milliseconds(30)});
+    Solana::Testing::StubServer slow(reply, {.delay = std::chrono::milliseconds(200)});
+    EndpointGroup group({quick.url(), slow.url()}, {}, {.initialDelay = std::chrono::milliseconds(20)});
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(group.post<TestResponse>(json{{"id", "1"}}, {.idempotent = true}).get().result, "ok");
+    }
+
+    // The slow endpoint only ever loses, often cancelled a few ms in. It may lead
+    // while the quick one's first sample still carries its TLS handshake, but those
+    // early cancellations must not keep it in front.
+    const auto stats = group.stats();
+    EXPECT_EQ(stats[1].hedgeWins, 0u);
+    EXPECT_LE(stats[0].hedges, 3u);
+    EXPECT_GT(stats[1].ewmaLatency, stats[0].ewmaLatency);
+}
+
+TEST(EndpointGroupTest, NeverHedgesNonIdempotentRequests)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"result":"ok"})"); };
+    Solana::Testing::StubServer slow(reply, {.delay = std::chrono::milliseconds(100)});
+    Solana::Testing::StubServer fast(reply);
+    EndpointGroup group({slow.url(), fast.url()}, {}, {.initialDelay = std::chrono::milliseconds(10)});
+
+    EXPECT_EQ(group.post<TestResponse>(json{{"id", "1"}}).get().result, "ok");
+    EXPECT_EQ(slow.requests(), 1u);
+    EXPECT_EQ(fast.requests(), 0u);
+}
+
+TEST(EndpointGroupTest, PrefersTheHealthyEndpoint)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"result":"ok"})"); };
+    Solana::Testing::StubServer failing(reply, {.status = 503});
+    Solana::Testing::StubServer healthy(reply);
+    EndpointGroup group({failing.url(), healthy.url()});
+
+    std::size_t ok = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        try
+        {
+            ok += group.post<TestResponse>(json{{"id", "1"}}).get().result == "ok";
+        }
+        catch (const HttpStatusError &e)
+        {
+            EXPECT_EQ(e.status(), 503u);
+        }
+    }
+
+    // Only the first request, sent before anything was known, reached the failing endpoint
+    EXPECT_EQ(failing.requests(), 1u);
+    EXPECT_EQ(ok, 9u);
+    EXPECT_GT(group.stats()[0].errorRate, 0.0);
+}
+
+// A 200 that is not a JSON-RPC reply (here a proxy's error page) is the
+// endpoint failing, not an answer to pass on
+TEST(EndpointGroupTest, FailsOverFromUnparseableReplies)
+{
+    Solana::Testing::StubServer proxy([](const std::string &)
+                                      { return "<html>502 Bad Gateway</html>"; });
+    Solana::Testing::StubServer healthy([](const std::string &)
+                                        { return std::string(R"({"result":"ok"})"); });
+    EndpointGroup group({proxy.url(), healthy.url()}, {}, {.initialDelay = std::chrono::seconds(1)});
+
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(group.post<TestResponse>(json{{"id", "1"}}, {.idempotent = true}).get().result, "ok");
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+
+    const auto stats = group.stats();
+    EXPECT_EQ(stats[0].failures, 1u);
+    EXPECT_GT(stats[0].errorRate, 0.0);
+    EXPECT_EQ(stats[1].hedgeWins, 1u);
+}
+
+TEST(EndpointGroupTest, OpensTheCircuitOnRepeatedFailures)
+{
+    Solana::Testing::StubServer failing([](const std::string &)
+                                        { return "overloaded"; },
+                                        {.status = 503});
+    EndpointGroup group({failing.url()}, {}, {}, {.failureThreshold = 2});
+
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_THROW(group.post<TestResponse>(json{{"id", "1"}}).get(), HttpStatusError);
+    }
+    EXPECT_TRUE(group.stats()[0].circuitOpen);
+
+    // With nowhere else to go the request is still sent rather than rejected
+    EXPECT_THROW(group.post<TestResponse>(json{{"id", "1"}}).get(), HttpStatusError);
+    EXPECT_EQ(failing.requests(), 3u);
+}
+
+TEST(EndpointGroupTest, RetriesRateLimitedRequestsElsewhere)
+{
+    const auto reply = [](const std::string &)
+    { return std::string(R"({"result":"ok"})"); };
+    Solana::Testing::StubServer limited(reply, {.status = 429, .retryAfter = "30"});
+    Solana::Testing::StubServer healthy(reply);
+    EndpointGroup group({limited.url(), healthy.url()});
+
+    // Not idempotent, but a 429 means the request was never processed
+    for (int i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(group.post<TestResponse>(json{{"id", "1"}}).get().result, "ok");
+    }
+
+    const auto stats = group.stats();
+    EXPECT_EQ(stats[0].rateLimited, 1u);
+    EXPECT_TRUE(stats[0].circuitOpen);
+    EXPECT_EQ(limited.requests(), 1u);
+    EXPECT_EQ(healthy.requests(), 5u);
+}
+
+TEST(DnsCacheTest, ReusesAddressesUntilInvalidated)
+{
+    net::io_context ioc;
+    auto cache = std::make_shared<DnsCache>();
+    std::vector<DnsCache::Endpoints> answers;
+    const auto lookup = [&]()
+    {
+        cache->resolve(ioc.get_executor(), "localhost", "443", [&](boost::system::error_code ec, DnsCache::Endpoints endpoints)
+                       {
+            EXPECT_FALSE(ec) << ec.message();
+            answers.push_back(std::move(endpoints)); });
+        ioc.restart();
+        ioc.run();
+    };
+
+    lookup();
+    lookup();
+    cache->invalidate("localhost", "443");
+    lookup();
+
+    ASSERT_EQ(answers.size(), 3u);
+    ASSERT_FALSE(answers[0].empty());
+    EXPECT_EQ(answers[0], answers[1]);
+    EXPECT_EQ(cache->stats().hits, 1u);
+    EXPECT_EQ(cache->stats().misses, 2u);
+}
+
+TEST(HappyEyeballsTest, RacesPastAnAddressThatHangs)
+{
+    net::io_context ioc;
+    tcp::acceptor listener(ioc, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0));
+    // Non-routable, so a connect to it hangs (or fails outright on hosts without a route)
+    const std::vector<tcp::endpoint> endpoints{
+        {net::ip::make_address("10.255.255.1"), listener.local_endpoint().port()},
+        listener.local_endpoint(),
+    };
+
+    boost::system::error_code result = net::error::would_block;
+    unsigned short connectedTo = 0;
+    const auto start = std::chrono::steady_clock::now();
+    HappyEyeballs::connect(
+        ioc.get_executor(), endpoints, start + std::chrono::seconds(5),
+        [&](boost::system::error_code ec, HappyEyeballs::Socket socket)
+        {
+            result = ec;
+            if (!ec)
+                connectedTo = socket.remote_endpoint().port();
+        },
+        std::chrono::milliseconds(50));
+    ioc.run();
+
+    EXPECT_FALSE(result) << result.message();
+    EXPECT_EQ(connectedTo, listener.local_endpoint().port());
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+}
+
+// Polls until done() holds, for state changed by another thread
+template <typename Done>
+bool eventually(Done done, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+{
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+TEST(WebSocketReconnectTest, ResubscribesAndReportsMissedSlots)
+{
+    Solana::Testing::WebSocketStubServer server;
+    net::io_context ioc;
+    // The stub's certificate is self-signed; the default context does not verify
+    ssl::context ctx(ssl::context::tlsv12_client);
+    auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .reconnect = {.initialBackoff = std::chrono::milliseconds(20), .maxBackoff = std::chrono::milliseconds(100)}});
+    Solana::SubscriptionManager manager([ws](std::string message)
+                                        { ws->doWrite(std::move(message)); });
+    ws->onReconnect([&manager]()
+                    { manager.replay(); });
+
+    std::mutex mutex;
+    std::vector<std::uint64_t> slots;
+    std::vector<Solana::SubscriptionGap> gaps;
+    manager.onGap([&](const Solana::SubscriptionGap &gap)
+                  {
+        std::lock_guard<std::mutex> lock(mutex);
+        gaps.push_back(gap); });
+    const auto received = [&]()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return slots.size();
+    };
+
+    std::thread thread([&]()
+                       { ws->start({}, [&manager](PooledBuffer &&message)
+                                   { manager.onMessage(message.view()); }, 0); });
+
+    auto handle = manager.subscribe("accountSubscribe", json::array({"vines1vzrYbzLMRdu58ou5XTby4qAqVRLmqo36NKPTg"}),
+                                    [&](const Solana::Encoding::JsonView &result)
+                                    {
+                                        std::lock_guard<std::mutex> lock(mutex);
+                                        slots.push_back(result["context"]["slot"].get<std::uint64_t>());
+                                    });
+    ASSERT_EQ(handle.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    const auto id = handle.get();
+    server.publish(100);
+    ASSERT_TRUE(eventually([&]()
+                           { return received() == 1; }));
+
+    constexpr int drops = 3;
+    for (int i = 1; i <= drops; ++i)
+    {
+        server.drop();
+        ASSERT_TRUE(eventually([&]()
+                               { return server.subscribeRequests() == 1u + i; }));
+        server.publish(100 + 10 * i);
+        ASSERT_TRUE(eventually([&]()
+                               { return received() == 1u + i; }));
+    }
+
+    ws->stop();
+    thread.join();
+
+    EXPECT_EQ(slots, (std::vector<std::uint64_t>{100, 110, 120, 130}));
+    ASSERT_EQ(gaps.size(), drops);
+    for (int i = 0; i < drops; ++i)
+    {
+        EXPECT_EQ(gaps[i].handle, id);
+        EXPECT_EQ(gaps[i].firstSlot, 101u + 10 * i);
+        EXPECT_EQ(gaps[i].lastSlot, 109u + 10 * i);
+    }
+    EXPECT_EQ(manager.lastSlot(id), 130u);
+
+    const auto stats = ws->stats();
+    EXPECT_EQ(stats.connects, 1u + drops);
+    EXPECT_EQ(stats.disconnects, drops);
+    EXPECT_GT(stats.recoverP99.count(), 0);
+    EXPECT_LT(stats.recoverP99, std::chrono::seconds(2));
+    EXPECT_EQ(server.connections(), 1u + drops);
+}
+
+TEST(BoundedQueueTest, HandsEveryItemToExactlyOneConsumer)
+{
+    BoundedQueue<int> queue(64);
+    constexpr int producers = 4;
+    constexpr int perProducer = 20000;
+    std::atomic<long long> sum = 0;
+    std::atomic<int> popped = 0;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&queue, p]()
+                             {
+            for (int i = 1; i <= perProducer; ++i)
+            {
+                int value = p * perProducer + i;
+                while (!queue.tryPush(std::move(value)))
+                    std::this_thread::yield();
+            } });
+        threads.emplace_back([&]()
+                             {
+            int value = 0;
+            while (popped < producers * perProducer)
+            {
+                if (queue.tryPop(value))
+                {
+                    sum += value;
+                    ++popped;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const long long total = producers * perProducer;
+    EXPECT_EQ(sum, total * (total + 1) / 2);
+    int left = 0;
+    EXPECT_FALSE(queue.tryPop(left));
+}
+
+// Streams `count` notifications to a WebSocket whose handler runs on dispatch
+// workers, returning once `done` holds for its stats or the wait times out
+template <typename Handler, typename Done>
+WebSocketStats dispatchThroughWebSocket(const DispatchConfig &dispatch, std::size_t count, Handler handler, Done done)
+{
+    Solana::Testing::WebSocketStubServer server;
+    net::io_context ioc;
+    ssl::context ctx(ssl::context::tlsv12_client);
+    auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .dispatch = dispatch});
+    std::thread reader([&]()
+                       { ws->start({R"({"jsonrpc":"2.0","id":1,"method":"slotSubscribe"})"}, handler, 1); });
+
+    EXPECT_TRUE(eventually([&]()
+                           { return server.subscribeRequests() == 1; }));
+    std::vector<std::string> messages;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        messages.push_back(R"({"jsonrpc":"2.0","method":"slotNotification","params":{"result":{"slot":)" + std::to_string(i) + R"(},"subscription":1}})");
+    }
+    server.broadcast(std::move(messages));
+    EXPECT_TRUE(eventually([&]()
+                           { return done(ws->stats().dispatch); }));
+    ws->stop();
+    reader.join();
+    return ws->stats();
+}
+
+TEST(WebSocketDispatchTest, SlowHandlersDoNotStallReads)
+{
+    constexpr std::size_t count = 40;
+    constexpr auto handlerTime = std::chrono::milliseconds(20);
+    std::atomic<std::size_t> handled = 0;
+    const auto start = std::chrono::steady_clock::now();
+    // A small queue, so the reader also has to wait for room now and then
+    const auto stats = dispatchThroughWebSocket(
+        {.workers = 4, .queueCapacity = 8}, count,
+        [&handled, handlerTime](PooledBuffer &&message)
+        {
+            EXPECT_GT(message.size(), 0u);
+            std::this_thread::sleep_for(handlerTime);
+            ++handled;
+        },
+        [](const DispatchStats &dispatch)
+        { return dispatch.handled == count + 1; });
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(handled, count + 1);
+    EXPECT_EQ(stats.dispatch.dropped, 0u);
+    EXPECT_LE(stats.dispatch.highWater, 8u);
+    EXPECT_GE(stats.dispatch.handlerP50, handlerTime);
+    EXPECT_GT(stats.dispatch.queuedP99, handlerTime);
+    // One thread would need (count + 1) * handlerTime
+    EXPECT_LT(elapsed, (count + 1) * handlerTime / 2);
+}
+
+TEST(WebSocketDispatchTest, DropsNewestMessagesWhenTheQueueIsFull)
+{
+    constexpr std::size_t count = 50;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<std::size_t> handled = 0;
+    std::thread releaser([&]()
+                         {
+        // The only worker is stuck in the first message while the rest pile up
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        release.set_value(); });
+    const auto stats = dispatchThroughWebSocket(
+        {.workers = 1, .queueCapacity = 4, .overflow = OverflowPolicy::DropNewest}, count,
+        [&handled, released](PooledBuffer &&)
+        {
+            released.wait();
+            ++handled;
+        },
+        [](const DispatchStats &dispatch)
+        { return dispatch.handled + dispatch.dropped == count + 1 && dispatch.depth == 0; });
+    releaser.join();
+
+    // One message in the handler and four queued; everything after them was dropped
+    EXPECT_EQ(stats.dispatch.handled, 5u);
+    EXPECT_EQ(stats.dispatch.dropped, count + 1 - 5);
+    EXPECT_EQ(handled, 5u);
+}
+
+// Captured log notifications come through a deflate-compressed connection byte
+// for byte, and a client that does not ask for compression still gets plain frames
+TEST(WebSocketCompressionTest, NegotiatesDeflateAndDeliversMessagesIntact)
+{
+    websocket::permessage_deflate deflate;
+    deflate.server_enable = true;
+    Solana::Testing::WebSocketStubServer server(deflate);
+    const auto captured = Solana::Testing::capturedLogNotifications();
+    const std::vector<std::string> messages(captured.begin(), captured.begin() + std::min<std::size_t>(captured.size(), 50));
+
+    for (const bool enabled : {true, false})
+    {
+        net::io_context ioc;
+        ssl::context ctx(ssl::context::tlsv12_client);
+        auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .compression = {.enabled = enabled}});
+        std::vector<std::string> received;
+        std::thread reader([&]()
+                           { ws->start({R"({"jsonrpc":"2.0","id":1,"method":"logsSubscribe","params":["all"]})"}, [&](PooledBuffer &&message)
+                                       {
+                // Skip the subscribe reply
+                if (message.view().find("logsNotification") != std::string_view::npos)
+                    received.emplace_back(message.view());
+                if (received.size() == messages.size())
+                    ws->stop(); }, 1); });
+
+        const auto requests = server.subscribeRequests();
+        ASSERT_TRUE(eventually([&]()
+                               { return server.subscribeRequests() > requests; }));
+        server.broadcast(messages);
+        reader.join();
+        EXPECT_EQ(received, messages);
+        EXPECT_EQ(ws->stats().compressed, enabled);
+    }
+}
+
+// Subscribes made in a burst queue up behind the write in flight and go out as
+// JSON-RPC batches, each request still answered and resolved on its own
+TEST(WebSocketWriteQueueTest, BatchesQueuedSubscribes)
+{
+    constexpr std::size_t count = 500;
+    Solana::Testing::WebSocketStubServer server;
+    net::io_context ioc;
+    ssl::context ctx(ssl::context::tlsv12_client);
+    auto ws = WebSocket::create(ioc, ctx, {.host = "127.0.0.1", .port = std::to_string(server.port()), .writeBatch = 50});
+    Solana::SubscriptionManager manager([&ws](std::string message)
+                                        { ws->doWrite(std::move(message)); });
+    std::thread reader([&]()
+                       { ws->start({}, [&manager](PooledBuffer &&message)
+                                   { manager.onMessage(message.view()); }, 1); });
+    ASSERT_TRUE(eventually([&]()
+                           { return ws->stats().connects == 1; }));
+
+    std::vector<std::future<Solana::u64>> handles;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        handles.push_back(manager.subscribe("accountSubscribe", json::array({"account" + std::to_string(i)}),
+                                            [](const Solana::Encoding::JsonView &) {}));
+    }
+    std::set<Solana::u64> distinct;
+    for (auto &handle : handles)
+    {
+        ASSERT_EQ(handle.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+        distinct.insert(handle.get());
+    }
+    ws->stop();
+    reader.join();
+
+    EXPECT_EQ(distinct.size(), count);
+    EXPECT_EQ(server.subscribeRequests(), count);
+    EXPECT_EQ(manager.stats().active, count);
+    const auto stats = ws->stats();
+    EXPECT_EQ(stats.messagesWritten, count);
+    EXPECT_EQ(stats.framesWritten, server.framesReceived());
+    EXPECT_LE(stats.framesWritten, count / 5);
+}
+
+// Subscribes `count` accounts through pool, each handler counting its notifications
+static std::vector<Solana::u64> subscribeAccounts(Solana::WebSocketPool &pool, std::size_t count,
+                                                  std::mutex &mutex, std::vector<int> &received)
+{
+    received.assign(count, 0);
+    std::vector<std::future<Solana::u64>> futures;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        futures.push_back(pool.subscribe("account" + std::to_string(i), "accountSubscribe", json::array({"account" + std::to_string(i)}),
+                                         [&mutex, &received, i](const Solana::Encoding::JsonView &)
+                                         {
+                                             std::lock_guard<std::mutex> lock(mutex);
+                                             ++received[i];
+                                         }));
+    }
+    std::vector<Solana::u64> handles;
+    for (auto &future : futures)
+    {
+        if (future.wait_for(std::chrono::seconds(5)) != std::future_status::ready)
+        {
+            break;
+        }
+        handles.push_back(future.get());
+    }
+    return handles;
+}
+
+TEST(WebSocketPoolTest, ShardsByKeyAndSurvivesReconnects)
+{
+    constexpr std::size_t count = 300;
+    Solana::Testing::WebSocketStubServer server;
+    ssl::context ctx(ssl::context::tlsv12_client);
+    Solana::WebSocketPool pool(ctx, {.webSocket = {.host = "127.0.0.1", .port = std::to_string(server.port()), .reconnect = {.initialBackoff = std::chrono::milliseconds(20), .maxBackoff = std::chrono::milliseconds(100)}},
+                                     .shards = 3});
+    std::mutex mutex;
+    std::vector<int> received;
+    const auto handles = subscribeAccounts(pool, count, mutex, received);
+    ASSERT_EQ(handles.size(), count);
+    EXPECT_EQ(std::set<Solana::u64>(handles.begin(), handles.end()).size(), count);
+    EXPECT_EQ(server.connections(), 3u);
+
+    std::vector<std::size_t> expected(3);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        ++expected[pool.shardOf("account" + std::to_string(i))];
+    }
+    auto stats = pool.stats();
+    ASSERT_EQ(stats.shards.size(), 3u);
+    for (std::size_t shard = 0; shard < 3; ++shard)
+    {
+        EXPECT_GT(expected[shard], count / 6);
+        EXPECT_EQ(stats.shards[shard].subscriptions, expected[shard]);
+    }
+
+    const auto allReceived = [&](int n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::all_of(received.begin(), received.end(), [n](int r)
+                           { return r == n; });
+    };
+    server.publish(100);
+    ASSERT_TRUE(eventually([&]()
+                           { return allReceived(1); }));
+
+    // Every shard reconnects and replays its own subscriptions
+    server.drop();
+    ASSERT_TRUE(eventually([&]()
+                           { return server.subscribeRequests() == 2 * count; }));
+    server.publish(101);
+    ASSERT_TRUE(eventually([&]()
+                           { return allReceived(2); }));
+
+    stats = pool.stats();
+    EXPECT_EQ(stats.failovers, 0u);
+    EXPECT_EQ(server.connections(), 6u);
+    ASSERT_EQ(pool.unsubscribe(handles[0]).wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(pool.size(), count - 1);
+}
+
+// A shard that cannot reconnect hands its subscriptions to the others, and gets
+// them back once it can, without any subscription going unserved
+TEST(WebSocketPoolTest, MovesSubscriptionsOffAShardThatStaysDown)
+{
+    constexpr std::size_t count = 300;
+    Solana::Testing::WebSocketStubServer server;
+    ssl::context ctx(ssl::context::tlsv12_client);
+    Solana::WebSocketPool pool(ctx, {.webSocket = {.host = "127.0.0.1", .port = std::to_string(server.port()), .reconnect = {.initialBackoff = std::chrono::milliseconds(20), .maxBackoff = std::chrono::milliseconds(100)}},
+                                     .shards = 3,
+                                     .failoverAfter = std::chrono::milliseconds(200)});
+    std::mutex mutex;
+    std::vector<int> received;
+    ASSERT_EQ(subscribeAccounts(pool, count, mutex, received).size(), count);
+    std::vector<std::size_t> home;
+    for (const auto &shard : pool.stats().shards)
+    {
+        home.push_back(shard.subscriptions);
+    }
+
+    server.refuse(true);
+    server.drop(1);
+    std::size_t down = 0;
+    ASSERT_TRUE(eventually([&]()
+                           {
+        const auto stats = pool.stats();
+        for (std::size_t shard = 0; shard < stats.shards.size(); ++shard)
+        {
+            if (!stats.shards[shard].connected)
+            {
+                down = shard;
+                return true;
+            }
+        }
+        return false; }));
+    ASSERT_TRUE(eventually([&]()
+                           {
+        const auto stats = pool.stats();
+        return stats.failovers == 1 && stats.shards[down].subscriptions == 0; }));
+
+    const auto stats = pool.stats();
+    EXPECT_EQ(stats.shards[0].subscriptions + stats.shards[1].subscriptions + stats.shards[2].subscriptions, count);
+    const auto allReceived = [&](int n)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::all_of(received.begin(), received.end(), [n](int r)
+                           { return r == n; });
+    };
+    server.publish(100);
+    ASSERT_TRUE(eventually([&]()
+                           { return allReceived(1); }));
+
+    server.refuse(false);
+    ASSERT_TRUE(eventually([&]()
+                           {
+        const auto stats = pool.stats();
+        for (std::size_t shard = 0; shard < stats.shards.size(); ++shard)
+        {
+            if (stats.shards[shard].subscriptions != home[shard])
+            {
+                return false;
+            }
+        }
+        return stats.restores == 1; }));
+    server.publish(101);
+    ASSERT_TRUE(eventually([&]()
+                           { return allReceived(2); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(allReceived(2));
+    EXPECT_EQ(pool.size(), count);
+}
+
+// Subscribe replies and notifications must be routed in the order they were read
+TEST(WebSocketPoolTest, DispatchesOnAtMostOneWorker)
+{
+    constexpr std::size_t count = 50;
+    Solana::Testing::WebSocketStubServer server;
+    ssl::context ctx(ssl::context::tlsv12_client);
+    const Solana::Network::WebSocketConfig socket{.host = "127.0.0.1", .port = std::to_string(server.port()), .dispatch = {.workers = 4}};
+    EXPECT_THROW(Solana::WebSocketPool(ctx, {.webSocket = socket}), std::invalid_argument);
+
+    Solana::WebSocketPool pool(ctx, {.webSocket = {.host = "127.0.0.1", .port = std::to_string(server.port()), .dispatch = {.workers = 1}},
+                                     .shards = 1});
+    std::mutex mutex;
+    std::vector<int> received;
+    ASSERT_EQ(subscribeAccounts(pool, count, mutex, received).size(), count);
+    server.publish(100);
+    ASSERT_TRUE(eventually([&]()
+                           {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::all_of(received.begin(), received.end(), [](int r)
+                           { return r == 1; }); }));
+    // Every subscribe reply and notification went through the one worker
+    EXPECT_TRUE(eventually([&]()
+                           { return pool.stats().shards[0].socket.dispatch.handled == 2 * count; }));
+}
+
 // TEST(WebSocketTest, ConnectsAndSendsEcho)
 // {
 //     boost::asio::io_context ioc;
@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
+#include <set>
 #include "Solana/Rpc/Rpc.hpp"
 #include "Solana/Rpc/Methods/GetAccountInfo.hpp"
 #include "Solana/Rpc/Methods/GetSignaturesForAddress.hpp"
+#include "Solana/Rpc/SubscriptionManager.hpp"
+#include "Solana/Rpc/Subscriptions/AccountSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/LogsSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/ProgramSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/SlotSubscribe.hpp"
+#include "StubServer.hpp"
 
 class SolanaRpcTest : public ::testing::Test
 {
@@ -84,3 +91,565 @@ TEST_F(SolanaRpcTest, GetSignaturesForAddressReturnsValidData)
             << "Signature should be equal or older than the 'until' reference";
     }
 }
+
+namespace
+{
+    // Answers a JSON-RPC batch in reverse order with one signature per call, named
+    // after the queried address, so any id mix-up shows up as a wrong signature.
+    // The address "error" gets an RPC error instead.
+    std::string reversedBatchReply(const std::string &body)
+    {
+        const auto calls = json::parse(body);
+        auto replies = json::array();
+        for (auto call = calls.rbegin(); call != calls.rend(); ++call)
+        {
+            const auto &address = (*call)["params"][0];
+            if (address == "error")
+            {
+                replies.push_back({{"jsonrpc", "2.0"}, {"id", (*call)["id"]}, {"error", {{"code", -32602}, {"message", "Invalid param"}}}});
+                continue;
+            }
+            replies.push_back({{"jsonrpc", "2.0"}, {"id", (*call)["id"]}, {"result", json::array({{{"signature", address}, {"slot", 1}}})}});
+        }
+        return replies.dump();
+    }
+}
+
+TEST(RpcBatchTest, SplitsAboveMaxBatchSize)
+{
+    Solana::Testing::StubServer server(reversedBatchReply);
+    Solana::Rpc rpc(server.url(), {}, {.maxBatchSize = 100});
+
+    std::vector<Solana::GetSignaturesForAddress> requests;
+    for (int i = 0; i < 250; ++i)
+    {
+        requests.emplace_back("address" + std::to_string(i));
+    }
+
+    auto replies = rpc.sendBatch(requests);
+    ASSERT_EQ(replies.size(), requests.size());
+    for (int i = 0; i < 250; ++i)
+    {
+        const auto reply = replies[i].get();
+        ASSERT_EQ(reply.result.signatures.size(), 1u);
+        EXPECT_EQ(reply.result.signatures[0].signature, "address" + std::to_string(i));
+    }
+    EXPECT_EQ(server.requests(), 3u);
+}
+
+TEST(RpcBatchTest, ErrorReplyFailsOnlyItsCall)
+{
+    Solana::Testing::StubServer server(reversedBatchReply);
+    Solana::Rpc rpc(server.url());
+
+    auto [first, failed, last] = rpc.sendBatch(Solana::GetSignaturesForAddress("first"),
+                                               Solana::GetSignaturesForAddress("error"),
+                                               Solana::GetSignaturesForAddress("last"));
+
+    EXPECT_EQ(first.get().result.signatures[0].signature, "first");
+    EXPECT_THROW(failed.get(), std::runtime_error);
+    EXPECT_EQ(last.get().result.signatures[0].signature, "last");
+    EXPECT_EQ(server.requests(), 1u);
+}
+
+TEST(RpcBatchTest, CoalescesConcurrentSends)
+{
+    Solana::Testing::StubServer server(reversedBatchReply);
+    Solana::Rpc rpc(server.url(), {}, {.autoBatch = true, .batchWindow = std::chrono::milliseconds(50)});
+
+    std::vector<std::future<Solana::RpcReply<Solana::GetSignaturesForAddress>>> replies;
+    for (int i = 0; i < 10; ++i)
+    {
+        replies.push_back(rpc.send(Solana::GetSignaturesForAddress("address" + std::to_string(i))));
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_EQ(replies[i].get().result.signatures[0].signature, "address" + std::to_string(i));
+    }
+
+    const auto stats = rpc.batchStats();
+    EXPECT_EQ(server.requests(), 1u);
+    EXPECT_EQ(stats.flushes, 1u);
+    EXPECT_EQ(stats.calls, 10u);
+    EXPECT_EQ(stats.fullFlushes, 0u);
+}
+
+TEST(RpcBatchTest, FlushesFullBatchesWithoutWaitingForTheWindow)
+{
+    Solana::Testing::StubServer server(reversedBatchReply);
+    Solana::Rpc rpc(server.url(), {}, {.maxBatchSize = 4, .autoBatch = true, .batchWindow = std::chrono::seconds(10)});
+
+    std::vector<std::future<Solana::RpcReply<Solana::GetSignaturesForAddress>>> replies;
+    for (int i = 0; i < 8; ++i)
+    {
+        replies.push_back(rpc.send(Solana::GetSignaturesForAddress("address" + std::to_string(i))));
+    }
+    for (auto &reply : replies)
+    {
+        ASSERT_EQ(reply.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    }
+
+    const auto stats = rpc.batchStats();
+    EXPECT_EQ(server.requests(), 2u);
+    EXPECT_EQ(stats.fullFlushes, 2u);
+    EXPECT_EQ(stats.maxFlushSize, 4u);
+}
+
+class RateLimiterTest : public ::testing::Test
+{
+protected:
+    RateLimiterTest()
+        : ioc(std::make_shared<net::io_context>()),
+          work(net::make_work_guard(*ioc)),
+          runner([this]()
+                 { ioc->run(); })
+    {
+    }
+
+    ~RateLimiterTest() override
+    {
+        work.reset();
+        ioc->stop();
+        runner.join();
+    }
+
+    std::shared_ptr<net::io_context> ioc;
+    net::executor_work_guard<net::io_context::executor_type> work;
+    std::thread runner;
+};
+
+TEST_F(RateLimiterTest, PacesCallsToTheConfiguredRate)
+{
+    Solana::RateLimiter limiter(ioc, {.unitsPerSecond = 100, .burst = 5});
+
+    std::promise<void> finished;
+    std::atomic<int> started = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 25; ++i)
+    {
+        limiter.acquire(1, 0, [&]()
+                        {
+            if (++started == 25)
+                finished.set_value(); });
+    }
+    finished.get_future().wait();
+
+    // The burst goes at once; the other 20 calls take 200ms at 100 per second
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(180));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(600));
+    const auto stats = limiter.stats();
+    EXPECT_EQ(stats.granted, 25u);
+    EXPECT_EQ(stats.delayed, 20u);
+}
+
+TEST_F(RateLimiterTest, ServesHigherPriorityFirst)
+{
+    Solana::RateLimiter limiter(ioc, {.unitsPerSecond = 50, .burst = 1});
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    std::promise<void> finished;
+    const auto record = [&](std::string name)
+    {
+        return [&, name]()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            order.push_back(name);
+            if (order.size() == 4)
+                finished.set_value();
+        };
+    };
+    limiter.acquire(1, 0, record("drains the bucket"));
+    limiter.acquire(1, 0, record("low 1"));
+    limiter.acquire(1, 0, record("low 2"));
+    limiter.acquire(1, 5, record("high"));
+    finished.get_future().wait();
+
+    EXPECT_EQ(order, (std::vector<std::string>{"drains the bucket", "high", "low 1", "low 2"}));
+}
+
+TEST_F(RateLimiterTest, DropsCancelledAndExpiredCallsUncharged)
+{
+    Solana::RateLimiter limiter(ioc, {.unitsPerSecond = 20, .burst = 1});
+
+    std::mutex mutex;
+    std::vector<std::string> events;
+    std::promise<void> finished;
+    const auto record = [&](std::string name)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        events.push_back(std::move(name));
+    };
+    const auto never = [&]()
+    { record("started a dropped call"); };
+    const auto abandoned = [&](boost::system::error_code ec)
+    { record(ec.message()); };
+
+    const auto start = std::chrono::steady_clock::now();
+    limiter.acquire(1, 0, [&]()
+                    { record("drains the bucket"); });
+    auto token = std::make_shared<Solana::Network::CancellationToken>();
+    limiter.acquire(1, {.cancellation = token}, never, abandoned);
+    limiter.acquire(1, {.timeout = std::chrono::milliseconds(10)}, never, abandoned);
+    limiter.acquire(1, 0, [&]()
+                    {
+        record("live");
+        finished.set_value(); });
+    token->cancel();
+    finished.get_future().wait();
+
+    // Had the dropped calls been charged, the live one would wait three refills, not one
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GE(elapsed, std::chrono::milliseconds(30));
+    EXPECT_LT(elapsed, std::chrono::milliseconds(95));
+    EXPECT_EQ(events, (std::vector<std::string>{"drains the bucket",
+                                                make_error_code(Solana::Network::Error::Cancelled).message(),
+                                                make_error_code(Solana::Network::Error::QueueTimeout).message(),
+                                                "live"}));
+    const auto stats = limiter.stats();
+    EXPECT_EQ(stats.granted, 2u);
+    EXPECT_EQ(stats.abandoned, 2u);
+}
+
+TEST_F(RateLimiterTest, TimesOutCallsQueuedBehindHigherPriorities)
+{
+    Solana::RateLimiter limiter(ioc, {.unitsPerSecond = 10, .burst = 1});
+
+    std::promise<std::chrono::steady_clock::time_point> expired;
+    std::promise<void> high;
+    const auto start = std::chrono::steady_clock::now();
+    limiter.acquire(1, 0, []() {});
+    limiter.acquire(1, 5, [&]()
+                    { high.set_value(); });
+    limiter.acquire(1, {.timeout = std::chrono::milliseconds(20)}, [&]()
+                    { ADD_FAILURE() << "started an expired call"; }, [&](boost::system::error_code ec)
+                    {
+        EXPECT_EQ(ec, Solana::Network::Error::QueueTimeout);
+        expired.set_value(std::chrono::steady_clock::now()); });
+
+    // The front call waits 100ms for a refill; the one behind it must not wait that long to fail
+    const auto failedAt = expired.get_future().get();
+    EXPECT_LT(failedAt - start, std::chrono::milliseconds(70));
+    high.get_future().wait();
+    EXPECT_EQ(limiter.stats().abandoned, 1u);
+}
+
+TEST_F(RateLimiterTest, HoldsEverythingBackWhilePaused)
+{
+    Solana::RateLimiter limiter(ioc, {.unitsPerSecond = 1000, .burst = 100});
+
+    std::promise<void> started;
+    const auto start = std::chrono::steady_clock::now();
+    limiter.pause(std::chrono::milliseconds(100));
+    limiter.acquire(1, 0, [&]()
+                    { started.set_value(); });
+    started.get_future().wait();
+
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+    EXPECT_EQ(limiter.stats().pauses, 1u);
+}
+
+TEST(RpcRateLimitTest, ChargesHeavyMethodsTheirWeight)
+{
+    Solana::Testing::StubServer server([](const std::string &body)
+                                       {
+        const auto call = json::parse(body);
+        return json{{"jsonrpc", "2.0"}, {"id", call["id"]}, {"result", json::array({{{"signature", call["params"][0]}, {"slot", 1}}})}}.dump(); });
+    Solana::Rpc rpc(server.url(), {}, {.rateLimit = {.unitsPerSecond = 20, .burst = 2, .weights = {{"getSignaturesForAddress", 2}}}});
+
+    std::vector<std::future<Solana::RpcReply<Solana::GetSignaturesForAddress>>> replies;
+    for (int i = 0; i < 3; ++i)
+    {
+        replies.push_back(rpc.send(Solana::GetSignaturesForAddress("address" + std::to_string(i))));
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (auto &reply : replies)
+    {
+        reply.get();
+    }
+
+    // The first call spends the whole burst; each of the others waits 100ms for two units
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+    EXPECT_EQ(rpc.rateLimitStats().delayed, 2u);
+}
+
+// Queued calls keep their deadline and cancellation: they fail while waiting for
+// the limiter and are never sent
+TEST(RpcRateLimitTest, QueuedCallsHonourDeadlinesAndCancellation)
+{
+    Solana::Testing::StubServer server([](const std::string &body)
+                                       {
+        const auto call = json::parse(body);
+        return json{{"jsonrpc", "2.0"}, {"id", call["id"]}, {"result", json::array()}}.dump(); });
+    Solana::Rpc rpc(server.url(), {}, {.rateLimit = {.unitsPerSecond = 2, .burst = 1, .weights = {}}});
+    const Solana::GetSignaturesForAddress request("address");
+
+    auto first = rpc.send(request, Solana::Network::RequestOptions{});
+    auto token = std::make_shared<Solana::Network::CancellationToken>();
+    auto cancelled = rpc.send(request, {.cancellation = token});
+    std::promise<std::exception_ptr> expired;
+    rpc.asyncSend(request, {.timeout = std::chrono::milliseconds(50)},
+                  [&expired](std::exception_ptr ex, Solana::RpcReply<Solana::GetSignaturesForAddress>)
+                  { expired.set_value(ex); });
+    token->cancel();
+
+    const auto codeOf = [](std::exception_ptr ex)
+    {
+        try
+        {
+            std::rethrow_exception(ex);
+        }
+        catch (const boost::system::system_error &e)
+        {
+            return e.code();
+        }
+        catch (...)
+        {
+            return boost::system::error_code();
+        }
+    };
+    first.get();
+    ASSERT_EQ(cancelled.wait_for(std::chrono::milliseconds(100)), std::future_status::ready);
+    try
+    {
+        cancelled.get();
+        ADD_FAILURE() << "cancelled call completed";
+    }
+    catch (...)
+    {
+        EXPECT_EQ(codeOf(std::current_exception()), Solana::Network::Error::Cancelled);
+    }
+    auto timedOut = expired.get_future();
+    ASSERT_EQ(timedOut.wait_for(std::chrono::milliseconds(200)), std::future_status::ready);
+    EXPECT_EQ(codeOf(timedOut.get()), Solana::Network::Error::QueueTimeout);
+
+    EXPECT_EQ(server.requests(), 1u);
+    EXPECT_EQ(rpc.rateLimitStats().abandoned, 2u);
+}
+
+TEST(RpcRateLimitTest, RetriesRateLimitedReadsAfterThePause)
+{
+    Solana::Testing::StubServer server([](const std::string &body)
+                                       {
+        const auto call = json::parse(body);
+        return json{{"jsonrpc", "2.0"}, {"id", call["id"]}, {"result", json::array()}}.dump(); },
+                                       {.statusOf = [](std::size_t request)
+                                        { return request == 1 ? 429u : 200u; },
+                                        .retryAfter = "1"});
+    Solana::Rpc rpc(server.url(), {}, {.rateLimit = {.unitsPerSecond = 100, .burst = 10}});
+
+    const auto start = std::chrono::steady_clock::now();
+    auto reply = rpc.send(Solana::GetSignaturesForAddress("address"), Solana::Network::RequestOptions{});
+    EXPECT_NO_THROW(reply.get());
+
+    // The retry waits out the Retry-After rather than failing the call
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(900));
+    EXPECT_EQ(server.requests(), 2u);
+    EXPECT_EQ(rpc.rateLimitStats().pauses, 1u);
+    EXPECT_EQ(rpc.rateLimitStats().granted, 2u);
+}
+
+// The JsonView path must produce exactly what the json DOM path does
+TEST(RpcReplyParseTest, TransactionViewMatchesDom)
+{
+    using Tx = Solana::GetTransaction<>;
+    for (const auto &body : Solana::Testing::capturedTransactionReplies())
+    {
+        const auto dom = Solana::RpcReply<Tx>::fromJson(json::parse(body));
+        const auto view = Solana::RpcReply<Tx>::parse(body);
+
+        EXPECT_EQ(view.id, dom.id);
+        EXPECT_EQ(view.result.signature, dom.result.signature);
+        EXPECT_EQ(view.result.slot, dom.result.slot);
+        EXPECT_EQ(view.result.blockTime, dom.result.blockTime);
+        ASSERT_TRUE(view.result.tx && dom.result.tx);
+        EXPECT_EQ(view.result.tx->parse(), dom.result.tx->parse());
+        ASSERT_EQ(view.result.swapTx.has_value(), dom.result.swapTx.has_value());
+        if (dom.result.swapTx)
+        {
+            EXPECT_EQ(view.result.swapTx->amm, dom.result.swapTx->amm);
+            EXPECT_EQ(view.result.swapTx->inputMint, dom.result.swapTx->inputMint);
+            EXPECT_EQ(view.result.swapTx->outputAmount, dom.result.swapTx->outputAmount);
+        }
+    }
+}
+
+// Plays the server side of the pub/sub protocol: keeps what the manager sends
+// and answers subscribe requests with sequential subscription ids
+class SubscriptionManagerTest : public ::testing::Test
+{
+protected:
+    std::vector<json> sent;
+    Solana::SubscriptionManager manager{[this](std::string message)
+                                        { sent.push_back(json::parse(message)); }};
+
+    void confirm(const json &request, Solana::u64 subscription)
+    {
+        manager.onMessage(json{{"jsonrpc", "2.0"}, {"id", request["id"]}, {"result", subscription}}.dump());
+    }
+
+    void notify(const std::string &method, Solana::u64 subscription, Solana::u64 slot)
+    {
+        manager.onMessage(json{{"jsonrpc", "2.0"},
+                               {"method", method},
+                               {"params", {{"subscription", subscription}, {"result", {{"context", {{"slot", slot}}}, {"value", nullptr}}}}}}
+                              .dump());
+    }
+};
+
+TEST_F(SubscriptionManagerTest, RoutesNotificationsBySubscriptionId)
+{
+    constexpr int count = 2000;
+    std::vector<Solana::u64> received(count, 0);
+    std::vector<std::future<Solana::u64>> handles;
+    for (int i = 0; i < count; ++i)
+    {
+        handles.push_back(manager.subscribe("accountSubscribe", json::array({"account" + std::to_string(i)}),
+                                            [&received, i](const Solana::Encoding::JsonView &result)
+                                            { received[i] = result["context"]["slot"].get<Solana::u64>(); }));
+    }
+    ASSERT_EQ(sent.size(), count);
+    std::set<Solana::u64> ids;
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(sent[i]["method"], "accountSubscribe");
+        ids.insert(sent[i]["id"].get<Solana::u64>());
+        // Server ids unrelated to the request ids
+        confirm(sent[i], 50000 + count - i);
+    }
+    EXPECT_EQ(ids.size(), count) << "request ids must be unique";
+    for (auto &handle : handles)
+    {
+        ASSERT_EQ(handle.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+        handle.get();
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        notify("accountNotification", 50000 + count - i, 1000 + i);
+    }
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(received[i], 1000 + i);
+    }
+    const auto stats = manager.stats();
+    EXPECT_EQ(stats.active, count);
+    EXPECT_EQ(stats.pending, 0);
+    EXPECT_EQ(stats.notifications, count);
+}
+
+TEST_F(SubscriptionManagerTest, UnsubscribeStopsRoutingAndUsesTheServerId)
+{
+    int calls = 0;
+    auto handle = manager.subscribe("logsSubscribe", json::array({"all"}), [&calls](const Solana::Encoding::JsonView &)
+                                    { ++calls; });
+    confirm(sent.back(), 7);
+    notify("logsNotification", 7, 1);
+    EXPECT_EQ(calls, 1);
+
+    auto removed = manager.unsubscribe(handle.get());
+    EXPECT_EQ(sent.back()["method"], "logsUnsubscribe");
+    EXPECT_EQ(sent.back()["params"], json::array({7}));
+    notify("logsNotification", 7, 2);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(manager.stats().unrouted, 1);
+
+    manager.onMessage(json{{"jsonrpc", "2.0"}, {"id", sent.back()["id"]}, {"result", true}}.dump());
+    EXPECT_TRUE(removed.get());
+    EXPECT_EQ(manager.size(), 0);
+}
+
+TEST_F(SubscriptionManagerTest, UnsubscribeBeforeConfirmationCancelsOnTheServer)
+{
+    auto handle = manager.subscribe("slotSubscribe", nullptr, [](const Solana::Encoding::JsonView &) {});
+    const auto request = sent.back();
+    EXPECT_FALSE(request.contains("params"));
+    EXPECT_TRUE(manager.unsubscribe(request["id"].get<Solana::u64>()).get());
+
+    confirm(request, 3);
+    EXPECT_EQ(handle.get(), request["id"].get<Solana::u64>());
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent.back()["method"], "slotUnsubscribe");
+    EXPECT_EQ(sent.back()["params"], json::array({3}));
+    EXPECT_EQ(manager.stats().active, 0);
+}
+
+TEST_F(SubscriptionManagerTest, ServerErrorFailsTheSubscription)
+{
+    auto handle = manager.subscribe("accountSubscribe", json::array({"not-a-key"}), [](const Solana::Encoding::JsonView &) {});
+    manager.onMessage(json{{"jsonrpc", "2.0"}, {"id", sent.back()["id"]}, {"error", {{"code", -32602}, {"message", "Invalid param"}}}}.dump());
+    EXPECT_THROW(handle.get(), std::runtime_error);
+    EXPECT_EQ(manager.size(), 0);
+}
+
+TEST_F(SubscriptionManagerTest, TypedSubscriptionsDecodeNotifications)
+{
+    std::vector<Solana::SlotSubscribe::Notification> slots;
+    auto handle = manager.subscribe(Solana::SlotSubscribe(), [&slots](const Solana::SlotSubscribe::Notification &n)
+                                    { slots.push_back(n); });
+    EXPECT_EQ(sent.back()["method"], "slotSubscribe");
+    EXPECT_FALSE(sent.back().contains("params"));
+    confirm(sent.back(), 11);
+    handle.get();
+
+    manager.onMessage(R"({"jsonrpc":"2.0","method":"slotNotification","params":{"result":{"parent":99,"root":68,"slot":100},"subscription":11}})");
+    ASSERT_EQ(slots.size(), 1);
+    EXPECT_EQ(slots[0].slot, 100);
+    EXPECT_EQ(slots[0].parent, 99);
+    EXPECT_EQ(slots[0].root, 68);
+
+    manager.subscribe(Solana::LogsSubscribe("6EF8rrecthR5Dkzon8Nwu78hRvfCKubJ14M5uBEwF6P", {.commitment = Solana::Commitment(Solana::CommitmentLevel::Confirmed)}),
+                      [](const Solana::LogsSubscribe::Notification &) {});
+    EXPECT_EQ(sent.back()["params"], json::parse(R"([{"mentions":["6EF8rrecthR5Dkzon8Nwu78hRvfCKubJ14M5uBEwF6P"]},{"commitment":"confirmed"}])"));
+}
+
+// Every captured logsNotification decodes to the same fields a DOM reads
+TEST(LogsSubscribeTest, DecodesCapturedNotifications)
+{
+    const auto messages = Solana::Testing::capturedLogNotifications();
+    ASSERT_FALSE(messages.empty());
+    std::size_t failed = 0;
+    for (const auto &message : messages)
+    {
+        const auto notification = Solana::LogsSubscribe::parseMessage(message);
+        ASSERT_TRUE(notification);
+        const auto expected = json::parse(message)["params"]["result"];
+        EXPECT_EQ(notification->slot, expected["context"]["slot"].get<Solana::u64>());
+        EXPECT_EQ(notification->signature, expected["value"]["signature"].get<std::string>());
+        EXPECT_EQ(notification->logs, expected["value"]["logs"].get<std::vector<std::string>>());
+        EXPECT_EQ(notification->failed(), !expected["value"]["err"].is_null());
+        if (notification->failed())
+        {
+            EXPECT_EQ(json::parse(notification->err), expected["value"]["err"]);
+            ++failed;
+        }
+    }
+    EXPECT_GT(failed, 0) << "the capture should include failed transactions";
+
+    // Replies and other kinds of notification are not logs notifications
+    EXPECT_FALSE(Solana::LogsSubscribe::parseMessage(R"({"jsonrpc":"2.0","result":9438,"id":1})"));
+    EXPECT_FALSE(Solana::LogsSubscribe::parseMessage(R"({"jsonrpc":"2.0","method":"slotNotification","params":{"result":{"slot":1},"subscription":1}})"));
+}
+
+TEST(AccountSubscribeTest, DecodesEncodedAndParsedData)
+{
+    const auto encoded = Solana::AccountSubscribe::parseMessage(
+        R"({"jsonrpc":"2.0","method":"accountNotification","params":{"result":{"context":{"slot":5199307},"value":{"data":["11116bv5nS2h3y12kD1yUKeMZvGcKLSjQgX6BeV7u1FrjeJcKfsHPXHRDEHrBesJhZyqnnq9qJeUuF7WHxiuLuL5twc38w2TXNLxnDbjmuR","base58"],"executable":false,"lamports":33594,"owner":"11111111111111111111111111111111","rentEpoch":635,"space":80}},"subscription":23784}})");
+    ASSERT_TRUE(encoded);
+    EXPECT_EQ(encoded->slot, 5199307);
+    EXPECT_EQ(encoded->account.lamports, 33594);
+    EXPECT_EQ(encoded->account.owner, "11111111111111111111111111111111");
+    EXPECT_EQ(encoded->account.encoding, "base58");
+    EXPECT_TRUE(encoded->account.data.starts_with("11116bv5"));
+    EXPECT_EQ(encoded->account.rentEpoch, 635);
+    EXPECT_EQ(encoded->account.space, 80);
+
+    const auto parsed = Solana::ProgramSubscribe::parseMessage(
+        R"({"jsonrpc":"2.0","method":"programNotification","params":{"result":{"context":{"slot":5208469},"value":{"pubkey":"H4vnBqifaSACnKa7acsxstsY1iV1bvJNxsCY7enrd1hq","account":{"data":{"program":"nonce","parsed":{"type":"initialized"}},"executable":false,"lamports":33594,"owner":"11111111111111111111111111111111","rentEpoch":636,"space":80}}},"subscription":24040}})");
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(parsed->slot, 5208469);
+    EXPECT_EQ(parsed->pubkey, "H4vnBqifaSACnKa7acsxstsY1iV1bvJNxsCY7enrd1hq");
+    EXPECT_EQ(parsed->account.encoding, "jsonParsed");
+    EXPECT_EQ(json::parse(parsed->account.data)["program"], "nonce");
+}
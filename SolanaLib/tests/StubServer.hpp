@@ -0,0 +1,165 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TestData.hpp"
+
+namespace Solana::Testing
+{
+    namespace net = boost::asio;
+    namespace beast = boost::beast;
+    namespace http = beast::http;
+    namespace ssl = net::ssl;
+    using net::ip::tcp;
+
+    struct StubServerConfig
+    {
+        std::size_t threads = 1;
+        std::chrono::microseconds delay{0};
+        // Sampled per request when set, replacing the fixed delay; lets benchmarks inject a latency distribution
+        std::function<std::chrono::microseconds()> latency;
+        bool keepAlive = true;
+        // Reply status, e.g. 429 with a Retry-After to stand in for a provider enforcing its quota
+        unsigned status = 200;
+        // Chosen per request (counted from 1) when set, replacing the fixed status
+        std::function<unsigned(std::size_t request)> statusOf;
+        // Sent with any status but 200
+        std::string retryAfter;
+        // Advertise keep-alive but close the socket anyway, like an idle-timeout on the server side
+        bool closeAfterReply = false;
+    };
+
+    // Local TLS HTTP/1.1 server used by the network tests and benchmarks.
+    // Every request body is handed to the handler and its return value is
+    // sent back as a JSON reply on the same keep-alive connection.
+    class StubServer
+    {
+    public:
+        using Handler = std::function<std::string(const std::string &body)>;
+
+        explicit StubServer(Handler handler, StubServerConfig config = {})
+            : handler_(std::move(handler)),
+              config_(config),
+              ctx_(ssl::context::tls_server),
+              acceptor_(ioc_, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0))
+        {
+            ctx_.use_certificate_chain_file(dataPath("cert.pem"));
+            ctx_.use_private_key_file(dataPath("key.pem"), ssl::context::pem);
+
+            net::spawn(
+                acceptor_.get_executor(),
+                [this](net::yield_context yield)
+                { accept(yield); },
+                net::detached);
+
+            for (std::size_t i = 0; i < std::max<std::size_t>(config_.threads, 1); ++i)
+            {
+                threads_.emplace_back([this]()
+                                      { ioc_.run(); });
+            }
+        }
+
+        ~StubServer()
+        {
+            ioc_.stop();
+            for (auto &t : threads_)
+            {
+                t.join();
+            }
+        }
+
+        unsigned short port() const { return acceptor_.local_endpoint().port(); }
+
+        std::string url() const { return "https://127.0.0.1:" + std::to_string(port()) + "/"; }
+
+        std::size_t connections() const { return connections_; }
+
+        std::size_t requests() const { return requests_; }
+
+    private:
+        void accept(net::yield_context yield)
+        {
+            for (;;)
+            {
+                beast::error_code ec;
+                tcp::socket socket(net::make_strand(ioc_));
+                acceptor_.async_accept(socket, yield[ec]);
+                if (ec)
+                {
+                    return;
+                }
+                ++connections_;
+                auto executor = socket.get_executor();
+                net::spawn(
+                    executor,
+                    [this, socket = std::move(socket)](net::yield_context yield) mutable
+                    { session(std::move(socket), yield); },
+                    net::detached);
+            }
+        }
+
+        void session(tcp::socket socket, net::yield_context yield)
+        {
+            beast::error_code ec;
+            beast::ssl_stream<beast::tcp_stream> stream(std::move(socket), ctx_);
+            stream.async_handshake(ssl::stream_base::server, yield[ec]);
+            if (ec)
+            {
+                return;
+            }
+
+            beast::flat_buffer buffer;
+            for (;;)
+            {
+                http::request<http::string_body> req;
+                http::async_read(stream, buffer, req, yield[ec]);
+                if (ec)
+                {
+                    break;
+                }
+                const auto request = ++requests_;
+
+                const auto delay = config_.latency ? config_.latency() : config_.delay;
+                if (delay.count() > 0)
+                {
+                    net::steady_timer timer(stream.get_executor(), delay);
+                    timer.async_wait(yield[ec]);
+                }
+
+                const auto status = config_.statusOf ? config_.statusOf(request) : config_.status;
+                http::response<http::string_body> res{static_cast<http::status>(status), req.version()};
+                res.set(http::field::content_type, "application/json");
+                if (status != 200 && !config_.retryAfter.empty())
+                {
+                    res.set(http::field::retry_after, config_.retryAfter);
+                }
+                res.keep_alive(config_.keepAlive && req.keep_alive());
+                res.body() = handler_(req.body());
+                res.prepare_payload();
+
+                http::async_write(stream, res, yield[ec]);
+                if (ec || !res.keep_alive() || config_.closeAfterReply)
+                {
+                    break;
+                }
+            }
+            stream.async_shutdown(yield[ec]);
+        }
+
+        Handler handler_;
+        StubServerConfig config_;
+        net::io_context ioc_;
+        ssl::context ctx_;
+        tcp::acceptor acceptor_;
+        std::vector<std::thread> threads_;
+        std::atomic<std::size_t> connections_ = 0;
+        std::atomic<std::size_t> requests_ = 0;
+    };
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <fstream>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+namespace Solana::Testing
+{
+    inline std::string dataPath(const std::string &file)
+    {
+        return std::string(SOLANA_TEST_DATA_DIR) + "/" + file;
+    }
+
+    // The getTransaction results captured in messages.json (one JSON document
+    // per transaction), each wrapped in a JSON-RPC reply envelope
+    inline std::vector<std::string> capturedTransactionReplies()
+    {
+        std::ifstream file(dataPath("messages.json"));
+        std::vector<std::string> replies;
+        nlohmann::json tx;
+        while (file >> std::ws && file.peek() != std::char_traits<char>::eof())
+        {
+            file >> tx;
+            if (tx.is_object())
+            {
+                replies.push_back(nlohmann::json{{"jsonrpc", "2.0"}, {"id", 1}, {"result", tx}}.dump());
+            }
+        }
+        return replies;
+    }
+
+    // The logsNotification messages captured in parsed_logs.json, one per frame as
+    // a logsSubscribe stream delivers them
+    inline std::vector<std::string> capturedLogNotifications()
+    {
+        std::ifstream file(dataPath("parsed_logs.json"));
+        const auto captured = nlohmann::json::parse(file);
+        std::vector<std::string> messages;
+        for (const auto &message : captured)
+        {
+            if (message.value("method", "") == "logsNotification")
+            {
+                messages.push_back(message.dump());
+            }
+        }
+        return messages;
+    }
+}
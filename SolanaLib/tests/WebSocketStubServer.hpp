@@ -0,0 +1,289 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/spawn.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "TestData.hpp"
+
+namespace Solana::Testing
+{
+    namespace net = boost::asio;
+    namespace beast = boost::beast;
+    namespace websocket = beast::websocket;
+    namespace ssl = net::ssl;
+    using net::ip::tcp;
+
+    // tcp_stream that counts the bytes written to the socket, i.e. frames after
+    // compression and TLS, as they would cross the network
+    class CountingStream : public beast::tcp_stream
+    {
+    public:
+        using beast::tcp_stream::tcp_stream;
+
+        template <class ConstBufferSequence, class WriteHandler>
+        void async_write_some(const ConstBufferSequence &buffers, WriteHandler &&handler)
+        {
+            beast::tcp_stream::async_write_some(buffers, [counter = counter, handler = std::forward<WriteHandler>(handler)](beast::error_code ec, std::size_t n) mutable
+                                                {
+                if (counter)
+                    *counter += n;
+                handler(ec, n); });
+        }
+
+        std::atomic<std::size_t> *counter = nullptr;
+    };
+
+    // Local TLS WebSocket server speaking just enough of the Solana pub/sub
+    // protocol for the subscription tests: *Subscribe requests get sequential
+    // subscription ids, *Unsubscribe requests are acknowledged (batches of them
+    // with an array of replies), and publish() pushes a notification to every
+    // subscription on the open connections.
+    // permessage-deflate is accepted when `deflate` enables the server role.
+    class WebSocketStubServer
+    {
+    public:
+        explicit WebSocketStubServer(websocket::permessage_deflate deflate = {})
+            : deflate_(deflate),
+              ctx_(ssl::context::tls_server),
+              acceptor_(ioc_, tcp::endpoint(net::ip::make_address("127.0.0.1"), 0))
+        {
+            ctx_.use_certificate_chain_file(dataPath("cert.pem"));
+            ctx_.use_private_key_file(dataPath("key.pem"), ssl::context::pem);
+
+            net::spawn(
+                ioc_,
+                [this](net::yield_context yield)
+                { accept(yield); },
+                net::detached);
+            thread_ = std::thread([this]()
+                                  { ioc_.run(); });
+        }
+
+        ~WebSocketStubServer()
+        {
+            ioc_.stop();
+            thread_.join();
+        }
+
+        unsigned short port() const { return acceptor_.local_endpoint().port(); }
+
+        std::size_t connections() const { return connections_; }
+
+        std::size_t subscribeRequests() const { return subscribeRequests_; }
+
+        // Text frames received, each holding one request or a batch
+        std::size_t framesReceived() const { return framesReceived_; }
+
+        // Bytes put on the wire so far, across all connections
+        std::size_t bytesWritten() const { return bytesWritten_; }
+
+        // Sends each subscription a notification produced in `slot`
+        void publish(std::uint64_t slot)
+        {
+            net::post(ioc_, [this, slot]()
+                      {
+                for (auto &session : sessions_)
+                {
+                    for (const auto &[id, method] : session->subscriptions)
+                    {
+                        const auto kind = method.substr(0, method.size() - std::string("Subscribe").size());
+                        send(session, nlohmann::json{{"jsonrpc", "2.0"},
+                                                     {"method", kind + "Notification"},
+                                                     {"params", {{"subscription", id}, {"result", {{"context", {{"slot", slot}}}, {"value", nullptr}}}}}}
+                                          .dump());
+                    }
+                } });
+        }
+
+        // Sends raw text frames, in order, on every open connection
+        void broadcast(std::vector<std::string> messages)
+        {
+            net::post(ioc_, [this, messages = std::move(messages)]()
+                      {
+                for (auto &session : sessions_)
+                {
+                    for (const auto &message : messages)
+                    {
+                        send(session, message);
+                    }
+                } });
+        }
+
+        // Resets up to `limit` open connections, oldest first, without a close
+        // frame, like a provider restart
+        void drop(std::size_t limit = std::numeric_limits<std::size_t>::max())
+        {
+            net::post(ioc_, [this, limit]()
+                      {
+                std::size_t dropped = 0;
+                for (auto &session : sessions_)
+                {
+                    if (dropped++ == limit)
+                    {
+                        break;
+                    }
+                    beast::error_code ignored;
+                    beast::get_lowest_layer(session->ws).socket().close(ignored);
+                } });
+        }
+
+        // While set, new connections are closed as soon as they are accepted
+        void refuse(bool refusing) { refusing_ = refusing; }
+
+    private:
+        struct Session
+        {
+            explicit Session(tcp::socket socket, ssl::context &ctx) : ws(std::move(socket), ctx) {}
+
+            websocket::stream<beast::ssl_stream<CountingStream>> ws;
+            std::vector<std::pair<std::uint64_t, std::string>> subscriptions;
+            std::deque<std::string> outbox;
+            bool writing = false;
+        };
+
+        void accept(net::yield_context yield)
+        {
+            for (;;)
+            {
+                beast::error_code ec;
+                tcp::socket socket(ioc_);
+                acceptor_.async_accept(socket, yield[ec]);
+                if (ec)
+                {
+                    return;
+                }
+                if (refusing_)
+                {
+                    socket.close(ec);
+                    continue;
+                }
+                ++connections_;
+                net::spawn(
+                    ioc_,
+                    [this, socket = std::move(socket)](net::yield_context yield) mutable
+                    { session(std::move(socket), yield); },
+                    net::detached);
+            }
+        }
+
+        void session(tcp::socket socket, net::yield_context yield)
+        {
+            beast::error_code ec;
+            auto session = std::make_shared<Session>(std::move(socket), ctx_);
+            beast::get_lowest_layer(session->ws).counter = &bytesWritten_;
+            session->ws.set_option(deflate_);
+            session->ws.next_layer().async_handshake(ssl::stream_base::server, yield[ec]);
+            if (ec)
+            {
+                return;
+            }
+            session->ws.async_accept(yield[ec]);
+            if (ec)
+            {
+                return;
+            }
+            sessions_.push_back(session);
+
+            beast::flat_buffer buffer;
+            for (;;)
+            {
+                session->ws.async_read(buffer, yield[ec]);
+                if (ec)
+                {
+                    break;
+                }
+                const auto request = nlohmann::json::parse(beast::buffers_to_string(buffer.data()));
+                buffer.consume(buffer.size());
+                ++framesReceived_;
+
+                if (request.is_array())
+                {
+                    auto replies = nlohmann::json::array();
+                    for (const auto &element : request)
+                    {
+                        replies.push_back(answer(*session, element));
+                    }
+                    send(session, replies.dump());
+                }
+                else
+                {
+                    send(session, answer(*session, request).dump());
+                }
+            }
+            sessions_.remove(session);
+        }
+
+        nlohmann::json answer(Session &session, const nlohmann::json &request)
+        {
+            const auto method = request["method"].get<std::string>();
+            nlohmann::json reply{{"jsonrpc", "2.0"}, {"id", request["id"]}};
+            if (method.ends_with("Unsubscribe"))
+            {
+                const auto id = request["params"][0].get<std::uint64_t>();
+                std::erase_if(session.subscriptions, [id](const auto &subscription)
+                              { return subscription.first == id; });
+                reply["result"] = true;
+            }
+            else
+            {
+                ++subscribeRequests_;
+                session.subscriptions.emplace_back(nextSubscription_, method);
+                reply["result"] = nextSubscription_++;
+            }
+            return reply;
+        }
+
+        void send(const std::shared_ptr<Session> &session, std::string message)
+        {
+            session->outbox.push_back(std::move(message));
+            if (!session->writing)
+            {
+                write(session);
+            }
+        }
+
+        void write(const std::shared_ptr<Session> &session)
+        {
+            if (session->outbox.empty())
+            {
+                session->writing = false;
+                return;
+            }
+            session->writing = true;
+            session->ws.async_write(net::buffer(session->outbox.front()), [this, session](beast::error_code ec, std::size_t)
+                                    {
+                session->outbox.pop_front();
+                if (ec)
+                {
+                    session->outbox.clear();
+                }
+                write(session); });
+        }
+
+        websocket::permessage_deflate deflate_;
+        net::io_context ioc_;
+        ssl::context ctx_;
+        tcp::acceptor acceptor_;
+        std::thread thread_;
+        // Only touched on ioc_'s one thread
+        std::list<std::shared_ptr<Session>> sessions_;
+        std::uint64_t nextSubscription_ = 1;
+        std::atomic<std::size_t> connections_ = 0;
+        std::atomic<std::size_t> subscribeRequests_ = 0;
+        std::atomic<std::size_t> framesReceived_ = 0;
+        std::atomic<std::size_t> bytesWritten_ = 0;
+        std::atomic<bool> refusing_ = false;
+    };
+}
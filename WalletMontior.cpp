@@ -1,7 +1,6 @@
 #include <iostream>
 #include <future>
 #include <fstream>
-#include <thread> // for std::this_thread::sleep_for
 #include <chrono> // for std::chrono::milliseconds
 #include <nlohmann/json.hpp>
 
@@ -20,14 +19,17 @@ int main()
   ctx.set_default_verify_paths();
   ctx.set_verify_mode(ssl::verify_peer);
 
-  Solana::Rpc rpcSig("https://mainnet.helius-rpc.com/?api-key=8bdcaeaa-3e64-4d76-ba46-a4fb8802eafb");
+  // Bursts of notifications fetch at most 10 requests a second per key; the rest wait their turn
+  const Solana::RpcConfig rpcConfig{.rateLimit = {.unitsPerSecond = 10}};
+
+  Solana::Rpc rpcSig("https://mainnet.helius-rpc.com/?api-key=8bdcaeaa-3e64-4d76-ba46-a4fb8802eafb", {}, rpcConfig);
   // Define initial request object
   auto sig_request = std::make_shared<Solana::GetSignaturesForAddress>(
       "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7");
   sig_request->config.commitment = Solana::Commitment(Solana::CommitmentLevel::Confirmed);
   sig_request->config.limit = 1;
 
-  Solana::Rpc rpcTx("https://mainnet.helius-rpc.com/?api-key=7b0e15f4-3d3b-4e17-be8d-3ada2a0e9e3d");
+  Solana::Rpc rpcTx("https://mainnet.helius-rpc.com/?api-key=7b0e15f4-3d3b-4e17-be8d-3ada2a0e9e3d", {}, rpcConfig);
 
   // Define the subscription message
   const std::vector<std::string> subscription_messages = {R"({
@@ -53,9 +55,9 @@ int main()
   std::ofstream file("messages.json", std::ios::app); // Open in append mode
 
   // Define the callback function for handling received messages
-  auto message_handler = [&file, sig_request, &rpcSig, &rpcTx](beast::flat_buffer &&buf)
+  auto message_handler = [&file, sig_request, &rpcSig, &rpcTx](Solana::Network::PooledBuffer &&buf)
   {
-    std::string message = beast::buffers_to_string(buf.data());
+    const std::string_view message = buf.view();
     try
     {
       auto parsed = json::parse(message);
@@ -64,15 +66,15 @@ int main()
 
       std::cout << "----------------------------------------\n";
       auto sig_reply = rpcSig.send(*sig_request).get();
-      std::this_thread::sleep_for(std::chrono::milliseconds(1000));
       for (const auto &sigInfo : sig_reply.result.signatures)
       {
         std::cout << "Signature: " << sigInfo.signature << "\n";
         auto tx_request = Solana::GetTransaction(sigInfo.signature);
         tx_request.config.maxSupportedTransactionVersion = 0;
         tx_request.config.encoding = Solana::TransactionEncoding(Solana::EncodingType::JsonParsed);
+        tx_request.config.commitment = Solana::Commitment(Solana::CommitmentLevel::Confirmed);
         auto tx_reply = rpcTx.send(tx_request).get();
-        json j = tx_reply.result.tx;
+        json j = tx_reply.result.tx ? tx_reply.result.tx->parse() : json(nullptr);
         // Output reply to file as JSON
         file << j.dump(4) << std::endl;
         file.flush();
@@ -1,15 +1,64 @@
 #include <iostream>
 #include <future>
 #include <fstream>
-#include <thread> // for std::this_thread::sleep_for
 #include <chrono> // for std::chrono::milliseconds
 #include <nlohmann/json.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/use_awaitable.hpp>
 
 // Assume these are defined in your project
 #include "Solana/Network/WebSocket.hpp"
 #include "Solana/Rpc/Rpc.hpp"
 #include "Solana/Rpc/Methods/GetSignaturesForAddress.hpp"
 #include "Solana/Rpc/Methods/GetTransaction.hpp"
+#include "Solana/Rpc/Subscriptions/AccountSubscribe.hpp"
+net::awaitable<void> backfill(Solana::Rpc &rpcSig,
+                              Solana::Rpc &rpcTx,
+                              std::shared_ptr<Solana::GetSignaturesForAddress> sig_request,
+                              std::ofstream &file)
+{
+    auto sig_reply = co_await rpcSig.asyncSend(*sig_request);
+
+    for (const auto &sigInfo : sig_reply.result.signatures)
+    {
+        std::cout << "Signature: " << sigInfo.signature << "\n";
+
+        const int max_retries = 3;
+        int attempt = 0;
+        bool success = false;
+
+        while (attempt < max_retries && !success)
+        {
+            try
+            {
+                auto tx_request = Solana::GetTransaction(sigInfo.signature);
+                tx_request.config.maxSupportedTransactionVersion = 0;
+                tx_request.config.encoding = Solana::TransactionEncoding(Solana::EncodingType::JsonParsed);
+                // Same commitment the signature was seen at, so there is no need to wait for finalization
+                tx_request.config.commitment = Solana::Commitment(Solana::CommitmentLevel::Confirmed);
+
+                auto tx_reply = co_await rpcTx.asyncSend(tx_request);
+                // Written straight from the response body, without building a json DOM
+                const auto &tx = tx_reply.result.tx;
+                file << (tx ? tx->str() : std::string_view("null")) << std::endl;
+                file.flush();
+
+                success = true;
+            }
+            catch (const std::exception &e)
+            {
+                ++attempt;
+                std::cerr << "Error on attempt " << attempt << " for signature " << sigInfo.signature
+                          << ": " << e.what() << std::endl;
+                if (attempt >= max_retries)
+                {
+                    std::cerr << "Giving up on signature " << sigInfo.signature << "\n";
+                }
+            }
+        }
+    }
+}
+
 int main()
 {
     // Initialize Boost.Asio IO context and SSL context
@@ -20,28 +69,24 @@ int main()
     ctx.set_default_verify_paths();
     ctx.set_verify_mode(ssl::verify_peer);
 
-    Solana::Rpc rpcSig("https://mainnet.helius-rpc.com/?api-key=8bdcaeaa-3e64-4d76-ba46-a4fb8802eafb");
+    // 10 requests a second per key: calls over that wait in the Rpc, and reads answered 429 are retried after the Retry-After
+    const Solana::RpcConfig rpcConfig{.rateLimit = {.unitsPerSecond = 10}};
+
+    Solana::Rpc rpcSig("https://mainnet.helius-rpc.com/?api-key=8bdcaeaa-3e64-4d76-ba46-a4fb8802eafb", {}, rpcConfig);
     // Define initial request object
     auto sig_request = std::make_shared<Solana::GetSignaturesForAddress>(
         "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7");
     sig_request->config.commitment = Solana::Commitment(Solana::CommitmentLevel::Confirmed);
     sig_request->config.limit = 1;
 
-    Solana::Rpc rpcTx("https://mainnet.helius-rpc.com/?api-key=7b0e15f4-3d3b-4e17-be8d-3ada2a0e9e3d");
+    Solana::Rpc rpcTx("https://mainnet.helius-rpc.com/?api-key=7b0e15f4-3d3b-4e17-be8d-3ada2a0e9e3d", {}, rpcConfig);
 
     // Define the subscription message
-    const std::vector<std::string> subscription_messages = {R"({
-        "jsonrpc": "2.0",
-        "id": 1,
-        "method": "accountSubscribe",
-        "params": [
-            "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7",
-            {
-                "encoding": "jsonParsed",
-                "commitment": "confirmed"
-            }
-        ]
-    })"};
+    const Solana::AccountSubscribe account_subscription(
+        "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7",
+        {.commitment = Solana::Commitment(Solana::CommitmentLevel::Confirmed),
+         .encoding = Solana::AccountEncoding(Solana::EncodingType::JsonParsed)});
+    const std::vector<std::string> subscription_messages = {account_subscription.request(1)};
 
     // Create WebSocket object using the factory method
     auto ws = Solana::Network::WebSocket::create(
@@ -52,66 +97,37 @@ int main()
     // Open file for logging messages
     std::ofstream file("messages.json", std::ios::app); // Open in append mode
 
-    // Define the callback function for handling received messages
-    auto message_handler = [&file, sig_request, &rpcSig, &rpcTx](beast::flat_buffer &&buf)
+    // Define the callback function for handling received messages. Follow-up RPCs run
+    // in a coroutine on the WebSocket's io_context, so reads are never blocked by them.
+    auto message_handler = [&ioc, &file, sig_request, &rpcSig, &rpcTx](Solana::Network::PooledBuffer &&buf)
     {
-        std::string message = beast::buffers_to_string(buf.data());
+        // Read in place from the pooled buffer, which is reused for the next message
         try
         {
-            auto parsed = json::parse(message);
-            std::cout << "Parsed JSON:\n";
-            std::cout << parsed << std::endl;
-
-            std::cout << "----------------------------------------\n";
-            auto sig_reply = rpcSig.send(*sig_request).get();
-            std::this_thread::sleep_for(std::chrono::milliseconds(10000));
-            for (const auto &sigInfo : sig_reply.result.signatures)
+            const auto notification = Solana::AccountSubscribe::parseMessage(buf.view());
+            if (!notification)
             {
-                std::cout << "Signature: " << sigInfo.signature << "\n";
-
-                const int max_retries = 3;
-                int attempt = 0;
-                bool success = false;
+                return;
+            }
+            std::cout << "Account changed in slot " << notification->slot
+                      << ": " << notification->account.lamports << " lamports\n";
 
-                while (attempt < max_retries && !success)
+            std::cout << "----------------------------------------\n";
+            net::co_spawn(ioc, backfill(rpcSig, rpcTx, sig_request, file), [](std::exception_ptr ex)
+                          {
+                if (!ex)
+                    return;
+                try
                 {
-                    try
-                    {
-                        auto tx_request = Solana::GetTransaction(sigInfo.signature);
-                        tx_request.config.maxSupportedTransactionVersion = 0;
-                        tx_request.config.encoding = Solana::TransactionEncoding(Solana::EncodingType::JsonParsed);
-
-                        auto tx_reply = rpcTx.send(tx_request).get();
-                        json j = tx_reply.result.tx;
-
-                        file << j.dump(4) << std::endl;
-                        file.flush();
-
-                        success = true;
-                    }
-                    catch (const std::exception &e)
-                    {
-                        ++attempt;
-                        std::cerr << "Error on attempt " << attempt << " for signature " << sigInfo.signature
-                                  << ": " << e.what() << std::endl;
-
-                        if (attempt < max_retries)
-                        {
-                            std::this_thread::sleep_for(std::chrono::milliseconds(1000)); // small backoff before retry
-                        }
-                        else
-                        {
-                            std::cerr << "Giving up on signature " << sigInfo.signature << "\n";
-                        }
-                    }
+                    std::rethrow_exception(ex);
                 }
-
-                std::this_thread::sleep_for(std::chrono::milliseconds(100)); // slight delay between signature requests
-            }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "Failed to fetch signatures: " << e.what() << "\n";
+                } });
         }
         catch (const std::exception &e)
         {
-            auto retry_sig_reply = rpcSig.send(*sig_request).get();
             std::cerr << "Failed to parse/write message: " << e.what() << "\n";
         }
     };
@@ -1,8 +1,9 @@
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/asio/spawn.hpp>
-#include <boost/json.hpp>
 #include "Solana/Network/WebSocket.hpp"
+#include "Solana/Rpc/Subscriptions/AccountSubscribe.hpp"
+#include "Solana/Rpc/Subscriptions/LogsSubscribe.hpp"
 #include <thread>
 #include <chrono>
 #include <iostream>
@@ -11,7 +12,6 @@
 namespace net = boost::asio;
 namespace ssl = boost::asio::ssl;
 namespace beast = boost::beast;
-namespace json = boost::json;
 
 int main()
 {
@@ -29,44 +29,38 @@ int main()
       "mainnet.helius-rpc.com", "443",
       "7b0e15f4-3d3b-4e17-be8d-3ada2a0e9e3d");
 
-  // Define the subscription message
-  const std::vector<std::string> subscription_messages = {R"({
-        "jsonrpc": "2.0",
-        "id": 1,
-        "method": "accountSubscribe",
-        "params": [
-            "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7",
-            {
-                "encoding": "jsonParsed",
-                "commitment": "confirmed"
-            }
-        ]
-    })",
-                                                          R"({
-        "jsonrpc": "2.0",
-        "id": 1,
-        "method": "accountSubscribe",
-        "params": [
-            "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7",
-            {
-                "encoding": "jsonParsed",
-                "commitment": "confirmed"
-            }
-        ]
-    })"};
+  // Define the subscription messages: the account's state and the logs of every
+  // transaction that touches it
+  const std::string address = "2Rf9qzW9rhCnJmEbErrHDDZfeEXtemYdLkyJ1TE12pa7";
+  const Solana::Commitment confirmed(Solana::CommitmentLevel::Confirmed);
+  const std::vector<std::string> subscription_messages = {
+      Solana::AccountSubscribe(address, {.commitment = confirmed,
+                                         .encoding = Solana::AccountEncoding(Solana::EncodingType::JsonParsed)})
+          .request(1),
+      Solana::LogsSubscribe(address, {.commitment = confirmed}).request(2)};
 
   // Open file for logging messages
   std::ofstream file("messages.json", std::ios::app); // Open in append mode
 
   // Define the callback function for handling received messages
-  auto message_handler = [&file](beast::flat_buffer &&buf)
+  auto message_handler = [&file](Solana::Network::PooledBuffer &&buf)
   {
-    std::string message = beast::buffers_to_string(buf.data());
+    const std::string_view message = buf.view();
     try
     {
-      auto parsed = json::parse(message);
-      std::cout << "Parsed JSON:\n";
-      std::cout << parsed << std::endl;
+      if (const auto account = Solana::AccountSubscribe::parseMessage(message))
+      {
+        std::cout << "Account in slot " << account->slot << ": " << account->account.lamports << " lamports\n";
+      }
+      else if (const auto logs = Solana::LogsSubscribe::parseMessage(message))
+      {
+        std::cout << logs->signature << " in slot " << logs->slot
+                  << (logs->failed() ? " failed: " + logs->err : std::string(" succeeded")) << "\n";
+        for (const auto &line : logs->logs)
+        {
+          std::cout << "  " << line << "\n";
+        }
+      }
       file << message << "\n";
       file.flush();
       std::cout << "----------------------------------------\n";